@@ -1,3 +1,6 @@
+//definizione della feature POSIX per pthread_condattr_setclock e CLOCK_MONOTONIC
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -86,6 +89,22 @@ static inline void UnlockQueueAndSignal(Queue_t *q){
   pthread_mutex_unlock(&q->qlock);
 }
 
+/**
+* Estrae il dato in testa a una coda non vuota. Va chiamata con il mutex acquisito
+*
+* @param q Puntatore alla coda
+* @return Il nodo rimosso (ex dummy) da liberare dopo aver rilasciato il mutex;
+*         il dato estratto è in *data
+*/
+static inline Node_t *TakeHead(Queue_t *q, void **data){
+  assert(q->head->next);
+  Node_t *oldHead = q->head;
+  *data = q->head->next->data;
+  q->head = q->head->next;
+  q->q_len -= 1;
+  return oldHead;
+}
+
 /* ------------------- Interfaccia della coda ------------------ */
 
 /**
@@ -114,12 +133,21 @@ Queue_t *initQueue(){
     perror("pthread_mutex_init");
     return NULL;
   }
-  //Inizializzazione della variabile di condizione
-  if(pthread_cond_init(&q->qcond, NULL) != 0){
+  //Inizializzazione della variabile di condizione, su CLOCK_MONOTONIC per pop_timeout
+  pthread_condattr_t attr;
+  int err = pthread_condattr_init(&attr);
+  if(err == 0){
+    err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if(err == 0) err = pthread_cond_init(&q->qcond, &attr);
+    pthread_condattr_destroy(&attr);
+  }
+  if(err != 0){
+    errno = err;
     perror("pthread_cond_init");
     pthread_mutex_destroy(&q->qlock);
     return NULL;
   }
+  q->cancelled = 0;
   return q;
 }
 
@@ -182,11 +210,12 @@ int push(Queue_t *q, void *data){
 * Rimuove e restituisce il primo elemento disponibile in coda
 *
 * Se la coda è vuota, la funzione attende (bloccandosi) fino a quando un nuovo
-* elemento non viene inserito. L'operazione è protetta da mutex per garantire la
-* sicurezza nei confronti dei thread concorrenti.
+* elemento non viene inserito o la coda non viene cancellata. L'operazione è
+* protetta da mutex per garantire la sicurezza nei confronti dei thread concorrenti.
 *
 * @param q Puntatore alla coda
 * @return Puntatore ai dati contenuti nel nodo rimosso, oppure NULL in caso di errore
+*         (errno = ECANCELED se la coda è vuota e cancellata)
 */
 void *pop(Queue_t *q){
   if(q == NULL){
@@ -195,22 +224,103 @@ void *pop(Queue_t *q){
   }
   LockQueue(q);
   //Attende finchè la coda è vuota (ossia solo il nodo dummy è presente)
-  while(q->head == q->tail){
+  while(q->head == q->tail && !q->cancelled){
     UnlockQueueAndWait(q);
   }
+  if(q->head == q->tail){
+    UnlockQueue(q);
+    errno = ECANCELED;
+    return NULL;
+  }
   //A questo punto, la coda contiene almento un elemento
-  assert(q->head->next);
-  Node_t *newNode = q->head;
-  void *data = q->head->next->data;
-  //Avanza il puntatore head e aggiorna la lunghezza della coda
-  q->head = q->head->next;
-  q->q_len -= 1;
-  assert(q->q_len >= 0);
+  void *data;
+  Node_t *oldHead = TakeHead(q, &data);
   UnlockQueue(q);
-  freeNode(newNode);
+  freeNode(oldHead);
   return data;
 }
 
+/**
+* Rimuove e restituisce il primo elemento disponibile in coda, senza attendere
+*
+* @param q Puntatore alla coda
+* @return Puntatore ai dati contenuti nel nodo rimosso, oppure NULL se la coda è
+*         vuota (errno = EAGAIN, o ECANCELED se cancellata) o in caso di errore
+*/
+void *try_pop(Queue_t *q){
+  if(q == NULL){
+    errno = EINVAL;
+    return NULL;
+  }
+  LockQueue(q);
+  if(q->head == q->tail){
+    errno = q->cancelled ? ECANCELED : EAGAIN;
+    UnlockQueue(q);
+    return NULL;
+  }
+  void *data;
+  Node_t *oldHead = TakeHead(q, &data);
+  UnlockQueue(q);
+  freeNode(oldHead);
+  return data;
+}
+
+/**
+* Rimuove e restituisce il primo elemento disponibile in coda, attendendo al
+* più fino a una scadenza
+*
+* L'attesa sulla coda vuota è una pthread_cond_timedwait con la scadenza assoluta
+* del chiamante (la variabile di condizione usa CLOCK_MONOTONIC); se la coda non è
+* vuota il costo è lo stesso di pop.
+*
+* @param q Puntatore alla coda
+* @param deadline Istante assoluto su CLOCK_MONOTONIC (NULL: nessuna scadenza)
+* @return Puntatore ai dati contenuti nel nodo rimosso, oppure NULL se la scadenza
+*         è passata (errno = ETIMEDOUT), se la coda è vuota e cancellata
+*         (errno = ECANCELED) o in caso di errore
+*/
+void *pop_timeout(Queue_t *q, const struct timespec *deadline){
+  if(q == NULL){
+    errno = EINVAL;
+    return NULL;
+  }
+  LockQueue(q);
+  int err = 0;
+  //Esce a qualunque errore: con una scadenza non valida (EINVAL) riprovare girerebbe all'infinito
+  while(q->head == q->tail && !q->cancelled && err == 0){
+    if(deadline == NULL) UnlockQueueAndWait(q);
+    else err = pthread_cond_timedwait(&q->qcond, &q->qlock, deadline);
+  }
+  //Un elemento arrivato insieme alla scadenza viene comunque estratto
+  if(q->head == q->tail){
+    errno = q->cancelled ? ECANCELED : (err != 0 ? err : ETIMEDOUT);
+    UnlockQueue(q);
+    return NULL;
+  }
+  void *data;
+  Node_t *oldHead = TakeHead(q, &data);
+  UnlockQueue(q);
+  freeNode(oldHead);
+  return data;
+}
+
+/**
+* Cancella la coda, risvegliando tutti i thread in attesa
+*
+* Imposta il flag cancelled ed esegue un broadcast sulla variabile di condizione:
+* i thread in attesa in pop o pop_timeout ricontrollano la coda e, se è vuota,
+* restituiscono NULL con errno = ECANCELED. Le pop successive non attendono più.
+*
+* @param q Puntatore alla coda
+*/
+void cancelQueue(Queue_t *q){
+  if(q == NULL) return;
+  LockQueue(q);
+  q->cancelled = 1;
+  pthread_cond_broadcast(&q->qcond);
+  UnlockQueue(q);
+}
+
 /**
 * Restituisce (senza rimuovere il primo elemento disponibile in coda
 *
@@ -2,6 +2,7 @@
 #define QUEUE_H
 
 #include <pthread.h>
+#include <time.h>
 /** Elemento della coda
 *
 */
@@ -18,7 +19,8 @@ typedef struct Queue{
   Node_t *tail;   //elemento di coda
   unsigned long q_len;  //lunghezza
   pthread_mutex_t qlock;
-  pthread_cond_t qcond;
+  pthread_cond_t qcond;  //su CLOCK_MONOTONIC (scadenze di pop_timeout)
+  int cancelled;         //1 dopo cancelQueue: le pop sulla coda vuota non attendono piu'
 }Queue_t;
 
 /** Alloca ed inizializza una coda. Deve essere chiamata da un solo
@@ -46,9 +48,34 @@ int push(Queue_t *q, void *data);
 /** Estrae un dato dalla coda
 *
 *   \retval data puntatore al dato estratto
+*   \retval NULL se la coda e' vuota e cancellata (errno = ECANCELED)
 */
 void *pop(Queue_t *q);
 
+/** Estrae un dato dalla coda senza attendere
+*
+*   \retval data puntatore al dato estratto
+*   \retval NULL se la coda e' vuota (errno = EAGAIN, o ECANCELED se cancellata)
+*/
+void *try_pop(Queue_t *q);
+
+/** Estrae un dato dalla coda attendendo al piu' fino a deadline
+*
+*   \param deadline istante assoluto su CLOCK_MONOTONIC (NULL: nessuna scadenza)
+*
+*   \retval data puntatore al dato estratto
+*   \retval NULL se la scadenza e' passata senza dati (errno = ETIMEDOUT)
+*           o se la coda e' vuota e cancellata (errno = ECANCELED)
+*           o se deadline non e' valida (errno = EINVAL, tv_nsec fuori da [0, 1e9))
+*/
+void *pop_timeout(Queue_t *q, const struct timespec *deadline);
+
+/** Cancella la coda: risveglia tutti i thread in attesa in pop e da quel
+*   momento le pop sulla coda vuota restituiscono subito NULL (errno = ECANCELED).
+*   I dati ancora in coda possono essere estratti (drenaggio allo spegnimento).
+*/
+void cancelQueue(Queue_t *q);
+
 /** Ritorna il dato in testa alla coda senza estrarlo
 *
 *   \retval data puntatore al dato di testa (senza estrazione)
@@ -86,6 +86,33 @@ static inline void UnlockQueueAndSignal(Queue_t *q){
   pthread_mutex_unlock(&q->qlock);
 }
 
+/**
+* Risveglia tutti i thread in attesa e rilascia il mutex associato.
+*
+* Usata da push_n: con più elementi inseriti insieme possono ripartire
+* più consumatori
+*
+* @param q Puntatore alla coda
+*/
+static inline void UnlockQueueAndBroadcast(Queue_t *q){
+  pthread_cond_broadcast(&q->qcond);
+  pthread_mutex_unlock(&q->qlock);
+}
+
+/**
+* Libera una catena di nodi collegati tramite next, da first fino a stop escluso
+*
+* @param first Primo nodo da liberare
+* @param stop Nodo a cui fermarsi (NULL per liberare fino alla fine della catena)
+*/
+static void freeChain(Node_t *first, Node_t *stop){
+  while(first != stop){
+    Node_t *next = first->next;
+    freeNode(first);
+    first = next;
+  }
+}
+
 /* ------------------- Interfaccia della coda ------------------ */
 
 /**
@@ -211,6 +238,90 @@ void *pop(Queue_t *q){
   return data;
 }
 
+/**
+* Inserisce k elementi in coda con una sola sezione critica
+*
+* I k nodi vengono allocati e collegati tra loro fuori dalla sezione critica;
+* sotto mutex la catena viene agganciata in fondo alla coda con un solo
+* aggiornamento di tail, e un solo broadcast risveglia i consumatori in attesa.
+* Se un'allocazione fallisce (o un dato è NULL) la coda non viene modificata.
+*
+* @param q Puntatore alla coda.
+* @param data Array dei k puntatori ai dati da inserire, in ordine di estrazione
+* @param k Numero di elementi da inserire
+* @return 0 in caso di successo, -1 e setta errno in caso di errore
+*/
+int push_n(Queue_t *q, void **data, unsigned long k){
+  if((q == NULL) || (data == NULL)){
+    errno = EINVAL;
+    return -1;
+  }
+  if(k == 0) return 0;
+
+  //Costruzione della catena di nodi fuori dalla sezione critica
+  Node_t *first = NULL;
+  Node_t *last = NULL;
+  for(unsigned long i = 0; i < k; i++){
+    Node_t *newNode = (data[i] != NULL) ? allocNode() : NULL;
+    if(!newNode){
+      if(data[i] == NULL) errno = EINVAL;
+      freeChain(first, NULL);
+      return -1;
+    }
+    newNode->data = data[i];
+    newNode->next = NULL;
+    if(last) last->next = newNode;
+    else first = newNode;
+    last = newNode;
+  }
+
+  //Aggancio della catena in sezione critica
+  LockQueue(q);
+  q->tail->next = first;
+  q->tail = last;
+  q->q_len += k;
+  if(k == 1) UnlockQueueAndSignal(q);
+  else UnlockQueueAndBroadcast(q);
+  return 0;
+}
+
+/**
+* Rimuove fino a k elementi dalla testa della coda con una sola sezione critica
+*
+* Se la coda è vuota, attende (bloccandosi) come pop; poi estrae gli elementi
+* presenti, al più k, senza attenderne altri. I nodi rimossi sono liberati dopo
+* aver rilasciato il mutex.
+*
+* @param q Puntatore alla coda
+* @param data Array di almeno k posti in cui vengono scritti i puntatori ai dati estratti
+* @param k Numero massimo di elementi da estrarre (almeno 1)
+* @return Numero di elementi estratti (da 1 a k), oppure -1 e setta errno in caso di errore
+*/
+long pop_n(Queue_t *q, void **data, unsigned long k){
+  if((q == NULL) || (data == NULL) || (k == 0)){
+    errno = EINVAL;
+    return -1;
+  }
+  LockQueue(q);
+  //Attende finchè la coda è vuota (ossia solo il nodo dummy è presente)
+  while(q->head == q->tail){
+    UnlockQueueAndWait(q);
+  }
+  unsigned long n = (q->q_len < k) ? q->q_len : k;
+  //I vecchi nodi di testa (da oldHead al nuovo dummy escluso) restano collegati tra loro
+  Node_t *oldHead = q->head;
+  for(unsigned long i = 0; i < n; i++){
+    assert(q->head->next);
+    data[i] = q->head->next->data;
+    q->head = q->head->next;
+  }
+  Node_t *newHead = q->head;
+  q->q_len -= n;
+  UnlockQueue(q);
+  freeChain(oldHead, newHead);
+  return (long)n;
+}
+
 /**
 * Restituisce (senza rimuovere il primo elemento disponibile in coda
 *
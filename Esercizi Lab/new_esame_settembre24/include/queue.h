@@ -61,6 +61,32 @@ int push(Queue_t *q, void *data);
  */
 void *pop(Queue_t *q);
 
+/** Inserisce k dati nella coda con una sola sezione critica.
+ *
+ * I nodi vengono allocati fuori dal mutex e agganciati in fondo alla coda
+ * tutti insieme; un solo broadcast risveglia i thread in attesa. In caso di
+ * errore nessun dato viene inserito.
+ *
+ * \param q Puntatore alla coda.
+ * \param data Array dei k puntatori ai dati da inserire (non NULL).
+ * \param k Numero di dati da inserire.
+ * \retval 0 in caso di successo.
+ * \retval -1 in caso di errore (errno settato).
+ */
+int push_n(Queue_t *q, void **data, unsigned long k);
+
+/** Estrae fino a k dati dalla coda con una sola sezione critica.
+ *
+ * Se la coda è vuota attende come pop, poi estrae i dati presenti (al più k)
+ * senza attenderne altri.
+ *
+ * \param q Puntatore alla coda.
+ * \param data Array di almeno k posti per i puntatori ai dati estratti.
+ * \param k Numero massimo di dati da estrarre (almeno 1).
+ * \retval Numero di dati estratti (da 1 a k), oppure -1 in caso di errore (errno settato).
+ */
+long pop_n(Queue_t *q, void **data, unsigned long k);
+
 /** Ritorna il dato in testa alla coda senza estrarlo.
  *
  * Se la coda è vuota, viene restituito NULL senza bloccare il thread chiamante.
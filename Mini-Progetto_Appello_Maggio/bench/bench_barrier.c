@@ -0,0 +1,86 @@
+/**
+ * @file bench_barrier.c
+ * @brief Microbenchmark: latenza di pthread_barrier_t contro SpinBarrier al variare di P.
+ *
+ * Per P = 1, 2, 4, ... fino a max_P (e max_P stesso) avvia P thread che
+ * attraversano 'rounds' volte di fila la stessa barriera, senza lavoro tra
+ * un'attesa e l'altra: il tempo per turno è la latenza della barriera, cioè
+ * quanto costa ognuna delle 1 + 2*log2(P) barriere di un ordinamento con N
+ * piccolo. Stampa il tempo medio per turno (migliore su 'runs' ripetizioni) in CSV.
+ * Con più thread che CPU la SpinBarrier non gira e si blocca subito sul futex.
+ *
+ * Uso: ./bench/bench_barrier [max_P] [rounds] [runs]   (default nproc, 100000, 5)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h> // sysconf
+
+#include "myutils.h"     // get_time_ms
+#include "spinbarrier.h" // SpinBarrier
+
+// BarrierRun: Barriera condivisa dai thread di una misura.
+typedef struct {
+    int use_spin;             // 1: SpinBarrier, 0: pthread_barrier_t
+    pthread_barrier_t pbarrier;
+    SpinBarrier sbarrier;
+    long rounds;
+} BarrierRun;
+
+static void *barrier_loop(void *arg) {
+    BarrierRun *run = arg;
+    for (long r = 0; r < run->rounds; ++r) {
+        if (run->use_spin) spin_barrier_wait(&run->sbarrier);
+        else pthread_barrier_wait(&run->pbarrier);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Microsecondi per turno di p thread su 'rounds' turni della barriera scelta.
+ */
+static double measure(int p, int use_spin, long rounds) {
+    BarrierRun run;
+    run.use_spin = use_spin;
+    run.rounds = rounds;
+    // La misura include la creazione dei thread, ammortizzata su 'rounds' turni
+    CHECK_PTHREAD_ERR(pthread_barrier_init(&run.pbarrier, NULL, p), "Errore pthread_barrier_init");
+    CHECK_PTHREAD_ERR(spin_barrier_init(&run.sbarrier, p), "Errore spin_barrier_init");
+    pthread_t *threads = malloc(p * sizeof(pthread_t));
+    CHECK_ERR(threads == NULL, "Errore allocazione thread");
+
+    double t0 = get_time_ms();
+    for (int i = 0; i < p; ++i) {
+        CHECK_PTHREAD_ERR(pthread_create(&threads[i], NULL, barrier_loop, &run), "Errore pthread_create");
+    }
+    for (int i = 0; i < p; ++i) pthread_join(threads[i], NULL);
+    double elapsed_ms = get_time_ms() - t0;
+
+    free(threads);
+    pthread_barrier_destroy(&run.pbarrier);
+    spin_barrier_destroy(&run.sbarrier);
+    return elapsed_ms * 1000.0 / rounds;
+}
+
+int main(int argc, char *argv[]) {
+    int max_p = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long rounds = (argc > 2) ? atol(argv[2]) : 100000L;
+    int runs = (argc > 3) ? atoi(argv[3]) : 5;
+    CHECK_ERR(max_p < 1 || rounds < 1 || runs < 1, "Uso: bench_barrier [max_P >= 1] [rounds >= 1] [runs >= 1]");
+
+    printf("# CPU online: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("P,pthread_us,spin_us,speedup\n");
+    for (int p = 1; ; p = (p * 2 < max_p) ? p * 2 : max_p) {
+        double best[2] = { -1.0, -1.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int use_spin = 0; use_spin < 2; ++use_spin) {
+                double us = measure(p, use_spin, rounds);
+                if (best[use_spin] < 0 || us < best[use_spin]) best[use_spin] = us;
+            }
+        }
+        printf("%d,%.3f,%.3f,%.2f\n", p, best[0], best[1], best[0] / best[1]);
+        fflush(stdout);
+        if (p == max_p) break;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file bench_false_sharing.c
+ * @brief Microbenchmark: dati per thread adiacenti (false sharing) contro dati
+ * separati da una linea di cache (CACHE_LINE_SIZE).
+ *
+ * Due carichi, per P = 1, 2, 4, ... fino a max_P (e max_P stesso):
+ * - counter: ogni thread incrementa 'ops' volte il proprio contatore, con i P
+ *   contatori contigui (packed) o uno per linea di cache (padded);
+ * - hist: il ciclo di conteggio del sample sort (intsort.c), 'ops' incrementi
+ *   di my_hist[bucket] con bucket pseudo-casuale in [0, P), con le righe a
+ *   passo P (packed, la disposizione precedente) o SAMPLE_HIST_STRIDE(P).
+ * Con la disposizione packed ogni scrittura invalida la linea negli altri core
+ * che la stanno scrivendo: è il trasferimento di linee che perf c2c riporta
+ * come HITM. Qui lo si misura indirettamente come nanosecondi per incremento
+ * (migliore su 'runs' ripetizioni), stampati in CSV con il rapporto
+ * packed / padded. Con una sola CPU i thread non girano mai insieme e i
+ * rapporti restano vicini a 1.
+ *
+ * Uso: ./bench/bench_false_sharing [max_P] [ops] [runs]   (default nproc, 20000000, 5)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h> // sysconf
+
+#include "myutils.h" // get_time_ms, cache_aligned_calloc
+#include "intsort.h" // SAMPLE_HIST_STRIDE
+
+// SharingMode: Carico e disposizione misurati.
+typedef enum {
+    MODE_COUNTER_PACKED = 0,  // Contatori contigui
+    MODE_COUNTER_PADDED,      // Un contatore per linea di cache
+    MODE_HIST_PACKED,         // Righe dell'istogramma a passo P
+    MODE_HIST_PADDED,         // Righe a passo SAMPLE_HIST_STRIDE(P)
+    MODE_COUNT
+} SharingMode;
+
+// SharingRun: Dati condivisi dai thread di una misura.
+typedef struct {
+    SharingMode mode;
+    long *data;               // Contatori o istogrammi dei P thread
+    long stride;              // Distanza in long tra i dati di due thread
+    int n_threads;
+    long ops;
+} SharingRun;
+
+// SharingArgs: Argomenti di un thread.
+typedef struct {
+    SharingRun *run;
+    int tid;
+} SharingArgs;
+
+static void *sharing_loop(void *arg) {
+    SharingArgs *a = arg;
+    SharingRun *run = a->run;
+    long *mine = &run->data[(long)a->tid * run->stride];
+    if (run->mode == MODE_COUNTER_PACKED || run->mode == MODE_COUNTER_PADDED) {
+        volatile long *counter = mine; // Una load e una store per incremento, come un contatore condiviso
+        for (long k = 0; k < run->ops; ++k) (*counter)++;
+        return NULL;
+    }
+    // Generatore congruenziale per thread: bucket pseudo-casuali senza leggere un array
+    unsigned long x = 0x9E3779B97F4A7C15UL * (unsigned long)(a->tid + 1);
+    unsigned long P = (unsigned long)run->n_threads;
+    for (long k = 0; k < run->ops; ++k) {
+        x = x * 6364136223846793005UL + 1442695040888963407UL;
+        mine[(x >> 33) % P]++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Nanosecondi per incremento di p thread nella modalità scelta.
+ */
+static double measure(int p, SharingMode mode, long ops) {
+    SharingRun run;
+    run.mode = mode;
+    run.n_threads = p;
+    run.ops = ops;
+    switch (mode) {
+    case MODE_COUNTER_PACKED: run.stride = 1; break;
+    case MODE_COUNTER_PADDED: run.stride = CACHE_LINE_LONGS; break;
+    case MODE_HIST_PACKED:    run.stride = p; break;
+    default:                  run.stride = SAMPLE_HIST_STRIDE(p); break;
+    }
+    run.data = cache_aligned_calloc((long)p * run.stride, sizeof(long));
+    pthread_t *threads = malloc(p * sizeof(pthread_t));
+    SharingArgs *args = malloc(p * sizeof(SharingArgs));
+    CHECK_ERR(run.data == NULL || threads == NULL || args == NULL, "Errore allocazione");
+
+    double t0 = get_time_ms();
+    for (int i = 0; i < p; ++i) {
+        args[i].run = &run;
+        args[i].tid = i;
+        CHECK_PTHREAD_ERR(pthread_create(&threads[i], NULL, sharing_loop, &args[i]), "Errore pthread_create");
+    }
+    for (int i = 0; i < p; ++i) pthread_join(threads[i], NULL);
+    double elapsed_ms = get_time_ms() - t0;
+
+    // Ogni thread ha fatto esattamente 'ops' incrementi nei propri dati
+    long total = 0;
+    long span = (mode == MODE_COUNTER_PACKED || mode == MODE_COUNTER_PADDED) ? 1 : p;
+    for (int i = 0; i < p; ++i) {
+        for (long b = 0; b < span; ++b) total += run.data[(long)i * run.stride + b];
+    }
+    CHECK_ERR(total != ops * p, "Incrementi persi");
+
+    free(args);
+    free(threads);
+    free(run.data);
+    return elapsed_ms * 1e6 / ((double)ops * p);
+}
+
+int main(int argc, char *argv[]) {
+    int max_p = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long ops = (argc > 2) ? atol(argv[2]) : 20000000L;
+    int runs = (argc > 3) ? atoi(argv[3]) : 5;
+    CHECK_ERR(max_p < 1 || ops < 1 || runs < 1,
+              "Uso: bench_false_sharing [max_P >= 1] [ops >= 1] [runs >= 1]");
+
+    printf("# CPU online: %ld, linea di cache: %d byte\n", sysconf(_SC_NPROCESSORS_ONLN), CACHE_LINE_SIZE);
+    printf("P,counter_packed_ns,counter_padded_ns,hist_packed_ns,hist_padded_ns,counter_ratio,hist_ratio\n");
+    for (int p = 1; ; p = (p * 2 < max_p) ? p * 2 : max_p) {
+        double best[MODE_COUNT] = { -1.0, -1.0, -1.0, -1.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int mode = 0; mode < MODE_COUNT; ++mode) {
+                double ns = measure(p, mode, ops);
+                if (best[mode] < 0 || ns < best[mode]) best[mode] = ns;
+            }
+        }
+        // ratio: packed / padded, > 1 se la separazione per linea di cache elimina il false sharing
+        printf("%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", p,
+               best[MODE_COUNTER_PACKED], best[MODE_COUNTER_PADDED],
+               best[MODE_HIST_PACKED], best[MODE_HIST_PADDED],
+               best[MODE_COUNTER_PACKED] / best[MODE_COUNTER_PADDED],
+               best[MODE_HIST_PACKED] / best[MODE_HIST_PADDED]);
+        fflush(stdout);
+        if (p == max_p) break;
+    }
+    return EXIT_SUCCESS;
+}
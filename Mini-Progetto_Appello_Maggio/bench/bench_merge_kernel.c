@@ -0,0 +1,81 @@
+/**
+ * @file bench_merge_kernel.c
+ * @brief Microbenchmark: merge a due vie con salti condizionali contro merge_int_scalar
+ * (branchless) e merge_int (rete bitonica AVX2, se disponibile).
+ *
+ * Per ogni dimensione n (da 1K a max_n, fattore 10) genera due run ordinati
+ * di n/2 elementi casuali, li unisce con le tre varianti, verifica che i
+ * risultati coincidano e stampa i tempi migliori su 'runs' ripetizioni in CSV.
+ *
+ * Uso: ./bench/bench_merge_kernel [max_n] [runs]   (default 10000000, 5)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "myutils.h"    // qsort_compare, get_time_ms
+#include "sortkernel.h" // sort_int, merge_int, merge_int_scalar
+
+/**
+ * @brief Merge di riferimento con un salto condizionale per elemento,
+ * come il loop originale di merge_sections.
+ */
+static void merge_branchy(const int *a, long na, const int *b, long nb, int *out) {
+    long i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (a[i] <= b[j]) {
+            out[k++] = a[i++];
+        } else {
+            out[k++] = b[j++];
+        }
+    }
+    while (i < na) out[k++] = a[i++];
+    while (j < nb) out[k++] = b[j++];
+}
+
+int main(int argc, char *argv[]) {
+    long max_n = (argc > 1) ? atol(argv[1]) : 10000000L;
+    int runs = (argc > 2) ? atoi(argv[2]) : 5;
+    CHECK_ERR(max_n < 1000 || runs < 1, "Uso: bench_merge_kernel [max_n >= 1000] [runs >= 1]");
+
+    int *input = malloc(max_n * sizeof(int));
+    int *ref = malloc(max_n * sizeof(int));
+    int *out = malloc(max_n * sizeof(int));
+    CHECK_ERR(input == NULL || ref == NULL || out == NULL, "Errore allocazione buffer benchmark");
+
+    srand(42);
+    printf("# AVX2 merge: %s\n", sort_int_has_avx2() ? "si" : "no");
+    printf("n,branchy_ms,branchless_ms,merge_int_ms,speedup\n");
+    for (long n = 1000; n <= max_n; n *= 10) {
+        long na = n / 2;
+        long nb = n - na;
+        for (long i = 0; i < n; ++i) input[i] = rand();
+        sort_int(input, na);
+        sort_int(input + na, nb);
+
+        double best[3] = { -1.0, -1.0, -1.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int variant = 0; variant < 3; ++variant) {
+                int *dst = (variant == 0) ? ref : out;
+                double t0 = get_time_ms();
+                if (variant == 0) merge_branchy(input, na, input + na, nb, dst);
+                else if (variant == 1) merge_int_scalar(input, na, input + na, nb, dst);
+                else merge_int(input, na, input + na, nb, dst);
+                double elapsed = get_time_ms() - t0;
+                if (best[variant] < 0 || elapsed < best[variant]) best[variant] = elapsed;
+                if (variant > 0 && memcmp(ref, out, n * sizeof(int)) != 0) {
+                    fprintf(stderr, "ERRORE: merge diverso dal riferimento (n=%ld, variante %d)\n", n, variant);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        printf("%ld,%.3f,%.3f,%.3f,%.2f\n", n, best[0], best[1], best[2], best[0] / best[2]);
+        fflush(stdout);
+    }
+
+    free(input);
+    free(ref);
+    free(out);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file bench_psort_context.c
+ * @brief Microbenchmark: ordinamento di molti array di media dimensione con un
+ * psort_context riusato, contro un contesto (thread + buffer temporaneo)
+ * creato e distrutto per ogni array, come faceva il programma standalone.
+ *
+ * Per ogni dimensione n (da 1K a max_n, fattore 10) ordina 'count' array
+ * casuali con le due varianti, verifica che il risultato coincida con sort_int
+ * e stampa il throughput (array al secondo) in formato CSV su stderr.
+ *
+ * Uso: ./bench/bench_psort_context [max_n] [count] [P]   (default 100000, 1000, 4)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "myutils.h"    // get_time_ms
+#include "sortkernel.h" // sort_int
+#include "psort.h"      // psort_context
+
+int main(int argc, char *argv[]) {
+    long max_n = (argc > 1) ? atol(argv[1]) : 100000L;
+    int count = (argc > 2) ? atoi(argv[2]) : 1000;
+    int p = (argc > 3) ? atoi(argv[3]) : 4;
+    CHECK_ERR(max_n < 1000 || count < 1 || p < 1, "Uso: bench_psort_context [max_n >= 1000] [count >= 1] [P >= 1]");
+
+    int *input = malloc(max_n * sizeof(int));
+    int *ref = malloc(max_n * sizeof(int));
+    int *work = malloc(max_n * sizeof(int));
+    CHECK_ERR(input == NULL || ref == NULL || work == NULL, "Errore allocazione buffer benchmark");
+
+    srand(42);
+    for (long i = 0; i < max_n; ++i) input[i] = rand();
+
+    fprintf(stderr, "n,P,per_call_arrays_s,reused_arrays_s,speedup\n");
+    for (long n = 1000; n <= max_n; n *= 10) {
+        memcpy(ref, input, n * sizeof(int));
+        sort_int(ref, n);
+
+        double elapsed[2];
+        for (int variant = 0; variant < 2; ++variant) {
+            psort_context *ctx = NULL;
+            if (variant == 1) {
+                ctx = psort_create(p, SORT_QSORT, MERGE_PARALLEL);
+                CHECK_ERR(ctx == NULL, "Errore creazione contesto");
+            }
+            double t0 = get_time_ms();
+            for (int c = 0; c < count; ++c) {
+                memcpy(work, input, n * sizeof(int));
+                if (variant == 0) {
+                    // Un contesto per array: pthread_create/join e malloc del buffer ad ogni chiamata
+                    psort_context *once = psort_create(p, SORT_QSORT, MERGE_PARALLEL);
+                    CHECK_ERR(once == NULL, "Errore creazione contesto");
+                    psort_sort_int(once, work, n, NULL);
+                    psort_destroy(once);
+                } else {
+                    psort_sort_int(ctx, work, n, NULL);
+                }
+            }
+            elapsed[variant] = get_time_ms() - t0;
+            psort_destroy(ctx);
+            if (memcmp(ref, work, n * sizeof(int)) != 0) {
+                fprintf(stderr, "ERRORE: risultato diverso da sort_int (n=%ld, variante %d)\n", n, variant);
+                exit(EXIT_FAILURE);
+            }
+        }
+        fprintf(stderr, "%ld,%d,%.1f,%.1f,%.2f\n", n, p,
+                count * 1000.0 / elapsed[0], count * 1000.0 / elapsed[1], elapsed[0] / elapsed[1]);
+    }
+
+    free(input);
+    free(ref);
+    free(work);
+    return EXIT_SUCCESS;
+}
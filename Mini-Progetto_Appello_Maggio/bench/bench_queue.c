@@ -0,0 +1,170 @@
+/**
+ * @file bench_queue.c
+ * @brief Microbenchmark: push/pop della ConcurrentQueue (buffer circolare) contro
+ * la coda a lista linkata con una malloc per push e una free per pop, e contro
+ * push_n/pop_n (un blocco per sezione critica).
+ *
+ * Per P = 1, 2, 4, ... fino a max_P (e max_P stesso) avvia P thread che
+ * eseguono ciascuno 'ops' coppie push + pop sulla stessa coda, a blocchi di
+ * 'burst' push seguite da 'burst' pop: la coda contiene fino a P * burst task,
+ * come quando si sovra-partiziona in migliaia di task per ordinamento. Stampa i
+ * nanosecondi per coppia push + pop (migliore su 'runs' ripetizioni) in CSV;
+ * nella colonna batch_ns ogni blocco è una sola push_n e una sola pop_n
+ * (ripetuta finché non ha estratto 'burst' task).
+ * La lista linkata è ricostruita qui solo come riferimento.
+ *
+ * Uso: ./bench/bench_queue [max_P] [ops] [burst] [runs]   (default nproc, 1000000, 64, 5)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h> // sysconf
+
+#include "myutils.h" // get_time_ms
+#include "queue.h"   // ConcurrentQueue
+
+// ListNode, ListQueue: la coda a lista linkata di riferimento.
+typedef struct ListNode {
+    Partition_Index_Task task;
+    struct ListNode *next;
+} ListNode;
+
+typedef struct {
+    ListNode *head;
+    ListNode *tail;
+    pthread_mutex_t mutex;
+} ListQueue;
+
+static void list_push(ListQueue *q, Partition_Index_Task task) {
+    ListNode *node = malloc(sizeof(ListNode));
+    CHECK_ERR(node == NULL, "Errore allocazione nodo");
+    node->task = task;
+    node->next = NULL;
+    pthread_mutex_lock(&q->mutex);
+    if (q->tail == NULL) q->head = node;
+    else q->tail->next = node;
+    q->tail = node;
+    pthread_mutex_unlock(&q->mutex);
+}
+
+static int list_pop(ListQueue *q, Partition_Index_Task *task) {
+    pthread_mutex_lock(&q->mutex);
+    ListNode *node = q->head;
+    if (node != NULL) {
+        q->head = node->next;
+        if (q->head == NULL) q->tail = NULL;
+    }
+    pthread_mutex_unlock(&q->mutex);
+    if (node == NULL) return 0;
+    *task = node->task;
+    free(node);
+    return 1;
+}
+
+// QueueMode: Coda e operazioni misurate.
+typedef enum {
+    MODE_LIST = 0,            // ListQueue, un task per operazione
+    MODE_RING,                // ConcurrentQueue, push e pop
+    MODE_BATCH,               // ConcurrentQueue, push_n e pop_n
+    MODE_COUNT
+} QueueMode;
+
+// QueueRun: Code condivise dai thread di una misura.
+typedef struct {
+    QueueMode mode;
+    ConcurrentQueue queue;
+    ListQueue list;
+    long ops;
+    long burst;
+} QueueRun;
+
+static void *queue_loop(void *arg) {
+    QueueRun *run = arg;
+    Partition_Index_Task task = { 0, 0 };
+    Partition_Index_Task *block = malloc(run->burst * sizeof(Partition_Index_Task));
+    CHECK_ERR(block == NULL, "Errore allocazione blocco");
+    long checksum = 0;
+    for (long done = 0; done < run->ops; done += run->burst) {
+        if (run->mode == MODE_BATCH) {
+            for (long k = 0; k < run->burst; ++k) block[k].start = done + k;
+            push_n(&run->queue, block, run->burst);
+            // Nessuno chiude la coda: ogni thread estrae tanti task quanti ne ha inseriti,
+            // quindi pop_n non resta mai in attesa
+            for (long got = 0; got < run->burst; ) {
+                long n = pop_n(&run->queue, block, run->burst - got);
+                CHECK_ERR(n == 0, "Coda vuota");
+                for (long k = 0; k < n; ++k) checksum += block[k].start;
+                got += n;
+            }
+            continue;
+        }
+        for (long k = 0; k < run->burst; ++k) {
+            task.start = done + k;
+            if (run->mode == MODE_LIST) list_push(&run->list, task);
+            else push(&run->queue, task);
+        }
+        for (long k = 0; k < run->burst; ++k) {
+            if (run->mode == MODE_LIST) CHECK_ERR(!list_pop(&run->list, &task), "Coda di riferimento vuota");
+            else CHECK_ERR(!pop(&run->queue, &task), "Coda vuota");
+            checksum += task.start;
+        }
+    }
+    free(block);
+    return (void *)checksum;
+}
+
+/**
+ * @brief Nanosecondi per coppia push + pop di p thread sulla coda scelta.
+ */
+static double measure(int p, QueueMode mode, long ops, long burst) {
+    QueueRun run;
+    run.mode = mode;
+    run.ops = ops;
+    run.burst = burst;
+    // Capacità iniziale come in psort_create (una per thread): la crescita è inclusa nella misura
+    CHECK_ERR(init_queue(&run.queue, p) != 0, "Errore init_queue");
+    run.list.head = run.list.tail = NULL;
+    CHECK_PTHREAD_ERR(pthread_mutex_init(&run.list.mutex, NULL), "Errore pthread_mutex_init");
+    pthread_t *threads = malloc(p * sizeof(pthread_t));
+    CHECK_ERR(threads == NULL, "Errore allocazione thread");
+
+    double t0 = get_time_ms();
+    for (int i = 0; i < p; ++i) {
+        CHECK_PTHREAD_ERR(pthread_create(&threads[i], NULL, queue_loop, &run), "Errore pthread_create");
+    }
+    for (int i = 0; i < p; ++i) pthread_join(threads[i], NULL);
+    double elapsed_ms = get_time_ms() - t0;
+
+    free(threads);
+    destroy_queue(&run.queue);
+    pthread_mutex_destroy(&run.list.mutex);
+    return elapsed_ms * 1e6 / ((double)ops * p);
+}
+
+int main(int argc, char *argv[]) {
+    int max_p = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long ops = (argc > 2) ? atol(argv[2]) : 1000000L;
+    long burst = (argc > 3) ? atol(argv[3]) : 64L;
+    int runs = (argc > 4) ? atoi(argv[4]) : 5;
+    CHECK_ERR(max_p < 1 || ops < 1 || burst < 1 || runs < 1,
+              "Uso: bench_queue [max_P >= 1] [ops >= 1] [burst >= 1] [runs >= 1]");
+    ops = (ops + burst - 1) / burst * burst; // Multiplo di burst
+
+    printf("# CPU online: %ld, burst: %ld\n", sysconf(_SC_NPROCESSORS_ONLN), burst);
+    printf("P,list_ns,ring_ns,batch_ns,ring_speedup,batch_speedup\n");
+    for (int p = 1; ; p = (p * 2 < max_p) ? p * 2 : max_p) {
+        double best[MODE_COUNT] = { -1.0, -1.0, -1.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int mode = 0; mode < MODE_COUNT; ++mode) {
+                double ns = measure(p, mode, ops, burst);
+                if (best[mode] < 0 || ns < best[mode]) best[mode] = ns;
+            }
+        }
+        // ring_speedup: lista / buffer circolare; batch_speedup: push e pop singoli / push_n e pop_n
+        printf("%d,%.1f,%.1f,%.1f,%.2f,%.2f\n", p, best[MODE_LIST], best[MODE_RING], best[MODE_BATCH],
+               best[MODE_LIST] / best[MODE_RING], best[MODE_RING] / best[MODE_BATCH]);
+        fflush(stdout);
+        if (p == max_p) break;
+    }
+    return EXIT_SUCCESS;
+}
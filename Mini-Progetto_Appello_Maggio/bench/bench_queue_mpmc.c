@@ -0,0 +1,114 @@
+/**
+ * @file bench_queue_mpmc.c
+ * @brief Microbenchmark: throughput della ConcurrentQueue con mutex contro la
+ * variante lock-free (init_queue_lockfree) con P produttori e P consumatori.
+ *
+ * Per P = 1, 2, 4, ... fino a max_P (e max_P stesso) avvia P produttori che
+ * inseriscono 'ops' task ciascuno e P consumatori che estraggono con pop
+ * finché la coda non è vuota e chiusa; il thread principale chiude la coda
+ * dopo l'ultimo produttore, come Worker 0 dopo l'ultima partizione. Le due
+ * code partono con la stessa capacità ('capacity'): quella con mutex può
+ * crescere, quella lock-free fa attendere i produttori. Stampa i milioni di
+ * task trasferiti al secondo (migliore su 'runs' ripetizioni) in CSV e
+ * controlla che ogni task sia estratto una sola volta (somma degli start).
+ *
+ * Uso: ./bench/bench_queue_mpmc [max_P] [ops] [capacity] [runs]   (default 64, 200000, 1024, 3)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h> // sysconf
+
+#include "myutils.h" // get_time_ms
+#include "queue.h"   // ConcurrentQueue
+
+// QueueRun: Coda condivisa dai thread di una misura.
+typedef struct {
+    ConcurrentQueue queue;
+    long ops;                 // Task per produttore
+} QueueRun;
+
+// ConsumerArgs: Coda e somma degli start estratti da un consumatore.
+typedef struct {
+    QueueRun *run;
+    long sum;
+} ConsumerArgs;
+
+static void *producer_loop(void *arg) {
+    QueueRun *run = arg;
+    Partition_Index_Task task = { 0, 0 };
+    for (long k = 0; k < run->ops; ++k) {
+        task.start = k;
+        push(&run->queue, task);
+    }
+    return NULL;
+}
+
+static void *consumer_loop(void *arg) {
+    ConsumerArgs *c = arg;
+    Partition_Index_Task task;
+    c->sum = 0;
+    while (pop(&c->run->queue, &task)) c->sum += task.start;
+    return NULL;
+}
+
+/**
+ * @brief Milioni di task al secondo con p produttori e p consumatori sulla coda scelta.
+ */
+static double measure(int p, int lockfree, long ops, long capacity) {
+    QueueRun run;
+    run.ops = ops;
+    if (lockfree) CHECK_ERR(init_queue_lockfree(&run.queue, capacity) != 0, "Errore init_queue_lockfree");
+    else CHECK_ERR(init_queue(&run.queue, capacity) != 0, "Errore init_queue");
+    pthread_t *threads = malloc(2 * p * sizeof(pthread_t));
+    ConsumerArgs *consumers = malloc(p * sizeof(ConsumerArgs));
+    CHECK_ERR(threads == NULL || consumers == NULL, "Errore allocazione thread");
+
+    double t0 = get_time_ms();
+    for (int i = 0; i < p; ++i) {
+        consumers[i].run = &run;
+        CHECK_PTHREAD_ERR(pthread_create(&threads[p + i], NULL, consumer_loop, &consumers[i]), "Errore pthread_create");
+    }
+    for (int i = 0; i < p; ++i) {
+        CHECK_PTHREAD_ERR(pthread_create(&threads[i], NULL, producer_loop, &run), "Errore pthread_create");
+    }
+    for (int i = 0; i < p; ++i) pthread_join(threads[i], NULL);
+    close_queue(&run.queue);
+    long sum = 0;
+    for (int i = 0; i < p; ++i) {
+        pthread_join(threads[p + i], NULL);
+        sum += consumers[i].sum;
+    }
+    double elapsed_ms = get_time_ms() - t0;
+    CHECK_ERR(sum != (long)p * (ops * (ops - 1) / 2), "Task persi o duplicati dalla coda");
+
+    free(threads);
+    free(consumers);
+    destroy_queue(&run.queue);
+    return (double)ops * p / (elapsed_ms * 1000.0);
+}
+
+int main(int argc, char *argv[]) {
+    int max_p = (argc > 1) ? atoi(argv[1]) : 64;
+    long ops = (argc > 2) ? atol(argv[2]) : 200000L;
+    long capacity = (argc > 3) ? atol(argv[3]) : 1024L;
+    int runs = (argc > 4) ? atoi(argv[4]) : 3;
+    CHECK_ERR(max_p < 1 || ops < 1 || capacity < 1 || runs < 1,
+              "Uso: bench_queue_mpmc [max_P >= 1] [ops >= 1] [capacity >= 1] [runs >= 1]");
+
+    printf("# CPU online: %ld, capacità: %ld\n", sysconf(_SC_NPROCESSORS_ONLN), capacity);
+    printf("P,mutex_mops,lockfree_mops,speedup\n");
+    for (int p = 1; ; p = (p * 2 < max_p) ? p * 2 : max_p) {
+        double best[2] = { 0.0, 0.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int lockfree = 0; lockfree < 2; ++lockfree) {
+                double mops = measure(p, lockfree, ops, capacity);
+                if (mops > best[lockfree]) best[lockfree] = mops;
+            }
+        }
+        printf("%d,%.2f,%.2f,%.2f\n", p, best[0], best[1], best[1] / best[0]);
+        fflush(stdout);
+        if (p == max_p) break;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file bench_sort_kernel.c
+ * @brief Microbenchmark: sort_int (introsort + caso base AVX2/scalare) contro qsort.
+ *
+ * Per ogni dimensione di partizione n (da 1K a max_n, fattore 10) genera dati
+ * casuali, li ordina con qsort + qsort_compare, con sort_int_scalar e con
+ * sort_int, verifica che i tre risultati coincidano e stampa i tempi migliori
+ * su 'runs' ripetizioni in formato CSV.
+ *
+ * Uso: ./bench/bench_sort_kernel [max_n] [runs]   (default 10000000, 3)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "myutils.h"    // qsort_compare, get_time_ms
+#include "sortkernel.h" // sort_int, sort_int_scalar
+
+int main(int argc, char *argv[]) {
+    long max_n = (argc > 1) ? atol(argv[1]) : 10000000L;
+    int runs = (argc > 2) ? atoi(argv[2]) : 3;
+    CHECK_ERR(max_n < 1000 || runs < 1, "Uso: bench_sort_kernel [max_n >= 1000] [runs >= 1]");
+
+    int *input = malloc(max_n * sizeof(int));
+    int *ref = malloc(max_n * sizeof(int));
+    int *work = malloc(max_n * sizeof(int));
+    CHECK_ERR(input == NULL || ref == NULL || work == NULL, "Errore allocazione buffer benchmark");
+
+    srand(42);
+    for (long i = 0; i < max_n; ++i) input[i] = rand();
+
+    printf("# AVX2 caso base: %s\n", sort_int_has_avx2() ? "si" : "no");
+    printf("n,qsort_ms,sort_int_scalar_ms,sort_int_ms,speedup\n");
+    for (long n = 1000; n <= max_n; n *= 10) {
+        double best[3] = { -1.0, -1.0, -1.0 };
+        for (int r = 0; r < runs; ++r) {
+            for (int variant = 0; variant < 3; ++variant) {
+                int *dst = (variant == 0) ? ref : work;
+                memcpy(dst, input, n * sizeof(int));
+                double t0 = get_time_ms();
+                if (variant == 0) qsort(dst, n, sizeof(int), qsort_compare);
+                else if (variant == 1) sort_int_scalar(dst, n);
+                else sort_int(dst, n);
+                double elapsed = get_time_ms() - t0;
+                if (best[variant] < 0 || elapsed < best[variant]) best[variant] = elapsed;
+                if (variant > 0 && memcmp(ref, work, n * sizeof(int)) != 0) {
+                    fprintf(stderr, "ERRORE: risultato diverso da qsort (n=%ld, variante %d)\n", n, variant);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        printf("%ld,%.3f,%.3f,%.3f,%.2f\n", n, best[0], best[1], best[2], best[0] / best[2]);
+        fflush(stdout);
+    }
+
+    free(input);
+    free(ref);
+    free(work);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file bench_sweep.c
+ * @brief Benchmark di regressione: parallel_sort al variare di N, P e distribuzione
+ * dell'input, confrontato con qsort della libc e con un mergesort sequenziale.
+ *
+ * Per ogni N (da 1e3 a max_n, fattore 10) e ogni distribuzione l'input è
+ * generato una volta con datagen (seed fisso) e ogni implementazione lo
+ * ordina 1 volta di riscaldamento + 'runs' volte misurate, partendo sempre
+ * dalla stessa copia. Sono misurate:
+ * - le baseline sequenziali "qsort" (libc + qsort_compare) e "mergesort"
+ * (top-down, merge elemento per elemento, nessun kernel specializzato);
+ * - psort_sort_int con le varianti psort-parallel, psort-kway, psort-radix e
+ * psort-sample per P = 1, 2, 4, ... fino a max_P (e max_P stesso), con un
+ * contesto creato una volta per (variante, P) e riusato tra le ripetizioni.
+ * Ogni risultato è verificato (ordinamento e checksum) prima di essere registrato.
+ *
+ * Per ogni riga del CSV: mediana e 95° percentile (nearest rank) del tempo,
+ * throughput in elementi/s sulla mediana, speedup rispetto alla stessa
+ * variante con P=1 e rispetto a qsort.
+ *
+ * Uso: ./bench/bench_sweep [max_n] [runs] [csv] [distribuzioni] [max_P]
+ * (default 10000000, 5, bench_sweep.csv, "uniform,sorted,few-unique,zipf", nproc).
+ * L'avanzamento è stampato su stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h> // sysconf
+
+#include "myutils.h"  // get_time_ms, qsort_compare
+#include "psort.h"    // psort_context
+#include "datagen.h"  // datagen_fill, distribution_by_name
+
+#define BENCH_SEED 12345 // Seed dell'input: stesso input a ogni esecuzione del benchmark
+
+// Variante di psort_sort_int misurata.
+typedef struct {
+    const char *name;
+    SortMode sort_mode;
+    MergeMode merge_mode;
+} PsortVariant;
+
+static const PsortVariant variants[] = {
+    { "psort-parallel", SORT_QSORT, MERGE_PARALLEL },
+    { "psort-kway",     SORT_QSORT, MERGE_KWAY },
+    { "psort-radix",    SORT_RADIX, MERGE_PARALLEL },
+    { "psort-sample",   SORT_SAMPLE, MERGE_PARALLEL },
+};
+#define N_VARIANTS ((int)(sizeof(variants) / sizeof(variants[0])))
+
+/**
+ * @brief Mergesort sequenziale top-down di a[0..n) con buffer tmp (baseline).
+ */
+static void plain_mergesort(int *a, int *tmp, long n) {
+    if (n < 2) return;
+    long mid = n / 2;
+    plain_mergesort(a, tmp, mid);
+    plain_mergesort(a + mid, tmp, n - mid);
+    long i = 0, j = mid, k = 0;
+    while (i < mid && j < n) tmp[k++] = (a[j] < a[i]) ? a[j++] : a[i++];
+    while (i < mid) tmp[k++] = a[i++];
+    while (j < n) tmp[k++] = a[j++];
+    memcpy(a, tmp, n * sizeof(int));
+}
+
+/**
+ * @brief Somma (mod 2^64) degli elementi come uint32_t: invariante dell'ordinamento.
+ */
+static uint64_t checksum(const int *a, long n) {
+    uint64_t sum = 0;
+    for (long i = 0; i < n; ++i) sum += (uint32_t)a[i];
+    return sum;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordina i tempi e ne calcola mediana e 95° percentile (nearest rank).
+ */
+static void summarize(double *times, int runs, double *median, double *p95) {
+    qsort(times, runs, sizeof(double), compare_double);
+    *median = (runs % 2 == 1) ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2.0;
+    int rank = (95 * runs + 99) / 100; // ceil(0.95 * runs)
+    *p95 = times[(rank > 0 ? rank : 1) - 1];
+}
+
+/**
+ * @brief Controlla che work sia ordinato e abbia lo stesso checksum dell'input.
+ */
+static void verify(const int *work, long n, uint64_t expected, const char *impl, int p) {
+    for (long i = 1; i < n; ++i) {
+        if (work[i - 1] > work[i]) {
+            fprintf(stderr, "ERRORE: %s (P=%d, n=%ld) non ordinato all'indice %ld\n", impl, p, n, i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (checksum(work, n) != expected) {
+        fprintf(stderr, "ERRORE: %s (P=%d, n=%ld) ha perso o duplicato elementi\n", impl, p, n);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Esegue 1 riscaldamento + runs ordinamenti misurati di una copia di input.
+ *
+ * impl_index < 0: baseline (-1 qsort, -2 mergesort); altrimenti psort_sort_int su ctx.
+ */
+static void measure(int impl_index, psort_context *ctx, const int *input, int *work, int *scratch,
+                    long n, int runs, uint64_t expected, const char *impl, int p, double *times) {
+    for (int r = -1; r < runs; ++r) {
+        memcpy(work, input, n * sizeof(int));
+        double t0 = get_time_ms();
+        if (impl_index == -1) qsort(work, n, sizeof(int), qsort_compare);
+        else if (impl_index == -2) plain_mergesort(work, scratch, n);
+        else psort_sort_int(ctx, work, n, scratch);
+        double elapsed = get_time_ms() - t0;
+        verify(work, n, expected, impl, p);
+        if (r >= 0) times[r] = elapsed;
+    }
+}
+
+// InputFill: Argomenti di fill_slice per psort_parallel_for.
+typedef struct {
+    int *data;
+    long n;
+    Distribution dist;
+} InputFill;
+
+static void fill_slice(void *arg, int index, long lo, long hi) {
+    (void)index;
+    const InputFill *f = arg;
+    datagen_fill(f->data, lo, hi, f->n, f->dist, BENCH_SEED);
+}
+
+int main(int argc, char *argv[]) {
+    long max_n = (argc > 1) ? atol(argv[1]) : 10000000L;
+    int runs = (argc > 2) ? atoi(argv[2]) : 5;
+    const char *csv_path = (argc > 3) ? argv[3] : "bench_sweep.csv";
+    const char *dist_list = (argc > 4) ? argv[4] : "uniform,sorted,few-unique,zipf";
+    int max_p = (argc > 5) ? atoi(argv[5]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    CHECK_ERR(max_n < 1000 || runs < 1 || max_p < 1,
+              "Uso: bench_sweep [max_n >= 1000] [runs >= 1] [csv] [distribuzioni] [max_P >= 1]");
+
+    // Distribuzioni richieste (lista separata da virgole)
+    Distribution dists[DIST_COUNT];
+    int n_dists = 0;
+    char *list = strdup(dist_list);
+    CHECK_ERR(list == NULL, "Errore allocazione lista distribuzioni");
+    for (char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        Distribution d = distribution_by_name(tok);
+        if (d == DIST_COUNT || n_dists == DIST_COUNT) {
+            fprintf(stderr, "Errore: distribuzione '%s' non valida o ripetuta troppe volte.\n", tok);
+            exit(EXIT_FAILURE);
+        }
+        dists[n_dists++] = d;
+    }
+    free(list);
+
+    // P = 1, 2, 4, ... < max_P, poi max_P
+    int p_list[64];
+    int n_p = 0;
+    for (int p = 1; p < max_p && n_p < 63; p *= 2) p_list[n_p++] = p;
+    p_list[n_p++] = max_p;
+
+    int *input = malloc(max_n * sizeof(int));
+    int *work = malloc(max_n * sizeof(int));
+    int *scratch = malloc(max_n * sizeof(int));
+    double *times = malloc(runs * sizeof(double));
+    CHECK_ERR(input == NULL || work == NULL || scratch == NULL || times == NULL,
+              "Errore allocazione buffer benchmark");
+
+    FILE *csv = fopen(csv_path, "w");
+    CHECK_ERR(csv == NULL, "Errore apertura file CSV");
+    fprintf(csv, "n,dist,impl,P,runs,median_ms,p95_ms,throughput_eps,speedup_vs_p1,speedup_vs_qsort\n");
+
+    // Un contesto per (variante, P), riusato per tutti gli N e le distribuzioni
+    psort_context *ctxs[N_VARIANTS][64];
+    for (int v = 0; v < N_VARIANTS; ++v) {
+        for (int i = 0; i < n_p; ++i) {
+            ctxs[v][i] = psort_create(p_list[i], variants[v].sort_mode, variants[v].merge_mode);
+            CHECK_ERR(ctxs[v][i] == NULL, "Errore creazione contesto");
+        }
+    }
+
+    for (long n = 1000; n <= max_n; n *= 10) {
+        for (int d = 0; d < n_dists; ++d) {
+            const char *dist_name = distribution_names[dists[d]];
+            InputFill fill = { input, n, dists[d] };
+            psort_parallel_for(ctxs[0][n_p - 1], n, fill_slice, &fill);
+            uint64_t expected = checksum(input, n);
+            double median, p95, qsort_median = 0.0;
+
+            // Baseline sequenziali
+            const char *baseline_names[2] = { "qsort", "mergesort" };
+            for (int b = 0; b < 2; ++b) {
+                measure(-1 - b, NULL, input, work, scratch, n, runs, expected, baseline_names[b], 1, times);
+                summarize(times, runs, &median, &p95);
+                if (b == 0) qsort_median = median;
+                fprintf(csv, "%ld,%s,%s,1,%d,%.4f,%.4f,%.0f,1.000,%.3f\n", n, dist_name, baseline_names[b],
+                        runs, median, p95, n / (median / 1000.0), qsort_median / median);
+            }
+
+            // Varianti di parallel_sort
+            for (int v = 0; v < N_VARIANTS; ++v) {
+                double p1_median = 0.0;
+                for (int i = 0; i < n_p; ++i) {
+                    measure(v, ctxs[v][i], input, work, scratch, n, runs, expected, variants[v].name, p_list[i], times);
+                    summarize(times, runs, &median, &p95);
+                    if (i == 0) p1_median = median;
+                    fprintf(csv, "%ld,%s,%s,%d,%d,%.4f,%.4f,%.0f,%.3f,%.3f\n", n, dist_name, variants[v].name,
+                            p_list[i], runs, median, p95, n / (median / 1000.0), p1_median / median,
+                            qsort_median / median);
+                }
+            }
+            fflush(csv);
+            fprintf(stderr, "[bench_sweep] n=%ld dist=%s completato\n", n, dist_name);
+        }
+    }
+
+    for (int v = 0; v < N_VARIANTS; ++v) {
+        for (int i = 0; i < n_p; ++i) psort_destroy(ctxs[v][i]);
+    }
+    fclose(csv);
+    fprintf(stderr, "[bench_sweep] Risultati salvati in %s\n", csv_path);
+    free(times);
+    free(scratch);
+    free(work);
+    free(input);
+    return EXIT_SUCCESS;
+}
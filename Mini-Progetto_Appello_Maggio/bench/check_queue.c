@@ -0,0 +1,111 @@
+/**
+ * @file check_queue.c
+ * @brief Verifica del contratto di try_pop, pop_timeout e cancel_queue, nella
+ * versione con mutex (init_queue) e in quella lock-free (init_queue_lockfree).
+ *
+ * Casi controllati per ciascuna variante:
+ * - try_pop su coda vuota (QUEUE_EMPTY), con un task (1), chiusa (0);
+ * - pop_timeout con scadenza vicina (QUEUE_TIMEOUT), con un task (1), con una
+ *   scadenza non valida (tv_nsec >= 1e9: QUEUE_INVALID, senza restare in
+ *   attesa) e con la coda chiusa (0);
+ * - cancel_queue mentre un thread è bloccato in pop_timeout senza scadenza
+ *   (QUEUE_CANCELLED) e try_pop dopo la cancellazione.
+ * Un caso che non termina entro CHECK_ALARM_S secondi fa fallire il programma.
+ * Usato da test.sh; stampa "Verifica: coda concorrente corretta." se tutti i
+ * casi passano, altrimenti esce con stato diverso da 0.
+ *
+ * Uso: ./bench/check_queue
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>   // clock_gettime, nanosleep
+#include <unistd.h> // alarm
+
+#include "myutils.h" // CHECK_ERR, CHECK_PTHREAD_ERR
+#include "queue.h"   // ConcurrentQueue
+
+#define CHECK_ALARM_S 10         // Limite per l'intero programma (un'attesa che non termina)
+#define CHECK_TIMEOUT_NS 20000000L // Scadenza dei casi QUEUE_TIMEOUT (20 ms)
+
+static int failures = 0;
+
+// Confronta l'esito di un'operazione con quello atteso e lo stampa.
+static void expect(const char *variant, const char *what, int got, int want) {
+    if (got != want) {
+        printf("[%s] %s: %d, atteso %d\n", variant, what, got, want);
+        failures++;
+    }
+}
+
+// Istante assoluto su CLOCK_MONOTONIC a 'ns' nanosecondi da ora.
+static struct timespec deadline_in(long ns) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_nsec += ns;
+    t.tv_sec += t.tv_nsec / 1000000000L;
+    t.tv_nsec %= 1000000000L;
+    return t;
+}
+
+static void *blocked_pop(void *arg) {
+    ConcurrentQueue *q = arg;
+    Partition_Index_Task task;
+    return (void *)(long)pop_timeout(q, &task, NULL);
+}
+
+static void check_variant(const char *variant, int (*init)(ConcurrentQueue *, long)) {
+    ConcurrentQueue q;
+    Partition_Index_Task task;
+    Partition_Index_Task in = { 3, 7 };
+    CHECK_ERR(init(&q, 4) != 0, "Errore inizializzazione coda");
+
+    // try_pop
+    expect(variant, "try_pop su coda vuota", try_pop(&q, &task), QUEUE_EMPTY);
+    push(&q, in);
+    expect(variant, "try_pop con un task", try_pop(&q, &task), 1);
+    expect(variant, "task estratto da try_pop", task.start == in.start && task.end == in.end, 1);
+
+    // pop_timeout
+    struct timespec deadline = deadline_in(CHECK_TIMEOUT_NS);
+    expect(variant, "pop_timeout su coda vuota", pop_timeout(&q, &task, &deadline), QUEUE_TIMEOUT);
+    push(&q, in);
+    deadline = deadline_in(CHECK_TIMEOUT_NS);
+    expect(variant, "pop_timeout con un task", pop_timeout(&q, &task, &deadline), 1);
+    deadline = deadline_in(0);
+    deadline.tv_nsec = 1000000000L; // Non valida: l'attesa fallisce con EINVAL
+    expect(variant, "pop_timeout con scadenza non valida", pop_timeout(&q, &task, &deadline), QUEUE_INVALID);
+    push(&q, in);
+    expect(variant, "pop_timeout con un task e scadenza non valida", pop_timeout(&q, &task, &deadline), 1);
+
+    // Coda chiusa: 0 senza attendere
+    close_queue(&q);
+    expect(variant, "try_pop su coda chiusa", try_pop(&q, &task), 0);
+    expect(variant, "pop_timeout su coda chiusa", pop_timeout(&q, &task, NULL), 0);
+
+    // cancel_queue sveglia un thread bloccato senza scadenza
+    reset_queue(&q);
+    pthread_t waiter;
+    CHECK_PTHREAD_ERR(pthread_create(&waiter, NULL, blocked_pop, &q), "Errore pthread_create");
+    struct timespec pause = { 0, CHECK_TIMEOUT_NS };
+    nanosleep(&pause, NULL); // Di solito il thread è già bloccato; se no trova la coda cancellata
+    cancel_queue(&q);
+    void *result;
+    CHECK_PTHREAD_ERR(pthread_join(waiter, &result), "Errore pthread_join");
+    expect(variant, "pop_timeout interrotta da cancel_queue", (int)(long)result, QUEUE_CANCELLED);
+    expect(variant, "try_pop su coda cancellata", try_pop(&q, &task), QUEUE_CANCELLED);
+
+    destroy_queue(&q);
+}
+
+int main(void) {
+    alarm(CHECK_ALARM_S); // SIGALRM termina il programma se un'attesa non si interrompe
+    check_variant("mutex", init_queue);
+    check_variant("lock-free", init_queue_lockfree);
+    if (failures > 0) {
+        printf("Errore: %d casi falliti\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("Verifica: coda concorrente corretta.\n");
+    return EXIT_SUCCESS;
+}
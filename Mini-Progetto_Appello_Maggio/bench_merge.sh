@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# ==========================================================
+#  Benchmark Fase di Merge: scalabilità rispetto a P
+# ==========================================================
+# Confronta la durata della fase di merge tra -m serial (merge e copia
+# serializzati dai mutex), -m parallel (worker su intervalli disgiunti,
+# senza lock, buffer ping-pong) e -m corank (ogni coppia di blocchi divisa
+# tra tutti i worker con il merge-path) e -m kway (un solo passo P-way con
+# loser tree) al variare del numero di worker P.
+# Uso: ./bench_merge.sh [N] [ripetizioni]
+# Il risultato è salvato in bench_merge.dat (colonne: P modo merge_ms totale_ms).
+
+PROGRAM="./parallel_sort"
+N=${1:-10000000}
+RUNS=${2:-3}
+OUT="bench_merge.dat"
+
+if [ ! -x "$PROGRAM" ]; then
+    make || exit 1
+fi
+
+MAX_P=$(nproc)
+P_LIST="1"
+p=2
+while [ $p -le $((MAX_P * 2)) ] && [ $p -le 64 ]; do
+    P_LIST="$P_LIST $p"
+    p=$((p * 2))
+done
+
+echo "# merge benchmark N=$N runs=$RUNS" > "$OUT"
+echo "# P mode merge_ms total_ms" >> "$OUT"
+
+for p in $P_LIST; do
+    for mode in serial parallel corank kway; do
+        for ((r = 0; r < RUNS; r++)); do
+            OUTPUT=$($PROGRAM -n "$N" -w "$p" -m "$mode" 2>&1)
+            if ! echo "$OUTPUT" | grep -q "Verifica: L'array è ordinato correttamente."; then
+                echo "[ERRORE] Ordinamento fallito con P=$p, modo=$mode"
+                exit 1
+            fi
+            merge_ms=$(echo "$OUTPUT" | sed -n 's/^Tempo fase merge: \([0-9.]*\) ms$/\1/p')
+            total_ms=$(echo "$OUTPUT" | sed -n 's/^Tempo ordinamento: \([0-9.]*\) ms$/\1/p')
+            echo "$p $mode $merge_ms $total_ms" | tee -a "$OUT"
+        done
+    done
+done
+
+echo "Risultati salvati in $OUT"
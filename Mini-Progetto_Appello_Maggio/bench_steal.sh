@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# ==========================================================
+#  Benchmark Fase di Sorting: attesa alla barriera con dati sbilanciati
+# ==========================================================
+# Con -s qsort la fase di sorting termina con la barriera di step -1 nelle
+# statistiche (--stats): l'attesa di un worker lì è il tempo in cui è rimasto
+# senza lavoro mentre altri ordinavano. Per ogni distribuzione e P esegue
+# l'ordinamento (senza il rilevamento dei run, che salterebbe l'ordinamento di
+# organ-pipe) e riporta la durata della fase di sorting e l'attesa alla
+# barriera (media e massima sui worker).
+# Uso: ./bench_steal.sh [N] [ripetizioni] [distribuzioni] [max_P]
+#      PROGRAM=<eseguibile> ./bench_steal.sh ...   (per confrontare due build)
+# Il risultato è salvato in bench_steal.dat
+# (colonne: dist P sort_ms_max barrier_ms_mean barrier_ms_max).
+
+PROGRAM=${PROGRAM:-"./parallel_sort"}
+N=${1:-10000000}
+RUNS=${2:-3}
+DISTS=${3:-"uniform organ-pipe zipf"}
+OUT="bench_steal.dat"
+STATS=$(mktemp)
+trap 'rm -f "$STATS"' EXIT
+
+if [ ! -x "$PROGRAM" ]; then
+    make || exit 1
+fi
+
+MAX_P=${4:-$(( $(nproc) * 2 ))}
+P_LIST="2"
+p=4
+while [ $p -le "$MAX_P" ] && [ $p -le 64 ]; do
+    P_LIST="$P_LIST $p"
+    p=$((p * 2))
+done
+
+echo "# steal benchmark N=$N runs=$RUNS program=$PROGRAM" > "$OUT"
+echo "# dist P sort_ms_max barrier_ms_mean barrier_ms_max" >> "$OUT"
+
+for dist in $DISTS; do
+    for p in $P_LIST; do
+        for ((r = 0; r < RUNS; r++)); do
+            OUTPUT=$($PROGRAM -n "$N" -w "$p" -s qsort --dist "$dist" --seed "$r" --no-adaptive --stats "$STATS" 2>&1)
+            if ! echo "$OUTPUT" | grep -q "Verifica: L'array è ordinato correttamente."; then
+                echo "[ERRORE] Ordinamento fallito con P=$p, dist=$dist"
+                exit 1
+            fi
+            # Righe CSV: worker,phase,step,start_ms,end_ms,duration_ms,...
+            # Per ogni worker conta solo la barriera subito dopo la sua fase di sorting
+            awk -F, -v dist="$dist" -v p="$p" '
+                $2 == "sort" { after_sort[$1] = 1; if ($6 > sort_max) sort_max = $6; next }
+                $2 == "barrier" && after_sort[$1] { sum += $6; n++; if ($6 > wait_max) wait_max = $6 }
+                { after_sort[$1] = 0 }
+                END { printf "%s %d %.3f %.3f %.3f\n", dist, p, sort_max, (n > 0) ? sum / n : 0, wait_max }
+            ' "$STATS" | tee -a "$OUT"
+        done
+    done
+done
+
+echo "Risultati salvati in $OUT"
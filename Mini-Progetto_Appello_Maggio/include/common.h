@@ -12,6 +12,13 @@
 #include <errno.h>
 #include <string.h>
 
+// --- Linea di Cache ---
+// Dati scritti da thread diversi stanno su linee di cache diverse: altrimenti
+// ogni scrittura invalida la linea anche negli altri core (false sharing).
+// 64 byte su x86-64 e sulla maggior parte dei core ARM.
+#define CACHE_LINE_SIZE 64
+#define CACHE_LINE_LONGS (CACHE_LINE_SIZE / (long)sizeof(long)) // long in una linea di cache
+
 // --- Macro Utili ---
 
 // Macro per controllo errori di sistema semplificato
@@ -45,25 +52,71 @@
 
 // Task: Rappresenta una partizione (intervallo di indici) da ordinare.
 // Corrisponde alla "coppia di indici (start,end)
+// Gli indici sono a 64 bit, così N può superare 2^31 elementi.
 typedef struct {
-    int start; // Indice iniziale della partizione
-    int end;   // Indice finale della partizione
+    long start; // Indice iniziale della partizione
+    long end;   // Indice finale della partizione
 } Partition_Index_Task;
 
+// MergeMode: Strategia usata nella Fase 3 (merge) da worker_thread.
+typedef enum {
+    MERGE_SERIAL = 0,  // Schema originale: merge e copia serializzati dai mutex
+    MERGE_PARALLEL,    // Intervalli disgiunti senza lock, buffer ping-pong (metà dei worker inattivi per passo)
+    MERGE_CORANK,      // Ping-pong + merge-path: ogni coppia di blocchi è divisa tra tutti i P worker
+    MERGE_KWAY,        // Un solo passo: loser tree su tutte le P partizioni, output diviso da splitter
+    MERGE_MODE_COUNT   // Numero di modalità (non è una modalità valida)
+} MergeMode;
+
+// SortMode: Algoritmo di ordinamento eseguito dai worker (opzione -s).
+typedef enum {
+    SORT_QSORT = 0,   // Pipeline d'esame: partizioni ordinate (sort_int), poi merge (-m)
+    SORT_RADIX,       // Radix sort LSD parallelo su int a 32 bit
+    SORT_SAMPLE,      // Sample sort: splitter, scatter nei bucket, bucket ordinati via coda
+    SORT_MODE_COUNT   // Numero di modalità (non è una modalità valida)
+} SortMode;
+
 // Pre-dichiarazione della Coda Concorrente
 typedef struct ConcurrentQueue ConcurrentQueue;
 
+// Pre-dichiarazione del kernel per i tipi di record (recsort.h)
+struct RecordKernel;
+
+// Pre-dichiarazione della misura per fase di un worker (trace.h)
+struct WorkerTrace;
+
+// Pre-dichiarazione del registro eventi di un worker (eventlog.h)
+struct EventRing;
+
+// Deque di work stealing della fase di sorting (definiti in steal.h).
+struct WorkStealer;
+
+// Barriera spin-then-block dei worker (definita in spinbarrier.h).
+struct SpinBarrier;
+
 // ThreadArgs: Struttura per passare gli argomenti necessari a ciascun thread Worker.
+// Allineata alla linea di cache: nell'array dei P argomenti (psort.c) quelli di
+// worker adiacenti non condividono linee.
 typedef struct {
-    int thread_id;          // ID univoco del thread (0 a P-1)
+    _Alignas(CACHE_LINE_SIZE) int thread_id; // ID univoco del thread (0 a P-1)
     int *array;             // Puntatore all'array condiviso da ordinare (N elementi)
     int *temp_array;        // Puntatore a un array temporaneo per la fase di merge
     long n_elements;        // Numero totale di elementi nell'array (N)
     int n_threads;          // Numero totale di thread Worker (P)
     ConcurrentQueue *queue; // Puntatore alla coda concorrente condivisa (Q)
-    pthread_barrier_t *barrier; // Puntatore alla barriera di sincronizzazione condivisa
+    struct SpinBarrier *barrier; // Puntatore alla barriera di sincronizzazione condivisa (spinbarrier.h)
     pthread_mutex_t *merge_mutex_ptr; // Mutex per serializzare merge_sections su temp_array
     pthread_mutex_t *copy_phase_mutex_ptr; // Mutex per serializzare la fase di copia da temp_array ad array
+    MergeMode merge_mode;   // Strategia di merge (da opzione -m)
+    double *merge_time_ms_ptr; // Output: durata della fase di merge in ms (scritta dal Worker 0)
+    SortMode sort_mode;     // Algoritmo di ordinamento (da opzione -s)
+    long *histograms;       // Istogrammi per-thread condivisi (radix: P x 256, sample: P x SAMPLE_HIST_STRIDE(P))
+    int *splitters;         // Splitter condivisi del sample sort (P-1 valori)
+    const struct RecordKernel *record_kernel; // Tipo di record da ordinare (NULL: array di int)
+    void *records;          // Record da ordinare (N elementi), se record_kernel != NULL
+    void *temp_records;     // Buffer temporaneo per il merge dei record
+    struct WorkerTrace *trace; // Misura per fase del worker (NULL se --stats non è attivo)
+    struct EventRing *events;  // Registro eventi del worker (NULL se -v 2 non è attivo)
+    struct WorkStealer *stealer; // Deque della fase di sorting (-s qsort sugli int)
 } ThreadArgs;
 
 #endif // COMMON_H
\ No newline at end of file
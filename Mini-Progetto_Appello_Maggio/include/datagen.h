@@ -0,0 +1,42 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <stdint.h> // Per uint64_t
+
+#include "common.h" // Per accesso a tipi base se necessario
+
+// --- Generazione Parallela e Riproducibile dei Dati di Input ---
+// Il valore dell'elemento i dipende solo da (seed, i, n): ogni thread può
+// generare la propria fetta indipendentemente dagli altri (PRNG basato su
+// contatore, splitmix64) e lo stesso seed produce lo stesso array per
+// qualsiasi numero di thread.
+
+// Distribution: Forma dei dati generati (opzione --dist).
+typedef enum {
+    DIST_UNIFORM = 0,   // Valori uniformi in [0, 10*N)
+    DIST_SORTED,        // Già ordinati (crescenti)
+    DIST_REVERSE,       // Ordinati al contrario (decrescenti)
+    DIST_NEARLY_SORTED, // Ordinati, con circa l'1% degli elementi spostato di poco
+    DIST_FEW_UNIQUE,    // Solo DATAGEN_FEW_UNIQUE valori distinti
+    DIST_ZIPF,          // Valori piccoli molto più frequenti (Zipf con esponente ~1)
+    DIST_ORGAN_PIPE,    // Crescenti fino a metà array, poi decrescenti
+    DIST_COUNT          // Numero di distribuzioni (non è una distribuzione valida)
+} Distribution;
+
+#define DATAGEN_FEW_UNIQUE 16 // Valori distinti di DIST_FEW_UNIQUE
+
+// Nomi accettati da --dist, indicizzati per Distribution.
+extern const char *const distribution_names[DIST_COUNT];
+
+// Distribuzione con nome 'name', oppure DIST_COUNT se il nome non è valido.
+Distribution distribution_by_name(const char *name);
+
+// Numero pseudo-casuale di 64 bit per la posizione 'counter' del flusso 'seed'
+// (mix di splitmix64: nessuno stato condiviso tra thread).
+uint64_t datagen_mix(uint64_t seed, uint64_t counter);
+
+// Scrive in data[lo..hi) gli elementi di indice lo..hi-1 di un array di n
+// elementi con distribuzione 'dist' e seed 'seed'.
+void datagen_fill(int *data, long lo, long hi, long n, Distribution dist, uint64_t seed);
+
+#endif // DATAGEN_H
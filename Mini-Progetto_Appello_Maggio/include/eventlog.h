@@ -0,0 +1,53 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h> // Per uint64_t
+
+#include "common.h" // Per FILE e i tipi base
+
+// --- Registro Eventi dei Worker (opzione -v 2) ---
+// Ogni worker scrive i propri eventi (avvio, task accodati e prelevati, merge
+// pianificati, terminazione) in un buffer circolare privato: nessun lock e
+// nessuna stampa durante l'ordinamento. Il registro viene stampato alla fine
+// con eventlog_dump, quando i worker sono fermi. Se un worker produce più di
+// EVENTLOG_CAPACITY eventi restano gli ultimi EVENTLOG_CAPACITY.
+
+// EventKind: Tipo di evento (le stampe corrispondono ai vecchi printf dei worker).
+typedef enum {
+    EVENT_WORKER_START = 0, // [WORKER STATUS] Worker AVVIATO
+    EVENT_WORKER_END,       // [WORKER STATUS] Worker TERMINATO
+    EVENT_TASK_PUSH,        // [INDICI SORTING] Task accodato (a = start, b = end)
+    EVENT_TASK_POP,         // [INDICI SORTING] Task prelevato (a = start, b = end)
+    EVENT_TASK_STEAL,       // [INDICI SORTING] Task rubato al worker c (a = start, b = end)
+    EVENT_MERGE_PLAN,       // [INDICI MERGING] Merge del passo 'step' (a-b con c-d)
+    EVENT_KIND_COUNT        // Numero di tipi (non è un tipo valido)
+} EventKind;
+
+#define EVENTLOG_CAPACITY 1024 // Eventi conservati per worker
+
+// EventRecord: Un evento con il suo istante e fino a 4 indici.
+typedef struct {
+    double t_ms;    // Istante, in ms dall'avvio dell'ordinamento
+    EventKind kind;
+    int step;       // Passo di merge (-1 se non applicabile)
+    long a, b, c, d;
+} EventRecord;
+
+// EventRing: Buffer circolare di un worker; scritto solo dal suo thread.
+// Allineato alla linea di cache, come gli altri dati per worker.
+typedef struct EventRing {
+    _Alignas(CACHE_LINE_SIZE) double t0_ms; // Istante di avvio dell'ordinamento (get_time_ms)
+    uint64_t written; // Eventi scritti dall'ultimo reset (anche quelli sovrascritti)
+    EventRecord records[EVENTLOG_CAPACITY];
+} EventRing;
+
+// Svuota il registro per un nuovo ordinamento che inizia all'istante t0_ms.
+void eventlog_reset(EventRing *ring, double t0_ms);
+
+// Registra un evento; con ring == NULL non fa nulla (registro disattivato).
+void eventlog_record(EventRing *ring, EventKind kind, int step, long a, long b, long c, long d);
+
+// Stampa in ordine di tempo gli eventi dei P worker (rings[i] è il worker i).
+void eventlog_dump(FILE *out, const EventRing *rings, int P);
+
+#endif // EVENTLOG_H
@@ -0,0 +1,40 @@
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include <stdint.h> // Per uint64_t
+
+#include "common.h" // Include MergeMode, SortMode
+
+// --- Ordinamento Esterno (out-of-core) di File Binari di int ---
+// Il file di input è un array di int a 32 bit nel formato nativo della macchina
+// (dimensione multipla di 4 byte); l'output ha lo stesso formato.
+
+// ExtSortStats: Risultati di external_sort_file, usati per la verifica e le stampe.
+typedef struct {
+    long elements;        // Numero di int ordinati
+    int runs;             // Run ordinati prodotti dalla prima fase
+    uint64_t checksum;    // Checksum del multinsieme letto dall'input (checksum_int_block di verify.h)
+    double run_time_ms;   // Durata della generazione dei run
+    double merge_time_ms; // Durata del merge P-way dei run (0 se c'è un solo run)
+} ExtSortStats;
+
+// Ordina il file 'input_path' scrivendo il risultato in 'output_path', usando
+// al più circa 'mem_bytes' byte di buffer.
+// Fase 1: blocchi da mem_bytes/3 byte sono letti, ordinati con un psort_context
+// (sort_mode / merge_mode come -s / -m) e scritti come run in un file temporaneo
+// "<output_path>.runs"; la lettura del blocco successivo e la scrittura del run
+// precedente avvengono in un thread di I/O mentre il pool ordina il blocco corrente.
+// Fase 2: il file dei run è mappato con mmap e unito a blocchi con il loser tree
+// (kway_merge), ogni blocco di output diviso con kway_split tra i P thread dello
+// stesso pool della Fase 1 (psort_parallel_for); il blocco
+// precedente viene scritto in background e le pagine dei run necessarie per il
+// blocco successivo sono richieste in anticipo con madvise(MADV_WILLNEED).
+// L'output è scritto in "<output_path>.tmp" e rinominato solo a ordinamento riuscito;
+// input e output non possono essere lo stesso file.
+// Restituisce 0 in caso di successo, -1 in caso di errore di I/O, di allocazione
+// del merge o di creazione del pool (messaggio stampato).
+int external_sort_file(const char *input_path, const char *output_path, int n_threads,
+                       SortMode sort_mode, MergeMode merge_mode, long mem_bytes,
+                       ExtSortStats *stats);
+
+#endif // EXTSORT_H
@@ -0,0 +1,25 @@
+#ifndef INTSORT_H
+#define INTSORT_H
+
+#include "common.h" // Include ThreadArgs, Task, etc.
+
+// --- Dichiarazioni Ordinamenti per Chiavi Intere ---
+// Alternative alla pipeline qsort + merge, selezionate con l'opzione -s.
+// Sono eseguite da tutti i P worker dentro worker_thread e lasciano
+// l'array ordinato in t_args->array.
+
+// Radix sort LSD parallelo su int a 32 bit (4 passi da 8 bit).
+// Ogni passo: istogramma per-thread, prefix-sum globale, scatter.
+void radix_sort_phase(ThreadArgs *t_args);
+
+// Sample sort parallelo: splitter da un campione, istogramma per-thread dei
+// bucket, prefix-sum e scatter in temp_array, poi i bucket sono task della
+// coda concorrente ordinati dai worker con sort_int.
+void sample_sort_phase(ThreadArgs *t_args);
+
+// Passo tra le righe dell'istogramma del sample sort: P contatori arrotondati
+// a un multiplo della linea di cache, così worker diversi non incrementano mai
+// la stessa linea nel ciclo di conteggio.
+#define SAMPLE_HIST_STRIDE(P) (((long)(P) + CACHE_LINE_LONGS - 1) / CACHE_LINE_LONGS * CACHE_LINE_LONGS)
+
+#endif // INTSORT_H
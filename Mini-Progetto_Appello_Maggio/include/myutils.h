@@ -12,10 +12,38 @@ int qsort_compare(const void *a, const void *b);
 // Unisce due sezioni adiacenti e ordinate (start1..end1, start2..end2)
 // presenti nell'array 'source' e scrive il risultato ordinato
 // nell'array 'dest' nella sezione combinata start1..end2.
-void merge_sections(int *source, int *dest, int start1, int end1, int start2, int end2, long N_total);
+void merge_sections(int *source, int *dest, long start1, long end1, long start2, long end2, long N_total);
+
+// Indice di inizio della partizione originale 'i' (i >= 0) secondo la
+// suddivisione della Fase 1: le prime N % P partizioni hanno un elemento in più.
+// Per i >= P restituisce N (partizioni oltre l'ultima sono vuote).
+long partition_start(long N, int P, long i);
+
+// Co-rank (merge-path): dati due run ordinati a[0..na) e b[0..nb), restituisce
+// quanti elementi di 'a' compaiono tra i primi 'd' elementi del loro merge
+// (a parità di valore vince 'a', come in merge_sections). 0 <= d <= na + nb.
+long co_rank(long d, const int *a, long na, const int *b, long nb);
+
+// Splitter per il merge P-way: dati k run ordinati, calcola in pos[r] quanti
+// elementi del run r compaiono tra i primi 'd' elementi del loro merge
+// (a parità di valore vince il run con indice minore). 0 <= d <= somma di lens.
+void kway_split(const int *const *runs, const long *lens, int k, long d, long *pos);
+
+// Merge P-way con loser tree: unisce k run ordinati runs[r][0..lens[r])
+// scrivendo in 'out' la somma delle lunghezze in ordine (stabile per indice di run).
+void kway_merge(const int *const *runs, const long *lens, int k, int *out);
 
 // Funzione per stampare l'array (o una sua parte se N è grande).
 // Utile per il debug e per visualizzare lo stato dell'ordinamento.
 void print_array(const char *label, int *arr, long n);
 
+// Alloca n elementi di 'size' byte azzerati, con l'inizio allineato a
+// CACHE_LINE_SIZE (per strutture con _Alignas(CACHE_LINE_SIZE) o righe per
+// thread). Restituisce NULL in caso di errore; la memoria si libera con free.
+void *cache_aligned_calloc(size_t n, size_t size);
+
+// Restituisce l'istante corrente (CLOCK_MONOTONIC) in millisecondi.
+// Usata per misurare la durata delle fasi dell'ordinamento.
+double get_time_ms(void);
+
 #endif // MYUTILS_H
\ No newline at end of file
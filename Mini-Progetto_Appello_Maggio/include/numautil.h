@@ -0,0 +1,40 @@
+#ifndef NUMAUTIL_H
+#define NUMAUTIL_H
+
+#include "common.h" // Per accesso a tipi base se necessario
+
+// --- Utilità NUMA (solo syscall Linux, senza libnuma) ---
+
+// NumaPolicy: Politica di allocazione di array e temp_array (opzione -N).
+typedef enum {
+    NUMA_MALLOC = 0,  // malloc e inizializzazione dal thread principale (schema originale)
+    NUMA_FIRST_TOUCH, // mmap, pagine toccate per prime dal worker proprietario della partizione
+    NUMA_INTERLEAVE,  // mmap + mbind(MPOL_INTERLEAVE) su tutti i nodi, poi first-touch parallelo
+    NUMA_POLICY_COUNT // Numero di politiche (non è una politica valida)
+} NumaPolicy;
+
+// Numero di nodi NUMA online (da /sys/devices/system/node); 1 se non determinabile.
+int numa_count_nodes(void);
+
+// Nodo NUMA della CPU su cui gira il thread chiamante (syscall getcpu); 0 se non disponibile.
+int numa_node_of_current_cpu(void);
+
+// Alloca 'bytes' byte secondo 'policy'. Con NUMA_FIRST_TOUCH e NUMA_INTERLEAVE la
+// memoria è mappata con mmap e le pagine non sono ancora assegnate a un nodo.
+// Restituisce NULL in caso di errore.
+void *numa_alloc_buffer(size_t bytes, NumaPolicy policy);
+
+// Libera un buffer di numa_alloc_buffer (stessi 'bytes' e 'policy').
+void numa_free_buffer(void *buf, size_t bytes, NumaPolicy policy);
+
+// Fissa il thread chiamante a una CPU tra quelle permesse al processo, scelta
+// in modo da distribuire indici consecutivi a turno sui nodi (0 -> nodo 0,
+// 1 -> nodo 1, ...). Restituisce 0 in caso di successo, -1 altrimenti.
+int numa_pin_thread(int index);
+
+// Nodo di ciascuna delle 'count' pagine a partire da 'addr' (syscall move_pages
+// in sola interrogazione): nodes[i] < 0 se la pagina non è presente.
+// Restituisce 0 in caso di successo, -1 se l'interrogazione non è supportata.
+int numa_query_pages(const void *addr, long count, int *nodes);
+
+#endif // NUMAUTIL_H
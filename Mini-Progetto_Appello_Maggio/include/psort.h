@@ -0,0 +1,104 @@
+#ifndef PSORT_H
+#define PSORT_H
+
+#include "common.h"  // Include MergeMode, SortMode, ThreadArgs
+#include "recsort.h" // Include RecordKernel e i tipi di record
+
+// --- API di Libreria per l'Ordinamento Parallelo ---
+// Un psort_context possiede un pool di P thread che eseguono worker_thread,
+// creati una sola volta da psort_create e riusati da ogni psort_sort_int:
+// tra un ordinamento e l'altro i thread restano in attesa su una variabile di
+// condizione. Coda, barriera, mutex, istogrammi e buffer temporaneo interno
+// sono anch'essi allocati una volta sola (il buffer cresce solo se serve).
+// Le chiamate sullo stesso contesto non devono essere concorrenti.
+typedef struct psort_context psort_context;
+
+// Crea un contesto con 'n_threads' worker (P >= 1) e le strategie di
+// ordinamento (-s) e merge (-m) indicate.
+// Restituisce NULL in caso di errore (con messaggio stampato).
+psort_context *psort_create(int n_threads, SortMode sort_mode, MergeMode merge_mode);
+
+// Ordina in modo crescente data[0..n) usando il pool del contesto.
+// 'scratch' (opzionale, NULL per usare il buffer interno) deve contenere
+// almeno n int e non sovrapporsi a 'data'.
+// Restituisce 0 in caso di successo, -1 se gli argomenti non sono validi o
+// l'allocazione del buffer interno fallisce (data non è stato toccato).
+int psort_sort_int(psort_context *ctx, int *data, long n, int *scratch);
+
+// Ordina per chiave n record del tipo descritto da 'kernel' (es. &payload16_kernel
+// per un array di PayloadRecord16). 'scratch' come per psort_sort_int, di almeno
+// n * kernel->size byte. Sort e merge modes del contesto non si applicano: i record
+// usano sempre l'introsort del kernel e il merge co-rank.
+// Restituisce 0 in caso di successo, -1 se gli argomenti non sono validi o
+// l'allocazione del buffer interno fallisce (data non è stato toccato).
+int psort_sort_records(psort_context *ctx, const RecordKernel *kernel, void *data, long n, void *scratch);
+
+// Attiva (default) o disattiva il rilevamento dei run naturali in psort_sort_int
+// (vedi runs.h): input già ordinato, invertito o fatto di pochi run ordinati
+// non viene ordinato da capo.
+void psort_set_adaptive(psort_context *ctx, int enabled);
+
+// Numero di worker (P) del contesto.
+int psort_n_threads(const psort_context *ctx);
+
+// --- Cicli Paralleli sul Pool ---
+
+// Funzione eseguita dal thread 'index' sulla fetta [lo, hi) di un intervallo.
+typedef void (*PsortRangeFn)(void *arg, int index, long lo, long hi);
+
+// Divide [0, n) in P fette con partition_start e chiama fn(arg, i, lo_i, hi_i)
+// dal thread i del pool, la stessa fetta che il thread possiede negli ordinamenti.
+// Ritorna quando tutti i thread hanno terminato.
+void psort_parallel_for(psort_context *ctx, long n, PsortRangeFn fn, void *arg);
+
+// --- Posizionamento NUMA (vedi numautil.h) ---
+
+// Fissa il thread i del pool a una CPU, distribuendo i thread a turno sui nodi NUMA.
+// Restituisce 0 se tutti i thread sono stati fissati, -1 altrimenti.
+int psort_pin_threads(psort_context *ctx);
+
+// Scrive (azzera) buf[0..n) in parallelo: il thread i tocca per primo la fetta
+// [partition_start(n, P, i), partition_start(n, P, i+1)), la stessa che possiede
+// nelle fasi divise staticamente, così le sue pagine sono allocate sul suo nodo.
+void psort_first_touch(psort_context *ctx, void *buf, long n, size_t elem_size);
+
+// Conta le pagine di buf[0..n) che si trovano sul nodo del thread proprietario
+// della fetta (locali) o su un altro nodo (remote). Il nodo di ogni thread è
+// quello registrato dall'ultimo psort_pin_threads o psort_first_touch.
+// Restituisce -1 se il kernel non permette l'interrogazione.
+int psort_page_locality(const psort_context *ctx, const void *buf, long n, size_t elem_size,
+                        long *local_pages, long *remote_pages);
+
+// --- Misura per Fase (vedi trace.h) ---
+
+// Attiva la registrazione, da parte di ogni worker, dell'inizio e della fine di
+// ogni fase (partizionamento, sort, passo di merge k, copia, attese sulle barriere)
+// e, se perf_event_open è disponibile, dei contatori hardware del suo thread.
+// Restituisce 0 in caso di successo, -1 se l'allocazione fallisce.
+int psort_enable_stats(psort_context *ctx);
+
+// Scrive le fasi dell'ultimo ordinamento in CSV (json == 0) o in JSON con
+// riepilogo per passo (json != 0); 'label' identifica l'esecuzione nel JSON.
+// Restituisce -1 se la misura non è stata attivata con psort_enable_stats.
+int psort_write_stats(const psort_context *ctx, FILE *out, int json, const char *label);
+
+// --- Registro Eventi (vedi eventlog.h) ---
+
+// Attiva il registro eventi dei worker (avvio, task, merge pianificati, terminazione),
+// scritto senza lock in un buffer circolare per worker invece di essere stampato.
+// Restituisce 0 in caso di successo, -1 se l'allocazione fallisce.
+int psort_enable_event_log(psort_context *ctx);
+
+// Stampa su 'out', in ordine di tempo, gli eventi dell'ultimo ordinamento
+// (non fa nulla se il registro non è attivo).
+void psort_dump_event_log(const psort_context *ctx, FILE *out);
+
+// Durata in ms della fase di merge dell'ultimo psort_sort_int
+// (0 con -s radix / -s sample, che non hanno una fase di merge separata;
+// per i run naturali, la durata dei passi di merge dei run).
+double psort_merge_time_ms(const psort_context *ctx);
+
+// Termina i thread del pool e libera tutte le risorse del contesto.
+void psort_destroy(psort_context *ctx);
+
+#endif // PSORT_H
@@ -1,34 +1,100 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include <stdatomic.h> // Per atomic_long, atomic_uint, atomic_int
+#include <time.h>      // Per struct timespec
+
 #include "common.h" // Include Task, ThreadArgs, etc.
 
-// Nodo della lista linkata usata per implementare la coda.
-typedef struct Node {
-    Partition_Index_Task task;    // Il task (start, end) contenuto nel nodo
-    struct Node *next;  // Puntatore al nodo successivo nella coda
-} Node;
+#define QUEUE_DEFAULT_CAPACITY 64 // Capacità iniziale se init_queue riceve capacity <= 0
+#define QUEUE_LOCKFREE_SPINS 1024 // Tentativi di pop con attesa attiva prima del futex (variante lock-free)
+
+// Esiti di try_pop e pop_timeout oltre a 1 (task estratto) e 0 (coda vuota e chiusa).
+#define QUEUE_EMPTY (-1)      // try_pop: coda vuota, ma non chiusa
+#define QUEUE_TIMEOUT (-2)    // pop_timeout: scadenza raggiunta senza task
+#define QUEUE_CANCELLED (-3)  // Coda vuota e cancellata con cancel_queue
+#define QUEUE_INVALID (-4)    // pop_timeout: scadenza non valida (tv_nsec fuori da [0, 1e9), EINVAL)
+
+// --- Variante Lock-Free (init_queue_lockfree) ---
+// Ring MPMC limitato con numeri di sequenza per slot (D. Vyukov): lo slot i
+// contiene il task inserito alla posizione pos (pos & mask == i) quando
+// seq == pos + 1, ed è libero per la posizione pos quando seq == pos.
+// Produttori e consumatori si contendono solo enqueue_pos e dequeue_pos con
+// una CAS, senza mutex. Stesso contratto di push/pop/close_queue, ma con
+// capacità fissa: un consumatore che trova la coda vuota (o un produttore che
+// la trova piena) riprova per spin_limit volte, poi si blocca su un futex
+// dell'EventCount corrispondente.
+
+// EventCount: Attesa su futex di una condizione del ring (non vuoto o non pieno).
+// Chi cambia la condizione incrementa 'events' e fa FUTEX_WAKE solo se c'è
+// qualcuno bloccato e nessun risveglio è già in corso ('notified'); chi viene
+// svegliato e trova la condizione ancora vera sveglia il successivo, così una
+// raffica di push non costa una FUTEX_WAKE per task.
+typedef struct {
+    atomic_uint events;          // Contatore di eventi: parola del futex
+    atomic_int waiters;          // Thread bloccati o in procinto di bloccarsi sul futex
+    atomic_int notified;         // 1: un thread è stato svegliato e non ha ancora ripreso
+} EventCount;
+
+// QueueSlot: Slot del ring lock-free.
+typedef struct {
+    atomic_long seq;             // Numero di sequenza (vedi sopra)
+    Partition_Index_Task task;
+} QueueSlot;
+
+// LockFreeRing: Stato della variante lock-free.
+// Una linea di cache per i campi letti da tutti (scritti solo da init, close e
+// cancel), poi una per ogni campo scritto di continuo: enqueue_pos dai soli
+// produttori, dequeue_pos dai soli consumatori e i due EventCount da chi si
+// blocca. Così una CAS su enqueue_pos non invalida la linea di dequeue_pos.
+typedef struct {
+    QueueSlot *slots;            // mask + 1 slot (potenza di 2)
+    long mask;
+    int spin_limit;              // Tentativi prima del futex (0 con una sola CPU)
+    atomic_int closed;           // Come ConcurrentQueue.closed
+    atomic_int cancelled;        // Come ConcurrentQueue.cancelled
+    _Alignas(CACHE_LINE_SIZE) atomic_long enqueue_pos; // Prossima posizione da riempire
+    _Alignas(CACHE_LINE_SIZE) atomic_long dequeue_pos; // Prossima posizione da svuotare
+    _Alignas(CACHE_LINE_SIZE) EventCount not_empty;    // Consumatori in attesa di un task (o della chiusura)
+    _Alignas(CACHE_LINE_SIZE) EventCount not_full;     // Produttori in attesa di uno slot libero
+} LockFreeRing;
 
 // Struttura Coda Concorrente (Q nel testo d'esame).
 // Le operazioni push e pop sono thread-safe.
+// I task stanno in un buffer circolare allocato da init_queue: push e pop non
+// allocano né liberano memoria; solo una push sulla coda piena raddoppia il buffer.
+// Disposizione per linee di cache: prima i campi quasi in sola lettura, poi il
+// mutex con lo stato che protegge (acquisito da produttori e consumatori, si
+// sposta comunque insieme al lock), infine la variabile di condizione, scritta
+// dai consumatori che si bloccano, su una linea propria. La struttura occupa
+// linee intere, quindi non ne condivide con i campi vicini (es. in psort_context).
 struct ConcurrentQueue {
-    Node *head;             
-    Node *tail;             
-    pthread_mutex_t mutex;  // Mutex per garantire accesso esclusivo alla coda
-    pthread_cond_t cond_non_empty; // Variabile di condizione per segnalare quando la coda non è vuota
+    LockFreeRing *lf;       // Variante lock-free (init_queue_lockfree), NULL: versione con mutex
+    Partition_Index_Task *tasks; // Buffer circolare di 'capacity' task
+    long capacity;          // Task allocati in tasks
+    _Alignas(CACHE_LINE_SIZE) pthread_mutex_t mutex; // Mutex per garantire accesso esclusivo alla coda
+    long head;              // Indice in tasks del prossimo task da estrarre
+    long task_count;        // Numero di task nella coda: tasks[head], ..., tasks[(head + task_count - 1) % capacity]
     int closed;             // Flag: 1 se non verranno aggiunti più task iniziali, 0 altrimenti
-    long task_count;        // Numero di task attualmente nella coda (per debug/info)
+    int cancelled;          // Flag: 1 dopo cancel_queue, i pop sulla coda vuota non attendono più
+    _Alignas(CACHE_LINE_SIZE) pthread_cond_t cond_non_empty; // Variabile di condizione per segnalare quando la coda non è vuota
 };
 
 // --- Dichiarazioni Funzioni Coda ---
 
-// Inizializza la coda concorrente.
+// Inizializza la coda concorrente con spazio per 'capacity' task
+// (QUEUE_DEFAULT_CAPACITY se capacity <= 0); oltre, la coda cresce.
 // Deve essere chiamata prima di usare la coda.
 // Restituisce 0 in caso di successo, -1 in caso di errore.
-int init_queue(ConcurrentQueue *q);
+int init_queue(ConcurrentQueue *q, long capacity);
+
+// Inizializza la coda nella variante lock-free (vedi sopra) con capacità fissa:
+// 'capacity' arrotondata alla potenza di 2 successiva (QUEUE_DEFAULT_CAPACITY se <= 0).
+// Restituisce 0 in caso di successo, -1 in caso di errore.
+int init_queue_lockfree(ConcurrentQueue *q, long capacity);
 
 // Distrugge la coda concorrente.
-// Libera la memoria dei nodi rimanenti e distrugge mutex/cond var.
+// Libera il buffer dei task e distrugge mutex/cond var.
 // Deve essere chiamata quando la coda non è più necessaria.
 void destroy_queue(ConcurrentQueue *q);
 
@@ -40,12 +106,44 @@ void push(ConcurrentQueue *q, Partition_Index_Task task);
 // Se la coda è vuota, attende finché non arriva un task o la coda viene chiusa.
 // Corrisponde all'operazione 'pop' menzionata nel testo d'esame.
 // Restituisce 1 se un task è stato estratto con successo (e copiato in 'task').
-// Restituisce 0 se la coda è vuota E chiusa (non arriveranno altri task).
+// Restituisce 0 se la coda è vuota E chiusa (non arriveranno altri task) o cancellata.
 int pop(ConcurrentQueue *q, Partition_Index_Task *task);
 
+// Come pop, ma senza attendere: restituisce 1 con il task estratto, 0 se la coda
+// è vuota e chiusa, QUEUE_CANCELLED se è vuota e cancellata, QUEUE_EMPTY se è solo vuota.
+int try_pop(ConcurrentQueue *q, Partition_Index_Task *task);
+
+// Come pop, ma attende al più fino a 'deadline', istante assoluto su
+// CLOCK_MONOTONIC (NULL: nessuna scadenza). Restituisce 1 con il task estratto,
+// 0 se la coda è vuota e chiusa, QUEUE_CANCELLED se è vuota e cancellata,
+// QUEUE_TIMEOUT se la scadenza arriva prima di un task, QUEUE_INVALID se
+// la coda è vuota e la scadenza non è valida (l'attesa fallisce con EINVAL).
+int pop_timeout(ConcurrentQueue *q, Partition_Index_Task *task, const struct timespec *deadline);
+
+// Inserisce i k task di 'tasks' in fondo alla coda con una sola acquisizione
+// del mutex e un solo risveglio dei thread in attesa (broadcast se k > 1).
+void push_n(ConcurrentQueue *q, const Partition_Index_Task *tasks, long k);
+
+// Come pop, ma estrae fino a k task (quelli presenti, senza attenderne altri)
+// in 'tasks' con una sola acquisizione del mutex.
+// Restituisce il numero di task estratti (da 1 a k), 0 se la coda è vuota E chiusa (o cancellata).
+long pop_n(ConcurrentQueue *q, Partition_Index_Task *tasks, long k);
+
 // Segnala che non verranno più aggiunti task iniziali alla coda.
 // Usato da Worker 0 dopo aver inserito tutte le partizioni iniziali.
 // Permette ai worker in attesa su pop di terminare se la coda diventa vuota.
 void close_queue(ConcurrentQueue *q);
 
+// Cancella la coda (ad es. un thread supervisore allo spegnimento o quando un
+// produttore è bloccato): sveglia tutti i thread in attesa su pop e da quel
+// momento i pop sulla coda vuota non attendono più e restituiscono 0
+// (QUEUE_CANCELLED per try_pop e pop_timeout). I task ancora in coda possono
+// essere estratti (drenaggio). I produttori non sono interessati: una push
+// sulla coda lock-free piena continua ad attendere i consumatori.
+void cancel_queue(ConcurrentQueue *q);
+
+// Riapre una coda chiusa (o cancellata) e vuota, così da poterla riusare per un nuovo ordinamento
+// (usata da psort_sort_int). Nessun thread deve essere in attesa su pop.
+void reset_queue(ConcurrentQueue *q);
+
 #endif // QUEUE_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef RECSORT_H
+#define RECSORT_H
+
+#include <stdint.h> // Per int64_t
+
+#include "common.h" // Include ThreadArgs, Task, etc.
+
+// --- Tipi di Record Ordinabili ---
+// Tutti i record iniziano con una chiave int64_t (il campo ordinato) seguita
+// da un contenuto di dimensione fissa, nota a tempo di compilazione.
+
+// Coppia chiave + indice (es. per ottenere la permutazione ordinata di un array).
+typedef struct {
+    int64_t key;
+    int64_t index;
+} KeyIndexRecord;
+
+// Chiave + payload opaco di BYTES byte.
+#define DEFINE_PAYLOAD_RECORD(BYTES) \
+    typedef struct { \
+        int64_t key; \
+        unsigned char payload[BYTES]; \
+    } PayloadRecord##BYTES
+
+DEFINE_PAYLOAD_RECORD(8);
+DEFINE_PAYLOAD_RECORD(16);
+DEFINE_PAYLOAD_RECORD(32);
+DEFINE_PAYLOAD_RECORD(64);
+
+// RecordKernel: kernel di ordinamento per un tipo di record.
+// Le funzioni sono generate da recsort_template.h per ogni tipo, quindi
+// confronti e spostamenti usano sizeof(tipo) costante (nessuna memcpy di
+// dimensione variabile nei cicli interni); il chiamante le usa solo a livello
+// di partizione, tramite puntatori void e 'size'.
+typedef struct RecordKernel {
+    const char *name; // Nome accettato dall'opzione -t
+    size_t size;      // sizeof del record
+    // Ordina n record per chiave crescente (introsort, non stabile)
+    void (*sort)(void *base, long n);
+    // Unisce due run ordinati a[0..na) e b[0..nb) in 'out' (a parità di chiave vince 'a')
+    void (*merge)(const void *a, long na, const void *b, long nb, void *out);
+    // Come co_rank (myutils.h), sulle chiavi dei record
+    long (*co_rank)(long d, const void *a, long na, const void *b, long nb);
+} RecordKernel;
+
+extern const RecordKernel key_index_kernel; // KeyIndexRecord
+extern const RecordKernel payload8_kernel;  // PayloadRecord8
+extern const RecordKernel payload16_kernel; // PayloadRecord16
+extern const RecordKernel payload32_kernel; // PayloadRecord32
+extern const RecordKernel payload64_kernel; // PayloadRecord64
+
+// Restituisce il kernel con il nome dato ("keyindex", "rec8", ..., "rec64"),
+// oppure NULL se il nome non corrisponde a nessun tipo.
+const RecordKernel *record_kernel_by_name(const char *name);
+
+// Ordinamento parallelo di record eseguito da tutti i P worker dentro worker_thread
+// (al posto delle fasi per int): partizioni della Fase 1 accodate e ordinate
+// con kernel->sort, poi merge co-rank ping-pong come -m corank. Il risultato
+// resta in t_args->records.
+void record_sort_phase(ThreadArgs *t_args);
+
+#endif // RECSORT_H
@@ -0,0 +1,155 @@
+// Template dei kernel di ordinamento per record: incluso da recsort.c una volta
+// per ogni tipo, dopo aver definito
+//   RECORD_TYPE   il tipo del record (struct con campo int64_t key in testa)
+//   RECORD_PREFIX il prefisso dei nomi generati (es. payload16)
+//   RECORD_NAME   il nome del tipo per l'opzione -t (es. "rec16")
+// Genera RECORD_PREFIX_sort, _merge, _co_rank (static) e la costante
+// RECORD_PREFIX_kernel. Nessuna include guard: l'inclusione multipla è voluta.
+
+#if !defined(RECORD_TYPE) || !defined(RECORD_PREFIX) || !defined(RECORD_NAME)
+#error "Definire RECORD_TYPE, RECORD_PREFIX e RECORD_NAME prima di includere recsort_template.h"
+#endif
+
+#define RECORD_CAT_(a, b) a##_##b
+#define RECORD_CAT(a, b) RECORD_CAT_(a, b)
+#define RECORD_FN(name) RECORD_CAT(RECORD_PREFIX, name)
+
+/**
+ * @brief Insertion sort per chiave: caso base dell'introsort.
+ */
+static inline void RECORD_FN(insertion_sort)(RECORD_TYPE *a, long n) {
+    for (long i = 1; i < n; ++i) {
+        RECORD_TYPE v = a[i];
+        long j = i - 1;
+        while (j >= 0 && a[j].key > v.key) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+}
+
+/**
+ * @brief Ripristina la proprietà di max-heap a partire dal nodo i.
+ */
+static inline void RECORD_FN(sift_down)(RECORD_TYPE *a, long i, long n) {
+    RECORD_TYPE v = a[i];
+    for (;;) {
+        long child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && a[child + 1].key > a[child].key) child++;
+        if (a[child].key <= v.key) break;
+        a[i] = a[child];
+        i = child;
+    }
+    a[i] = v;
+}
+
+/**
+ * @brief Heapsort: fallback dell'introsort quando la ricorsione è troppo profonda.
+ */
+static void RECORD_FN(heap_sort)(RECORD_TYPE *a, long n) {
+    for (long i = n / 2 - 1; i >= 0; --i) RECORD_FN(sift_down)(a, i, n);
+    for (long end = n - 1; end > 0; --end) {
+        RECORD_TYPE tmp = a[0];
+        a[0] = a[end];
+        a[end] = tmp;
+        RECORD_FN(sift_down)(a, 0, end);
+    }
+}
+
+/**
+ * @brief Corpo dell'introsort (stesso schema di introsort_int in sortkernel.c):
+ * pivot mediana di tre, partizione di Hoare sulla chiave, ricorsione sulla parte minore.
+ */
+static void RECORD_FN(introsort)(RECORD_TYPE *a, long n, int depth_limit) {
+    while (n > RECORD_LEAF_SIZE) {
+        if (depth_limit-- == 0) {
+            RECORD_FN(heap_sort)(a, n);
+            return;
+        }
+
+        int64_t x = a[0].key, y = a[n / 2].key, z = a[n - 1].key;
+        int64_t pivot = (x < y) ? ((y < z) ? y : (x < z ? z : x))
+                                : ((x < z) ? x : (y < z ? z : y));
+
+        long i = -1, j = n;
+        for (;;) {
+            do { i++; } while (a[i].key < pivot);
+            do { j--; } while (a[j].key > pivot);
+            if (i >= j) break;
+            RECORD_TYPE tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+        }
+        long left = j + 1; // a[0..j] <= pivot <= a[j+1..n-1]
+
+        if (left < n - left) {
+            RECORD_FN(introsort)(a, left, depth_limit);
+            a += left;
+            n -= left;
+        } else {
+            RECORD_FN(introsort)(a + left, n - left, depth_limit);
+            n = left;
+        }
+    }
+    RECORD_FN(insertion_sort)(a, n);
+}
+
+/**
+ * @brief Ordina n record per chiave crescente (campo 'sort' del kernel).
+ */
+static void RECORD_FN(sort)(void *base, long n) {
+    if (n > 1) RECORD_FN(introsort)((RECORD_TYPE *)base, n, record_depth_limit(n));
+}
+
+/**
+ * @brief Merge di due run di record (campo 'merge' del kernel).
+ *
+ * Come merge_int_scalar, la scelta del run è un confronto 0/1 senza salti: qui
+ * si seleziona il puntatore sorgente e si copia un solo record di dimensione fissa.
+ */
+static void RECORD_FN(merge)(const void *va, long na, const void *vb, long nb, void *vout) {
+    const RECORD_TYPE *a = (const RECORD_TYPE *)va;
+    const RECORD_TYPE *b = (const RECORD_TYPE *)vb;
+    RECORD_TYPE *out = (RECORD_TYPE *)vout;
+    long i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        int take_a = (a[i].key <= b[j].key); // A parità vince 'a'
+        const RECORD_TYPE *pick = take_a ? &a[i] : &b[j];
+        out[k++] = *pick;
+        i += take_a;
+        j += !take_a;
+    }
+    if (i < na) memcpy(&out[k], &a[i], (na - i) * sizeof(RECORD_TYPE));
+    if (j < nb) memcpy(&out[k], &b[j], (nb - j) * sizeof(RECORD_TYPE));
+}
+
+/**
+ * @brief Co-rank sulle chiavi (campo 'co_rank' del kernel), vedi co_rank in myutils.c.
+ */
+static long RECORD_FN(co_rank)(long d, const void *va, long na, const void *vb, long nb) {
+    const RECORD_TYPE *a = (const RECORD_TYPE *)va;
+    const RECORD_TYPE *b = (const RECORD_TYPE *)vb;
+    long lo = (d > nb) ? d - nb : 0;
+    long hi = (d < na) ? d : na;
+    while (lo < hi) {
+        long i = lo + (hi - lo) / 2;
+        long j = d - i;
+        // Con i elementi di 'a' ne servono di più se a[i] precede ancora b[j - 1]
+        if (j > 0 && a[i].key <= b[j - 1].key) lo = i + 1;
+        else hi = i;
+    }
+    return lo;
+}
+
+const RecordKernel RECORD_CAT(RECORD_PREFIX, kernel) = {
+    RECORD_NAME, sizeof(RECORD_TYPE), RECORD_FN(sort), RECORD_FN(merge), RECORD_FN(co_rank)
+};
+
+#undef RECORD_FN
+#undef RECORD_CAT
+#undef RECORD_CAT_
+#undef RECORD_TYPE
+#undef RECORD_PREFIX
+#undef RECORD_NAME
@@ -0,0 +1,35 @@
+#ifndef RUNS_H
+#define RUNS_H
+
+#include "psort.h" // Per psort_context, psort_parallel_for
+
+// --- Ordinamento Adattivo: Run Naturali (int) ---
+// Prima di ordinare, psort_sort_int scandisce l'input in parallelo (una sola
+// lettura, interrotta presto sui dati casuali) dividendolo in run monotoni:
+// un nuovo run inizia dove la direzione (salita a[i] < a[i+1] o discesa
+// a[i] > a[i+1], gli uguali non contano) cambia.
+// - un solo run crescente: l'input è già ordinato, finisce in O(N/P);
+// - un solo run decrescente: basta invertirlo in parallelo;
+// - al più RUNS_MAX_RUNS run lunghi in media almeno RUNS_MIN_RUN_LEN (pochi
+//   flussi ordinati concatenati): come in TimSort i run decrescenti vengono
+//   invertiti e i run uniti a coppie, in ceil(log2(run)) passi paralleli con il co-rank.
+// Negli altri casi l'ordinamento procede normalmente.
+
+#define RUNS_MAX_RUNS 64     // Run oltre i quali conviene l'ordinamento completo
+#define RUNS_MIN_RUN_LEN 32  // Lunghezza media minima dei run per unirli
+
+// Percorso scelto da runs_sort_int.
+typedef enum {
+    RUNS_NONE = 0,  // Troppi run (o scansione non allocata): serve l'ordinamento completo
+    RUNS_SORTED,    // Già ordinato
+    RUNS_REVERSED,  // Un solo run decrescente, invertito
+    RUNS_MERGED     // Pochi run, uniti
+} RunsOutcome;
+
+// Cerca i run di data[0..n) e, se sono pochi, ordina data senza l'ordinamento
+// completo usando scratch (almeno n int) per i passi di merge.
+// In *merge_time_ms la durata dei passi di merge (0 se non ce ne sono).
+// Restituisce RUNS_NONE se data non è stato toccato e va ordinato normalmente.
+RunsOutcome runs_sort_int(psort_context *ctx, int *data, long n, int *scratch, double *merge_time_ms);
+
+#endif // RUNS_H
@@ -0,0 +1,35 @@
+#ifndef SORTKERNEL_H
+#define SORTKERNEL_H
+
+#include "common.h" // Per accesso a tipi base se necessario
+
+// --- Kernel di Ordinamento e Merge Specializzati per int ---
+
+// Ordina in modo crescente n interi (introsort con confronto inline).
+// Sostituisce qsort + qsort_compare nella fase di sorting delle partizioni:
+// nessuna chiamata indiretta per confronto. Le partizioni piccole (<= 16
+// elementi) sono ordinate da una rete di ordinamento AVX2 se la CPU la
+// supporta (controllo a runtime), altrimenti da un insertion sort scalare.
+void sort_int(int *a, long n);
+
+// Un passo di partizione di sort_int (Hoare, mediana di tre) su n >= 2 interi:
+// restituisce left in [1, n-1] con a[0..left) <= a[left..n). Ordinare poi le
+// due parti separatamente (anche su thread diversi) ordina tutto a[0..n).
+long partition_int(int *a, long n);
+
+// Come sort_int, ma usa sempre il caso base scalare (per confronti e test).
+void sort_int_scalar(int *a, long n);
+
+// Restituisce 1 se sort_int e merge_int useranno i percorsi AVX2 su questa CPU.
+int sort_int_has_avx2(void);
+
+// Unisce due run ordinati a[0..na) e b[0..nb), anche non adiacenti, scrivendo
+// na + nb elementi ordinati in 'out' (non sovrapposto ai run). Con AVX2 unisce
+// 8 elementi per iterazione con una rete bitonica; altrimenti usa merge_int_scalar.
+void merge_int(const int *a, long na, const int *b, long nb, int *out);
+
+// Merge scalare branchless (la scelta del run diventa una cmov, senza salti
+// condizionali da predire): caso generale senza AVX2 e code del merge AVX2.
+void merge_int_scalar(const int *a, long na, const int *b, long nb, int *out);
+
+#endif // SORTKERNEL_H
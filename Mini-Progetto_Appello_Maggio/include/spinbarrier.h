@@ -0,0 +1,45 @@
+#ifndef SPINBARRIER_H
+#define SPINBARRIER_H
+
+#include <stdatomic.h> // Per atomic_int, atomic_uint
+
+#include "common.h" // Per CACHE_LINE_SIZE
+
+// --- Barriera Spin-then-Block dei Worker ---
+// Sostituisce pthread_barrier_t nelle fasi dei worker: ogni pthread_barrier_wait
+// entra nel kernel (futex) anche quando gli altri thread arrivano pochi
+// microsecondi dopo, e con N piccolo e P grande le 1 + 2*log2(P) barriere
+// costano più dei merge.
+// Barriera centralizzata a inversione di senso: il "senso" è il contatore dei
+// turni 'generation', incrementato dall'ultimo thread che arriva. Gli altri
+// lo osservano girando per al più 'spin_limit' iterazioni e poi si bloccano
+// su un futex sulla stessa parola; l'ultimo thread chiama FUTEX_WAKE solo se
+// qualcuno si è davvero bloccato. Contatore e turno stanno su cache line
+// diverse, così gli arrivi non invalidano la linea su cui girano i thread in attesa.
+
+#define SPIN_BARRIER_SERIAL_THREAD (-1) // Come PTHREAD_BARRIER_SERIAL_THREAD
+#define SPIN_BARRIER_SPINS 4096         // Iterazioni di attesa attiva prima del futex
+
+typedef struct SpinBarrier {
+    _Alignas(CACHE_LINE_SIZE) atomic_int remaining; // Thread che devono ancora arrivare nel turno corrente
+    int n_threads;                     // Thread che partecipano alla barriera
+    int spin_limit;                    // Iterazioni di attesa attiva (0: blocca subito)
+    _Alignas(CACHE_LINE_SIZE) atomic_uint generation; // Turno corrente: parola del futex
+    atomic_int sleepers;               // Thread bloccati sul futex
+} SpinBarrier;
+
+// Inizializza una barriera per n_threads thread. Se i thread sono più delle
+// CPU disponibili l'attesa attiva ruberebbe la CPU proprio a chi deve ancora
+// arrivare: in quel caso spin_limit è 0 e la barriera si blocca subito.
+// Restituisce 0 in caso di successo, EINVAL se n_threads < 1.
+int spin_barrier_init(SpinBarrier *b, int n_threads);
+
+// Non ci sono risorse del kernel da liberare: esiste per simmetria con pthread.
+void spin_barrier_destroy(SpinBarrier *b);
+
+// Attende che tutti gli n_threads thread abbiano chiamato spin_barrier_wait.
+// Restituisce SPIN_BARRIER_SERIAL_THREAD a un solo thread (l'ultimo arrivato),
+// 0 agli altri, un codice errno positivo se il futex fallisce.
+int spin_barrier_wait(SpinBarrier *b);
+
+#endif // SPINBARRIER_H
@@ -0,0 +1,74 @@
+#ifndef STEAL_H
+#define STEAL_H
+
+#include <stdatomic.h> // Per atomic_long, atomic_uint, atomic_int
+
+#include "common.h" // Per Partition_Index_Task
+
+// --- Work Stealing della Fase di Sorting (-s qsort) ---
+// Ogni worker ha un deque di task (intervalli [start, end] da ordinare): il
+// proprietario inserisce e preleva in fondo (l'ultimo task diviso, ancora in
+// cache), un worker senza lavoro ruba dalla cima di un altro deque (il task
+// più vecchio, cioè il più grande). Un task più grande di 'grain' viene diviso
+// con partition_int e la metà più grande torna nel deque, quindi una
+// partizione lenta (o un core lento) viene smaltita anche dagli altri worker.
+
+#define STEAL_TASKS_PER_WORKER 16   // Sovra-decomposizione: task per worker a cui puntare
+#define STEAL_MIN_GRAIN 4096        // Sotto questa dimensione un task non viene più diviso
+#define STEAL_SPINS 256             // Giri sulle vittime con attesa attiva prima di bloccarsi sul futex
+
+// WorkDeque: Deque di task di un worker, protetto da un mutex.
+// I task validi sono tasks[top..bottom); top avanza con i furti. 'size'
+// (bottom - top) è letto senza mutex dai ladri, che prendono il lock solo se
+// c'è qualcosa da rubare.
+// Allineato alla linea di cache: i deque di worker adiacenti non condividono linee.
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) Partition_Index_Task *tasks;
+    long top;             // Indice del prossimo task da rubare
+    long bottom;          // Indice dopo l'ultimo task del proprietario
+    long capacity;        // Elementi allocati in tasks
+    atomic_long size;     // bottom - top, aggiornato sotto mutex
+    pthread_mutex_t mutex;
+} WorkDeque;
+
+// WorkStealer: Deque dei P worker e conteggio del lavoro non ancora finito.
+// Un worker senza nulla da rubare riprova per spin_limit giri, poi si blocca
+// sul futex 'epoch': steal_push lo sveglia quando inserisce un task, l'ultimo
+// steal_done quando la fase è finita (stesso schema di EventCount in queue.h).
+typedef struct WorkStealer {
+    WorkDeque *deques;    // Un deque per worker
+    int n_workers;        // P
+    long grain;           // Dimensione massima di un task non diviso
+    int spin_limit;       // Giri prima del futex (0 con una sola CPU)
+    // Aggiornati da tutti i worker: su una linea propria, lontano dai campi in sola lettura.
+    // sleepers ed epoch stanno con pending, che chi li legge ha appena scritto.
+    _Alignas(CACHE_LINE_SIZE) atomic_long pending; // Task inseriti e non ancora completati (0: fase finita)
+    atomic_int sleepers;  // Worker bloccati (o in procinto di bloccarsi) sul futex
+    atomic_uint epoch;    // Parola del futex: incrementata a ogni risveglio
+} WorkStealer;
+
+// Alloca i P deque. Restituisce 0 in caso di successo, -1 in caso di errore.
+int steal_init(WorkStealer *ws, int P);
+
+// Libera i deque. Nessun worker deve usarli.
+void steal_destroy(WorkStealer *ws);
+
+// Prepara un ordinamento di N elementi: il deque del worker i contiene solo
+// la partizione i ([partition_start(i), partition_start(i+1))) e grain è
+// scelto per avere circa STEAL_TASKS_PER_WORKER task per worker.
+// Va chiamata quando nessun worker usa i deque.
+void steal_reset(WorkStealer *ws, long N);
+
+// Inserisce un nuovo task in fondo al deque del worker 'tid' (solo il proprietario).
+void steal_push(WorkStealer *ws, int tid, Partition_Index_Task task);
+
+// Preleva il prossimo task del worker 'tid': dal fondo del proprio deque,
+// altrimenti dalla cima di quello di un altro worker. Se non c'è nulla da
+// rubare attende che qualcuno divida un task (attesa attiva breve, poi futex). Restituisce 1 con il task in
+// 'task' (in 'victim' il worker derubato, o tid), 0 quando tutti i task sono completati.
+int steal_next(WorkStealer *ws, int tid, Partition_Index_Task *task, int *victim);
+
+// Segnala il completamento di un task prelevato con steal_next.
+void steal_done(WorkStealer *ws);
+
+#endif // STEAL_H
@@ -0,0 +1,89 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h> // Per int64_t
+
+#include "common.h" // Per le macro di errore
+#include "spinbarrier.h" // Per SpinBarrier
+
+// --- Misura per Worker e per Fase (opzione --stats) ---
+// Ogni worker registra nel proprio WorkerTrace l'inizio e la fine di ogni fase
+// (con il passo di merge k, dove ha senso) e, se perf_event_open è disponibile,
+// i contatori hardware del proprio thread negli stessi istanti. Le attese sulle
+// barriere sono fasi a sé (TRACE_BARRIER), così lo sbilanciamento di un passo
+// si legge come tempo di attesa degli altri worker.
+
+// TracePhase: Fase misurata.
+typedef enum {
+    TRACE_PARTITION = 0, // Calcolo e accodamento delle partizioni, splitter, istogrammi
+    TRACE_SORT,          // Ordinamento delle partizioni (o passi del radix sort)
+    TRACE_MERGE,         // Passo di merge k
+    TRACE_COPY,          // Copia di ritorno (per passo in -m serial, finale altrimenti)
+    TRACE_BARRIER,       // Attesa su una barriera
+    TRACE_PHASE_COUNT    // Numero di fasi (non è una fase valida)
+} TracePhase;
+
+// Contatori hardware letti con perf_event_open (-1 se non disponibile).
+typedef enum {
+    TRACE_CYCLES = 0,
+    TRACE_INSTRUCTIONS,
+    TRACE_CACHE_MISSES,
+    TRACE_BRANCH_MISSES,
+    TRACE_COUNTER_COUNT
+} TraceCounter;
+
+#define TRACE_MAX_EVENTS 256 // Eventi registrati per worker e per ordinamento (gli altri sono scartati)
+
+// TraceEvent: Una fase eseguita da un worker.
+typedef struct {
+    TracePhase phase;
+    int step;                              // Passo di merge o di radix (-1 se non applicabile)
+    double start_ms;                       // Inizio, in ms dall'avvio dell'ordinamento
+    double end_ms;                         // Fine, in ms dall'avvio dell'ordinamento
+    int64_t counters[TRACE_COUNTER_COUNT]; // Differenza dei contatori nella fase (-1 se non disponibile)
+} TraceEvent;
+
+// WorkerTrace: Eventi di un worker; usato solo dal thread del worker durante l'ordinamento.
+// Allineata alla linea di cache, come gli altri dati per worker.
+typedef struct WorkerTrace {
+    _Alignas(CACHE_LINE_SIZE) double t0_ms; // Istante di avvio dell'ordinamento (get_time_ms)
+    int count;              // Eventi registrati
+    int dropped;            // Eventi scartati perché events era pieno
+    int open;               // 1 se c'è un evento iniziato e non ancora chiuso
+    int perf_state;         // 0: non ancora aperto, 1: aperto, -1: non disponibile
+    int perf_fds[TRACE_COUNTER_COUNT];  // Descrittori perf (-1 se assenti); cycles è il leader del gruppo
+    int perf_slot[TRACE_COUNTER_COUNT]; // Posizione del contatore nel gruppo (-1 se assente)
+    int64_t start_counters[TRACE_COUNTER_COUNT];
+    TraceEvent events[TRACE_MAX_EVENTS];
+} WorkerTrace;
+
+// Azzera gli eventi di 't' per un nuovo ordinamento che inizia all'istante t0_ms.
+void trace_reset(WorkerTrace *t, double t0_ms);
+
+// Inizia la fase 'phase' (passo 'step') del worker; chiude l'eventuale fase aperta.
+// Con t == NULL non fa nulla, così i worker non controllano se la misura è attiva.
+void trace_begin(WorkerTrace *t, TracePhase phase, int step);
+
+// Chiude la fase aperta (se c'è). Con t == NULL non fa nulla.
+void trace_end(WorkerTrace *t);
+
+// spin_barrier_wait misurata come fase TRACE_BARRIER del passo 'step';
+// termina il programma con 'message' in caso di errore. Restituisce 1 al
+// thread seriale della barriera (SPIN_BARRIER_SERIAL_THREAD), 0 agli altri.
+int trace_barrier_wait(WorkerTrace *t, SpinBarrier *barrier, int step, const char *message);
+
+// Chiude i descrittori perf di 't' (da chiamare quando il worker non lo usa più).
+void trace_close(WorkerTrace *t);
+
+// Nome della fase, usato in CSV e JSON.
+const char *trace_phase_name(TracePhase phase);
+
+// Scrive gli eventi dei P worker in CSV (una riga per evento, con intestazione).
+void trace_write_csv(FILE *out, const WorkerTrace *traces, int P);
+
+// Scrive gli eventi dei P worker in JSON, con un riepilogo per (fase, passo):
+// durata minima, massima e media tra i worker e sbilanciamento max/media.
+// 'label' identifica l'esecuzione (es. "N=... P=...") ed è scritto così com'è.
+void trace_write_json(FILE *out, const WorkerTrace *traces, int P, const char *label);
+
+#endif // TRACE_H
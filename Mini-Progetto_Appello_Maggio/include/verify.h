@@ -0,0 +1,29 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdint.h> // Per uint64_t
+
+#include "psort.h" // Per psort_context, psort_parallel_for
+
+// --- Verifica Parallela dell'Ordinamento (int) ---
+// Entrambi i controlli sono cicli psort_parallel_for sul pool del contesto:
+// ogni thread legge solo la propria fetta di N/P elementi. Non allocano memoria,
+// quindi non possono fallire.
+
+// Indice del primo i con data[i] > data[i+1], oppure -1 se data[0..n) è ordinato.
+// Ogni thread controlla le coppie della sua fetta, compresa quella a cavallo
+// con la fetta successiva.
+long verify_sorted_int(psort_context *ctx, const int *data, long n);
+
+// Checksum di data[0..n) come multinsieme: somma (mod 2^64) di un mix di
+// splitmix64 di ogni valore, quindi non dipende dall'ordine degli elementi.
+// Input e output di un ordinamento corretto hanno lo stesso checksum; un
+// elemento perso, duplicato o alterato lo cambia con probabilità ~1 - 2^-64.
+uint64_t verify_checksum_int(psort_context *ctx, const int *data, long n);
+
+// Lo stesso checksum calcolato dal thread chiamante, senza pool: la somma è
+// additiva, quindi i checksum di blocchi consecutivi si sommano (letture a
+// blocchi dell'ordinamento esterno).
+uint64_t checksum_int_block(const int *data, long n);
+
+#endif // VERIFY_H
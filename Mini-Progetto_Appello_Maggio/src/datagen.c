@@ -0,0 +1,107 @@
+/**
+ * @file datagen.c
+ * @brief Generatori di input per parallel_sort basati su contatore (vedi datagen.h).
+ *
+ * Ogni valore è funzione pura di (seed, i, n): datagen_fill può essere
+ * chiamata su fette disgiunte da thread diversi senza sincronizzazione, e il
+ * risultato non dipende da come l'array è stato diviso.
+ * I valori stanno in [0, range) con range = min(10*N, INT_MAX), come nello
+ * schema originale rand() % (N*10).
+ */
+
+#include <limits.h> // Per INT_MAX
+
+#include "datagen.h"
+
+const char *const distribution_names[DIST_COUNT] = {
+    "uniform", "sorted", "reverse", "nearly-sorted", "few-unique", "zipf", "organ-pipe"
+};
+
+/**
+ * @brief Distribuzione con il nome dato (vedi datagen.h).
+ */
+Distribution distribution_by_name(const char *name) {
+    for (int i = 0; i < DIST_COUNT; ++i) {
+        if (strcmp(name, distribution_names[i]) == 0) return (Distribution)i;
+    }
+    return DIST_COUNT;
+}
+
+/**
+ * @brief Mix di splitmix64 sul contatore (vedi datagen.h).
+ */
+uint64_t datagen_mix(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed + counter * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Valore crescente in [0, range) per la posizione 'pos' di n (pos * range / n).
+ */
+static int ramp(long pos, long n, long range) {
+    return (int)((unsigned __int128)pos * (unsigned long)range / (unsigned long)n);
+}
+
+/**
+ * @brief Rango Zipf approssimato in [0, range) senza libm.
+ *
+ * Con esponente 1 ogni ottava [2^b, 2^(b+1)) di ranghi ha circa la stessa
+ * probabilità totale (sum 1/k ~ ln 2 per ottava): si sceglie un'ottava
+ * uniforme e poi un rango uniforme al suo interno.
+ */
+static int zipf_value(uint64_t r, long range) {
+    int octaves = 0;
+    while ((2L << octaves) <= range) octaves++; // 2^octaves <= range < 2^(octaves+1)
+    int b = (int)((r & 0xFFFFFFFFu) % (uint64_t)(octaves + 1));
+    long base = 1L << b;
+    long width = (base * 2 <= range) ? base : range - base + 1; // Ultima ottava troncata a range
+    return (int)(base - 1 + (long)((r >> 32) % (uint64_t)width));
+}
+
+/**
+ * @brief Genera la fetta [lo, hi) dell'array (vedi datagen.h).
+ */
+void datagen_fill(int *data, long lo, long hi, long n, Distribution dist, uint64_t seed) {
+    long range = (n <= INT_MAX / 10) ? n * 10 : INT_MAX;
+    for (long i = lo; i < hi; ++i) {
+        uint64_t r = datagen_mix(seed, (uint64_t)i);
+        int value;
+        switch (dist) {
+            case DIST_SORTED:
+                value = ramp(i, n, range);
+                break;
+            case DIST_REVERSE:
+                value = ramp(n - 1 - i, n, range);
+                break;
+            case DIST_NEARLY_SORTED: {
+                // Un elemento su 100 prende il valore di una posizione distante al più 8
+                long pos = i;
+                if (r % 100 == 0) {
+                    pos += (long)((r >> 32) % 17) - 8;
+                    if (pos < 0) pos = 0;
+                    if (pos >= n) pos = n - 1;
+                }
+                value = ramp(pos, n, range);
+                break;
+            }
+            case DIST_FEW_UNIQUE:
+                value = (int)((r % DATAGEN_FEW_UNIQUE) * (range / DATAGEN_FEW_UNIQUE));
+                break;
+            case DIST_ZIPF:
+                value = zipf_value(r, range);
+                break;
+            case DIST_ORGAN_PIPE: {
+                long half = (n + 1) / 2;
+                value = ramp((i < half) ? i : n - 1 - i, half, range);
+                break;
+            }
+            case DIST_UNIFORM:
+            default:
+                value = (int)(r % (uint64_t)range);
+                break;
+        }
+        data[i] = value;
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file eventlog.c
+ * @brief Registro eventi per worker senza lock (vedi eventlog.h).
+ *
+ * Ogni EventRing ha un solo scrittore, il thread del worker, e viene letto
+ * solo dopo che l'ordinamento è terminato: la sincronizzazione tra scrittura
+ * e lettura è quella del pool (psort_sort_int ritorna dopo che tutti i worker
+ * hanno segnalato la fine sotto il pool_mutex), quindi nessun atomico serve.
+ */
+
+#include "eventlog.h"
+#include "myutils.h" // Contiene get_time_ms
+
+/**
+ * @brief Svuota il registro (vedi eventlog.h).
+ */
+void eventlog_reset(EventRing *ring, double t0_ms) {
+    ring->t0_ms = t0_ms;
+    ring->written = 0;
+}
+
+/**
+ * @brief Registra un evento nel buffer circolare (vedi eventlog.h).
+ */
+void eventlog_record(EventRing *ring, EventKind kind, int step, long a, long b, long c, long d) {
+    if (ring == NULL) return;
+    EventRecord *rec = &ring->records[ring->written % EVENTLOG_CAPACITY];
+    rec->t_ms = get_time_ms() - ring->t0_ms;
+    rec->kind = kind;
+    rec->step = step;
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    rec->d = d;
+    ring->written++;
+}
+
+/**
+ * @brief Stampa un evento del worker 'tid' nello stesso formato dei vecchi printf.
+ */
+static void print_event(FILE *out, int tid, const EventRecord *rec) {
+    fprintf(out, "[%10.3f ms] ", rec->t_ms);
+    switch (rec->kind) {
+        case EVENT_WORKER_START:
+            fprintf(out, "[WORKER STATUS] Worker %d AVVIATO.\n", tid);
+            break;
+        case EVENT_WORKER_END:
+            fprintf(out, "[WORKER STATUS] Worker %d TERMINATO.\n", tid);
+            break;
+        case EVENT_TASK_PUSH:
+            fprintf(out, "[INDICI SORTING] Worker %d: Accodato Task per sort_int: start=%ld, end=%ld (elementi: %ld)\n",
+                    tid, rec->a, rec->b, rec->b - rec->a + 1);
+            break;
+        case EVENT_TASK_POP:
+            fprintf(out, "[INDICI SORTING] Worker %d: Prelevato Task per sort_int: start=%ld, end=%ld (elementi: %ld)\n",
+                    tid, rec->a, rec->b, rec->b - rec->a + 1);
+            break;
+        case EVENT_TASK_STEAL:
+            fprintf(out, "[INDICI SORTING] Worker %d: Rubato al Worker %ld Task per sort_int: start=%ld, end=%ld (elementi: %ld)\n",
+                    tid, rec->c, rec->a, rec->b, rec->b - rec->a + 1);
+            break;
+        case EVENT_MERGE_PLAN:
+            fprintf(out, "[INDICI MERGING] Worker %d (Attivo): Passo k=%d, Unirà Blocco1 [%ld-%ld] con Blocco2 [%ld-%ld]\n",
+                    tid, rec->step, rec->a, rec->b, rec->c, rec->d);
+            break;
+        default:
+            fprintf(out, "[EVENTO %d] Worker %d\n", (int)rec->kind, tid);
+            break;
+    }
+}
+
+/**
+ * @brief Stampa gli eventi di tutti i worker in ordine di tempo (vedi eventlog.h).
+ *
+ * Gli eventi di ogni worker sono già in ordine di tempo: si uniscono i P
+ * registri scegliendo ad ogni passo il più vecchio evento non ancora stampato.
+ */
+void eventlog_dump(FILE *out, const EventRing *rings, int P) {
+    uint64_t *next = malloc(P * sizeof(uint64_t));
+    CHECK_ERR(next == NULL, "eventlog_dump: Errore allocazione");
+    for (int w = 0; w < P; ++w) {
+        // Se il buffer ha girato, il più vecchio evento conservato è written - CAPACITY
+        next[w] = (rings[w].written > EVENTLOG_CAPACITY) ? rings[w].written - EVENTLOG_CAPACITY : 0;
+        if (next[w] > 0) {
+            fprintf(out, "[EVENTI] Worker %d: %llu eventi più vecchi sovrascritti.\n", w, (unsigned long long)next[w]);
+        }
+    }
+    for (;;) {
+        int best = -1;
+        for (int w = 0; w < P; ++w) {
+            if (next[w] == rings[w].written) continue;
+            const EventRecord *rec = &rings[w].records[next[w] % EVENTLOG_CAPACITY];
+            if (best < 0 || rec->t_ms < rings[best].records[next[best] % EVENTLOG_CAPACITY].t_ms) best = w;
+        }
+        if (best < 0) break;
+        print_event(out, best, &rings[best].records[next[best] % EVENTLOG_CAPACITY]);
+        next[best]++;
+    }
+    free(next);
+}
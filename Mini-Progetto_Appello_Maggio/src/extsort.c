@@ -0,0 +1,448 @@
+/**
+ * @file extsort.c
+ * @brief Ordinamento esterno di file binari di int più grandi della memoria.
+ *
+ * Fase 1 (generazione dei run): il file è letto a blocchi di 'chunk' int con
+ * due buffer alternati. Mentre il pool di un psort_context ordina il blocco r,
+ * un thread di I/O scrive il run r-1 (write-behind) e legge il blocco r+1
+ * (read-ahead) nell'altro buffer, così il disco lavora durante l'ordinamento.
+ * I run sono scritti uno dopo l'altro nel file temporaneo "<output>.runs"
+ * (oppure direttamente nell'output, se l'input sta in un solo blocco).
+ * Fase 2 (merge P-way): il file dei run è mappato con mmap in sola lettura
+ * (MADV_SEQUENTIAL) e l'output è prodotto a blocchi di 'chunk' int. Ogni blocco
+ * è diviso in P fette con psort_parallel_for sullo stesso pool della Fase 1:
+ * ogni thread trova i propri estremi nei run con kway_split e unisce i sotto-run
+ * con il loser tree (kway_merge), usando i propri array di splitter allocati
+ * una sola volta per tutto il merge. Il blocco precedente viene
+ * scritto da un thread di scrittura mentre si unisce il successivo, e le pagine
+ * dei run che serviranno al blocco dopo ancora sono richieste con MADV_WILLNEED.
+ *
+ * L'output è scritto nel file temporaneo "<output>.tmp" e rinominato in
+ * "<output>" solo a ordinamento riuscito: un errore non lascia mai un output
+ * troncato o parziale, e un output esistente resta intatto fino alla fine.
+ */
+
+#include <stdio.h>    // Per rename
+#include <stdlib.h>   // Per malloc, free
+#include <string.h>   // Per strlen, memcpy
+#include <unistd.h>   // Per pread, pwrite, close, unlink, sysconf
+#include <fcntl.h>    // Per open
+#include <sys/mman.h> // Per mmap, madvise
+#include <sys/stat.h> // Per fstat
+
+#include "extsort.h" // Contiene ExtSortStats e la dichiarazione
+#include "psort.h"   // Contiene psort_context per ordinare i blocchi
+#include "myutils.h" // Contiene kway_split, kway_merge, get_time_ms
+#include "verify.h"  // Contiene checksum_int_block
+
+#define EXTSORT_MIN_CHUNK 1024L // Dimensione minima di un blocco (in int)
+
+// IoJob: Lavoro del thread di I/O durante l'ordinamento di un blocco (Fase 1)
+// o l'unione di un blocco (Fase 2): prima la scrittura, poi la lettura.
+typedef struct {
+    int out_fd;           // File su cui scrivere 'write_buf'
+    const int *write_buf; // Run (o blocco di output) da scrivere
+    long write_n;         // Elementi da scrivere (0: nessuna scrittura)
+    off_t write_off;      // Offset in byte della scrittura
+    int in_fd;            // File da cui leggere 'read_buf'
+    int *read_buf;        // Buffer del prossimo blocco da ordinare
+    long read_n;          // Elementi da leggere (0: nessuna lettura)
+    off_t read_off;       // Offset in byte della lettura
+    uint64_t read_sum;    // Output: checksum degli elementi letti (checksum_int_block)
+    int saved_errno;      // Output: errno della prima operazione fallita (0 se nessuna)
+} IoJob;
+
+// MergeBlockJob: Blocco [base, base + n) dell'output del merge P-way, diviso
+// tra i thread del pool da psort_parallel_for.
+// Il thread i usa le righe i (da k elementi) degli array di splitter.
+typedef struct {
+    const int *const *runs; // Run ordinati (nel file mappato)
+    const long *lens;       // Lunghezza di ogni run
+    int k;                  // Numero di run
+    long base;              // Rango globale del primo elemento del blocco
+    int *out;               // Destinazione del primo elemento del blocco
+    const int **sub_runs;   // P * k: inizio del sotto-run di ogni run nella fetta
+    long *sub_lens;         // P * k: lunghezza dei sotto-run
+    long *pos_lo;           // P * k: splitter all'inizio della fetta
+    long *pos_hi;           // P * k: splitter alla fine della fetta
+} MergeBlockJob;
+
+/**
+ * @brief pread fino a 'bytes' byte, ripetendo le letture parziali.
+ * @return 0 in caso di successo, -1 con errno impostato (EIO se il file è più corto).
+ */
+static int read_full(int fd, void *buf, size_t bytes, off_t offset) {
+    char *p = buf;
+    while (bytes > 0) {
+        ssize_t r = pread(fd, p, bytes, offset);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) {
+            errno = EIO;
+            return -1;
+        }
+        p += r;
+        bytes -= r;
+        offset += r;
+    }
+    return 0;
+}
+
+/**
+ * @brief pwrite di 'bytes' byte, ripetendo le scritture parziali.
+ * @return 0 in caso di successo, -1 con errno impostato.
+ */
+static int write_full(int fd, const void *buf, size_t bytes, off_t offset) {
+    const char *p = buf;
+    while (bytes > 0) {
+        ssize_t w = pwrite(fd, p, bytes, offset);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        bytes -= w;
+        offset += w;
+    }
+    return 0;
+}
+
+/**
+ * @brief Corpo del thread di I/O: scrive write_buf, poi legge read_buf e ne calcola il checksum.
+ */
+static void *io_thread(void *args) {
+    IoJob *job = (IoJob *)args;
+    job->saved_errno = 0;
+    if (job->write_n > 0 &&
+        write_full(job->out_fd, job->write_buf, job->write_n * sizeof(int), job->write_off) != 0) {
+        job->saved_errno = errno;
+        return NULL;
+    }
+    if (job->read_n > 0) {
+        if (read_full(job->in_fd, job->read_buf, job->read_n * sizeof(int), job->read_off) != 0) {
+            job->saved_errno = errno;
+            return NULL;
+        }
+        job->read_sum = checksum_int_block(job->read_buf, job->read_n);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Fetta [lo, hi) del blocco per il thread 'index': calcola gli splitter e la unisce.
+ */
+static void merge_slice(void *args, int index, long lo, long hi) {
+    MergeBlockJob *job = (MergeBlockJob *)args;
+    int k = job->k;
+    if (hi == lo) return;
+
+    const int **sub_runs = job->sub_runs + (long)index * k;
+    long *sub_lens = job->sub_lens + (long)index * k;
+    long *pos_lo = job->pos_lo + (long)index * k;
+    long *pos_hi = job->pos_hi + (long)index * k;
+    kway_split(job->runs, job->lens, k, job->base + lo, pos_lo);
+    kway_split(job->runs, job->lens, k, job->base + hi, pos_hi);
+    for (int r = 0; r < k; ++r) {
+        sub_runs[r] = job->runs[r] + pos_lo[r];
+        sub_lens[r] = pos_hi[r] - pos_lo[r];
+    }
+    kway_merge(sub_runs, sub_lens, k, job->out + lo);
+}
+
+/**
+ * @brief Richiede in anticipo (MADV_WILLNEED) le pagine runs[r][from[r]..to[r]) di ogni run.
+ */
+static void prefetch_runs(const int *const *runs, const long *from, const long *to, int k) {
+    long page = sysconf(_SC_PAGESIZE);
+    for (int r = 0; r < k; ++r) {
+        if (to[r] <= from[r]) continue;
+        uintptr_t lo = (uintptr_t)(runs[r] + from[r]) & ~(uintptr_t)(page - 1);
+        uintptr_t hi = (uintptr_t)(runs[r] + to[r]);
+        madvise((void *)lo, hi - lo, MADV_WILLNEED); // Solo un suggerimento: l'errore è ignorato
+    }
+}
+
+/**
+ * @brief Libera gli array di merge_runs (anche se solo in parte allocati).
+ */
+static void free_merge_arrays(MergeBlockJob *job, const int **runs, long *lens, long *pos_cur, long *pos_next) {
+    free(job->pos_hi);
+    free(job->pos_lo);
+    free(job->sub_lens);
+    free(job->sub_runs);
+    free(pos_next);
+    free(pos_cur);
+    free(lens);
+    free(runs);
+}
+
+/**
+ * @brief Fase 2: unisce i k run del file 'runs_fd' scrivendo N int in 'out_fd'.
+ *
+ * Ogni blocco è unito dal pool di 'ctx'. Usa buf[0] e buf[1] (da 'block' int
+ * ciascuno) come doppio buffer di output.
+ * @return 0 in caso di successo, -1 in caso di errore (messaggio stampato).
+ */
+static int merge_runs(psort_context *ctx, int runs_fd, int out_fd, long N, long chunk, int k,
+                      int *buf[2], long block) {
+    size_t map_bytes = N * sizeof(int);
+    int *map = mmap(NULL, map_bytes, PROT_READ, MAP_SHARED, runs_fd, 0);
+    if (map == MAP_FAILED) {
+        perror("external_sort_file: Errore mmap del file dei run");
+        return -1;
+    }
+    madvise(map, map_bytes, MADV_SEQUENTIAL);
+
+    long P = psort_n_threads(ctx);
+    const int **runs = malloc(k * sizeof(int *));
+    long *lens = malloc(k * sizeof(long));
+    long *pos_cur = malloc(k * sizeof(long));  // Splitter alla fine del blocco corrente
+    long *pos_next = malloc(k * sizeof(long)); // Splitter alla fine del blocco successivo
+    MergeBlockJob job;
+    job.sub_runs = malloc(P * k * sizeof(int *));
+    job.sub_lens = malloc(P * k * sizeof(long));
+    job.pos_lo = malloc(P * k * sizeof(long));
+    job.pos_hi = malloc(P * k * sizeof(long));
+    if (runs == NULL || lens == NULL || pos_cur == NULL || pos_next == NULL ||
+        job.sub_runs == NULL || job.sub_lens == NULL || job.pos_lo == NULL || job.pos_hi == NULL) {
+        fprintf(stderr, "external_sort_file: Errore allocazione merge\n");
+        free_merge_arrays(&job, runs, lens, pos_cur, pos_next);
+        munmap(map, map_bytes);
+        return -1;
+    }
+    job.runs = runs;
+    job.lens = lens;
+    job.k = k;
+    for (int r = 0; r < k; ++r) {
+        runs[r] = map + (long)r * chunk;
+        lens[r] = (N - (long)r * chunk < chunk) ? N - (long)r * chunk : chunk;
+    }
+
+    int ret = 0;
+    IoJob writer = { 0 };
+    pthread_t writer_thread;
+    int writer_running = 0;
+    long n_blocks = (N + block - 1) / block;
+    kway_split(runs, lens, k, (block < N) ? block : N, pos_cur);
+    for (int r = 0; r < k; ++r) pos_next[r] = 0;
+    prefetch_runs(runs, pos_next, pos_cur, k);
+
+    for (long b = 0; b < n_blocks && ret == 0; ++b) {
+        long lo = b * block;
+        long hi = (lo + block < N) ? lo + block : N;
+        int *out = buf[b % 2];
+
+        // Read-ahead: le pagine del blocco b+1 arrivano mentre si unisce il blocco b
+        if (b + 1 < n_blocks) {
+            long next_hi = (hi + block < N) ? hi + block : N;
+            kway_split(runs, lens, k, next_hi, pos_next);
+            prefetch_runs(runs, pos_cur, pos_next, k);
+            long *swap_tmp = pos_cur;
+            pos_cur = pos_next;
+            pos_next = swap_tmp;
+        }
+
+        job.base = lo;
+        job.out = out;
+        psort_parallel_for(ctx, hi - lo, merge_slice, &job);
+
+        // Write-behind: il blocco b viene scritto mentre si unisce il blocco b+1
+        if (writer_running) {
+            pthread_join(writer_thread, NULL);
+            writer_running = 0;
+            if (writer.saved_errno != 0) {
+                errno = writer.saved_errno;
+                perror("external_sort_file: Errore scrittura output");
+                ret = -1;
+                break;
+            }
+        }
+        writer.out_fd = out_fd;
+        writer.write_buf = out;
+        writer.write_n = hi - lo;
+        writer.write_off = (off_t)lo * sizeof(int);
+        writer.read_n = 0;
+        int err = pthread_create(&writer_thread, NULL, io_thread, &writer);
+        CHECK_PTHREAD_ERR(err, "external_sort_file: Errore creazione thread di scrittura");
+        writer_running = 1;
+    }
+    if (writer_running) {
+        pthread_join(writer_thread, NULL);
+        if (writer.saved_errno != 0) {
+            errno = writer.saved_errno;
+            perror("external_sort_file: Errore scrittura output");
+            ret = -1;
+        }
+    }
+
+    free_merge_arrays(&job, runs, lens, pos_cur, pos_next);
+    munmap(map, map_bytes);
+    return ret;
+}
+
+/**
+ * @brief Ordinamento esterno (vedi extsort.h e la descrizione del file).
+ */
+int external_sort_file(const char *input_path, const char *output_path, int n_threads,
+                       SortMode sort_mode, MergeMode merge_mode, long mem_bytes,
+                       ExtSortStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    int in_fd = open(input_path, O_RDONLY);
+    if (in_fd < 0) {
+        perror("external_sort_file: Errore apertura input");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(in_fd, &st) != 0 || st.st_size % sizeof(int) != 0) {
+        fprintf(stderr, "external_sort_file: '%s' non è un file di int (dimensione non multipla di %zu).\n",
+                input_path, sizeof(int));
+        close(in_fd);
+        return -1;
+    }
+    // Input e output coincidenti (anche tramite link): l'output sostituirebbe l'input
+    struct stat out_st;
+    if (stat(output_path, &out_st) == 0 && out_st.st_dev == st.st_dev && out_st.st_ino == st.st_ino) {
+        fprintf(stderr, "external_sort_file: '%s' e '%s' sono lo stesso file.\n", input_path, output_path);
+        close(in_fd);
+        return -1;
+    }
+    char *tmp_path = malloc(strlen(output_path) + sizeof(".tmp"));
+    CHECK_ERR(tmp_path == NULL, "external_sort_file: Errore allocazione percorso");
+    strcpy(tmp_path, output_path);
+    strcat(tmp_path, ".tmp");
+    int out_fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        perror("external_sort_file: Errore apertura output");
+        free(tmp_path);
+        close(in_fd);
+        return -1;
+    }
+
+    long N = st.st_size / sizeof(int);
+    // Tre buffer da 'chunk' int: due alternati per ordinamento e I/O, uno temporaneo per il merge
+    long chunk = mem_bytes / (3 * (long)sizeof(int));
+    if (chunk < EXTSORT_MIN_CHUNK) chunk = EXTSORT_MIN_CHUNK;
+    if (chunk > N) chunk = (N > 0) ? N : 1;
+    int n_runs = (int)((N + chunk - 1) / chunk);
+    stats->elements = N;
+    stats->runs = n_runs;
+
+    int *buf[2];
+    buf[0] = malloc(chunk * sizeof(int));
+    buf[1] = malloc(chunk * sizeof(int));
+    int *scratch = malloc(chunk * sizeof(int));
+    CHECK_ERR(buf[0] == NULL || buf[1] == NULL || scratch == NULL,
+              "external_sort_file: Errore allocazione buffer");
+
+    // Con più run serve il file temporaneo; con uno solo il run è già l'output
+    char *runs_path = malloc(strlen(output_path) + sizeof(".runs"));
+    CHECK_ERR(runs_path == NULL, "external_sort_file: Errore allocazione percorso");
+    strcpy(runs_path, output_path);
+    strcat(runs_path, ".runs");
+    int runs_fd = out_fd;
+    if (n_runs > 1) {
+        runs_fd = open(runs_path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (runs_fd < 0) {
+            perror("external_sort_file: Errore creazione file dei run");
+            free(runs_path);
+            free(scratch);
+            free(buf[1]);
+            free(buf[0]);
+            close(out_fd);
+            unlink(tmp_path);
+            free(tmp_path);
+            close(in_fd);
+            return -1;
+        }
+    }
+
+    int ret = 0;
+    double t0 = get_time_ms();
+    // Un solo pool per entrambe le fasi: ordina i blocchi, poi unisce i run
+    psort_context *ctx = NULL;
+    if (n_runs > 0) {
+        ctx = psort_create(n_threads, sort_mode, merge_mode);
+        if (ctx == NULL) {
+            fprintf(stderr, "external_sort_file: Errore creazione contesto di ordinamento\n");
+            ret = -1;
+        }
+    }
+    // --- Fase 1: generazione dei run ---
+    if (ctx != NULL) {
+
+        // Il primo blocco è letto in modo sincrono, i successivi dal thread di I/O
+        IoJob job = { 0 };
+        job.in_fd = in_fd;
+        job.read_buf = buf[0];
+        job.read_n = (chunk < N) ? chunk : N;
+        io_thread(&job);
+        for (int r = 0; r < n_runs && job.saved_errno == 0; ++r) {
+            stats->checksum += job.read_sum;
+            long run_n = (N - (long)r * chunk < chunk) ? N - (long)r * chunk : chunk;
+            int *cur = buf[r % 2];
+            int *other = buf[(r + 1) % 2];
+
+            // Mentre il pool ordina 'cur': scrive il run r-1 da 'other', poi vi legge il blocco r+1
+            job.out_fd = runs_fd;
+            job.write_buf = other;
+            job.write_n = (r > 0) ? chunk : 0; // Tutti i run tranne l'ultimo sono pieni
+            job.write_off = (off_t)(r - 1) * chunk * sizeof(int);
+            job.in_fd = in_fd;
+            job.read_buf = other;
+            job.read_off = (off_t)(r + 1) * chunk * sizeof(int);
+            job.read_n = (r + 1 < n_runs) ? ((N - (long)(r + 1) * chunk < chunk) ? N - (long)(r + 1) * chunk : chunk) : 0;
+            job.read_sum = 0;
+            pthread_t io;
+            int err = pthread_create(&io, NULL, io_thread, &job);
+            CHECK_PTHREAD_ERR(err, "external_sort_file: Errore creazione thread di I/O");
+
+            // 'scratch' è fornito: psort_sort_int non alloca e non può fallire
+            psort_sort_int(ctx, cur, run_n, scratch);
+            pthread_join(io, NULL);
+
+            if (r == n_runs - 1 && job.saved_errno == 0 &&
+                write_full(runs_fd, cur, run_n * sizeof(int), (off_t)r * chunk * sizeof(int)) != 0) {
+                job.saved_errno = errno;
+            }
+            DEBUG_PRINT_GEN("Run %d/%d ordinato (%ld elementi).", r + 1, n_runs, run_n);
+        }
+        if (job.saved_errno != 0) {
+            errno = job.saved_errno;
+            perror("external_sort_file: Errore di I/O durante la generazione dei run");
+            ret = -1;
+        }
+    }
+    free(scratch);
+    stats->run_time_ms = get_time_ms() - t0;
+
+    // --- Fase 2: merge P-way dei run ---
+    if (ret == 0 && n_runs > 1) {
+        t0 = get_time_ms();
+        ret = merge_runs(ctx, runs_fd, out_fd, N, chunk, n_runs, buf, chunk);
+        stats->merge_time_ms = get_time_ms() - t0;
+    }
+    if (ctx != NULL) psort_destroy(ctx);
+
+    if (runs_fd != out_fd) {
+        close(runs_fd);
+        unlink(runs_path);
+    }
+    free(runs_path);
+    free(buf[1]);
+    free(buf[0]);
+    if (close(out_fd) != 0) {
+        perror("external_sort_file: Errore chiusura output");
+        ret = -1;
+    }
+    // Solo un ordinamento riuscito sostituisce l'output
+    if (ret == 0 && rename(tmp_path, output_path) != 0) {
+        perror("external_sort_file: Errore rinomina output");
+        ret = -1;
+    }
+    if (ret != 0) unlink(tmp_path);
+    free(tmp_path);
+    close(in_fd);
+    return ret;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file intsort.c
+ * @brief Ordinamenti paralleli specializzati per chiavi intere (radix LSD e sample sort).
+ *
+ * Entrambe le modalità usano la stessa suddivisione statica della Fase 1
+ * (partition_start): il worker tid possiede la fetta
+ * [partition_start(tid), partition_start(tid+1)) dell'array.
+ * - radix_sort_phase: 4 passi da 8 bit. In ogni passo ogni worker conta le cifre
+ * della propria fetta in una riga privata di t_args->histograms, dopo una barriera
+ * calcola i propri offset di scrittura (prefix-sum per cifra, poi per thread) e
+ * distribuisce gli elementi nel buffer destinazione. I buffer si scambiano ad ogni
+ * passo; un passo in cui tutte le chiavi hanno la stessa cifra viene saltato.
+ * - sample_sort_phase: il Worker 0 sceglie P-1 splitter da un campione regolare,
+ * ogni worker conta e distribuisce la propria fetta nei P bucket di temp_array,
+ * poi il Worker 0 accoda un task per ogni bucket non vuoto e tutti i worker li
+ * prelevano dalla coda concorrente e li ordinano con sort_int.
+ * Alla fine il risultato viene riportato in array da tutti i worker in parallelo.
+ * Con --stats ogni fase è misurata in t_args->trace (trace.h): nel radix sort
+ * l'istogramma del passo p è TRACE_PARTITION e lo scatter TRACE_SORT, entrambi con step p.
+ */
+
+#include <stdlib.h> // Per malloc, free
+#include <string.h> // Per memcpy
+#include <assert.h> // Per assert
+
+#include "intsort.h" // Contiene le dichiarazioni delle fasi
+#include "queue.h"   // Contiene ConcurrentQueue e le sue operazioni
+#include "myutils.h" // Contiene partition_start
+#include "sortkernel.h" // Contiene sort_int
+#include "trace.h"   // Contiene trace_begin, trace_barrier_wait
+
+#define RADIX_BITS 8                     // Bit per cifra
+#define RADIX_BUCKETS (1 << RADIX_BITS)  // Valori possibili di una cifra
+#define RADIX_PASSES (32 / RADIX_BITS)   // Passi per coprire un int a 32 bit
+#define SAMPLE_OVERSAMPLING 32           // Campioni per splitter nel sample sort
+
+/**
+ * @brief Cifra 'pass' della chiave, con il bit di segno invertito.
+ *
+ * Invertire il bit più significativo trasforma l'ordine degli int con segno
+ * nell'ordine degli unsigned, così il radix sort ordina anche i negativi.
+ */
+static inline unsigned radix_digit(int value, int pass) {
+    unsigned key = (unsigned)value ^ 0x80000000u;
+    return (key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+/**
+ * @brief Riporta in array la fetta del worker se il risultato è in temp_array.
+ */
+static void copy_back_slice(int *array, const int *result, long N, int P, int tid) {
+    if (result == array) return;
+    long lo = partition_start(N, P, tid);
+    long hi = partition_start(N, P, tid + 1);
+    if (hi > lo) memcpy(&array[lo], &result[lo], (hi - lo) * sizeof(int));
+}
+
+/**
+ * @brief Radix sort LSD parallelo (vedi descrizione del file).
+ * @param t_args Argomenti del worker; usa t_args->histograms (P x RADIX_BUCKETS).
+ */
+void radix_sort_phase(ThreadArgs *t_args) {
+    int tid = t_args->thread_id;
+    int P = t_args->n_threads;
+    long N = t_args->n_elements;
+    long *hist = t_args->histograms;
+    long *my_hist = &hist[(long)tid * RADIX_BUCKETS];
+    long lo = partition_start(N, P, tid);
+    long hi = partition_start(N, P, tid + 1);
+    int *src = t_args->array;
+    int *dst = t_args->temp_array;
+    WorkerTrace *tr = t_args->trace;
+
+    for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+        // 1. Istogramma locale della cifra corrente
+        trace_begin(tr, TRACE_PARTITION, pass);
+        memset(my_hist, 0, RADIX_BUCKETS * sizeof(long));
+        for (long i = lo; i < hi; ++i) {
+            my_hist[radix_digit(src[i], pass)]++;
+        }
+        trace_barrier_wait(tr, t_args->barrier, pass, "Errore in spin_barrier_wait (radix, istogrammi)");
+
+        // Se una sola cifra raccoglie tutti gli N elementi il passo non cambia l'ordine:
+        // tutti i worker leggono gli stessi istogrammi e prendono la stessa decisione.
+        int skip = 0;
+        for (int b = 0; b < RADIX_BUCKETS && !skip; ++b) {
+            long count = 0;
+            for (int t = 0; t < P; ++t) count += hist[(long)t * RADIX_BUCKETS + b];
+            if (count == N) skip = 1;
+            else if (count > 0) break;
+        }
+        if (skip) {
+            DEBUG_PRINT(tid, "[RADIX] Passo %d saltato (cifra unica).", pass);
+            // Nessuno scrive in questo passo, ma gli istogrammi vanno riletti da tutti prima del passo successivo
+            trace_barrier_wait(tr, t_args->barrier, pass, "Errore in spin_barrier_wait (radix, passo saltato)");
+            continue;
+        }
+
+        // 2. Offset di scrittura: elementi con cifra minore (tutti i thread),
+        //    poi elementi con la stessa cifra dei thread precedenti
+        trace_begin(tr, TRACE_SORT, pass);
+        long offset[RADIX_BUCKETS];
+        long base = 0;
+        for (int b = 0; b < RADIX_BUCKETS; ++b) {
+            long before_me = 0, total = 0;
+            for (int t = 0; t < P; ++t) {
+                long c = hist[(long)t * RADIX_BUCKETS + b];
+                if (t < tid) before_me += c;
+                total += c;
+            }
+            offset[b] = base + before_me;
+            base += total;
+        }
+        assert(base == N);
+
+        // 3. Scatter stabile della fetta nel buffer destinazione
+        for (long i = lo; i < hi; ++i) {
+            dst[offset[radix_digit(src[i], pass)]++] = src[i];
+        }
+        trace_barrier_wait(tr, t_args->barrier, pass, "Errore in spin_barrier_wait (radix, scatter)");
+
+        int *swap_tmp = src;
+        src = dst;
+        dst = swap_tmp;
+    }
+
+    trace_begin(tr, TRACE_COPY, -1);
+    copy_back_slice(t_args->array, src, N, P, tid);
+    trace_end(tr);
+}
+
+/**
+ * @brief Indice del bucket di 'value': numero di splitter <= value (upper_bound).
+ */
+static inline int sample_bucket(int value, const int *splitters, int n_splitters) {
+    int a = 0, b = n_splitters;
+    while (a < b) {
+        int m = a + (b - a) / 2;
+        if (splitters[m] <= value) a = m + 1; else b = m;
+    }
+    return a;
+}
+
+/**
+ * @brief Sample sort parallelo (vedi descrizione del file).
+ * @param t_args Argomenti del worker; usa t_args->histograms (P righe da SAMPLE_HIST_STRIDE(P)),
+ * t_args->splitters (P-1) e la coda concorrente per i bucket.
+ */
+void sample_sort_phase(ThreadArgs *t_args) {
+    int tid = t_args->thread_id;
+    int P = t_args->n_threads;
+    long N = t_args->n_elements;
+    int *array = t_args->array;
+    int *temp_array = t_args->temp_array;
+    long *hist = t_args->histograms;
+    long stride = SAMPLE_HIST_STRIDE(P);
+    long *my_hist = &hist[(long)tid * stride];
+    int *splitters = t_args->splitters;
+    long lo = partition_start(N, P, tid);
+    long hi = partition_start(N, P, tid + 1);
+    WorkerTrace *tr = t_args->trace;
+
+    // --- 1. (Solo Worker 0) Scelta degli splitter da un campione regolare ---
+    if (tid == 0 && P > 1) {
+        trace_begin(tr, TRACE_PARTITION, 0);
+        long n_samples = (long)P * SAMPLE_OVERSAMPLING;
+        if (n_samples > N) n_samples = N;
+        int *samples = malloc(n_samples * sizeof(int));
+        CHECK_ERR(samples == NULL, "Errore allocazione campione sample sort");
+        for (long s = 0; s < n_samples; ++s) {
+            samples[s] = array[s * N / n_samples];
+        }
+        sort_int(samples, n_samples);
+        for (int b = 1; b < P; ++b) {
+            splitters[b - 1] = samples[(long)b * n_samples / P];
+        }
+        free(samples);
+        DEBUG_PRINT(tid, "[SAMPLE] Scelti %d splitter da %ld campioni.", P - 1, n_samples);
+    }
+    trace_barrier_wait(tr, t_args->barrier, 0, "Errore in spin_barrier_wait (sample, splitter)");
+
+    // --- 2. Istogramma locale dei bucket ---
+    trace_begin(tr, TRACE_PARTITION, 1);
+    memset(my_hist, 0, P * sizeof(long));
+    for (long i = lo; i < hi; ++i) {
+        my_hist[sample_bucket(array[i], splitters, P - 1)]++;
+    }
+    trace_barrier_wait(tr, t_args->barrier, 1, "Errore in spin_barrier_wait (sample, istogrammi)");
+
+    // --- 3. Prefix-sum e scatter nei bucket di temp_array ---
+    trace_begin(tr, TRACE_PARTITION, 2);
+    long *offset = malloc(P * sizeof(long));
+    CHECK_ERR(offset == NULL, "Errore allocazione offset sample sort");
+    long base = 0;
+    for (int b = 0; b < P; ++b) {
+        long before_me = 0, total = 0;
+        for (int t = 0; t < P; ++t) {
+            long c = hist[(long)t * stride + b];
+            if (t < tid) before_me += c;
+            total += c;
+        }
+        offset[b] = base + before_me;
+        base += total;
+    }
+    for (long i = lo; i < hi; ++i) {
+        temp_array[offset[sample_bucket(array[i], splitters, P - 1)]++] = array[i];
+    }
+    free(offset);
+    trace_barrier_wait(tr, t_args->barrier, 2, "Errore in spin_barrier_wait (sample, scatter)");
+
+    // --- 4. (Solo Worker 0) Un task per ogni bucket non vuoto, accodati insieme ---
+    if (tid == 0) {
+        trace_begin(tr, TRACE_PARTITION, 3);
+        Partition_Index_Task *tasks = malloc(P * sizeof(Partition_Index_Task));
+        CHECK_ERR(tasks == NULL, "Worker 0: Errore allocazione task dei bucket");
+        long n_tasks = 0;
+        long start = 0;
+        for (int b = 0; b < P; ++b) {
+            long size = 0;
+            for (int t = 0; t < P; ++t) size += hist[(long)t * stride + b];
+            if (size > 0) {
+                tasks[n_tasks].start = start;
+                tasks[n_tasks].end = start + size - 1;
+                DEBUG_PRINT(tid, "[SAMPLE] Pushing bucket %d: start=%ld, end=%ld", b, start, start + size - 1);
+                n_tasks++;
+            }
+            start += size;
+        }
+        push_n(t_args->queue, tasks, n_tasks);
+        free(tasks);
+        close_queue(t_args->queue);
+    }
+
+    // --- 5. Ordinamento dei bucket prelevati dalla coda (tutti i worker) ---
+    trace_begin(tr, TRACE_SORT, -1);
+    Partition_Index_Task task;
+    while (pop(t_args->queue, &task)) {
+        sort_int(&temp_array[task.start], task.end - task.start + 1);
+    }
+    trace_barrier_wait(tr, t_args->barrier, -1, "Errore in spin_barrier_wait (sample, bucket ordinati)");
+
+    // --- 6. Copia del risultato in array ---
+    trace_begin(tr, TRACE_COPY, -1);
+    copy_back_slice(array, temp_array, N, P, tid);
+    trace_end(tr);
+}
@@ -2,37 +2,318 @@
  * @file main.c
  * @brief Programma principale per l'ordinamento parallelo di un array.
  *
- * Gestisce il parsing degli argomenti, l'allocazione delle risorse,
- * la creazione e la gestione dei thread worker, la verifica finale
- * e il cleanup. Introduce una mutex per serializzare le operazioni
- * di merge su temp_array e una nuova mutex per la fase di copia.
+ * Gestisce il parsing degli argomenti, l'allocazione e l'inizializzazione
+ * dell'array, l'ordinamento tramite un psort_context (psort.h), la verifica
+ * finale e il cleanup. Il contesto possiede i thread worker e le primitive
+ * di sincronizzazione, tra cui la mutex che serializza le operazioni di merge
+ * su temp_array e quella della fase di copia (usate solo con -m serial; con
+ * -m parallel e -m corank il merge procede senza lock alternando array e
+ * temp_array come sorgente e destinazione, con -m kway avviene in un solo
+ * passo P-way). Con -t gli elementi sono record a chiave int64_t (recsort.h),
+ * ordinati con psort_sort_records e verificati da run_record_sort; con -i/-o
+ * un file di int più grande della memoria è ordinato da external_sort_file.
+ * Con -N array e temp_array sono allocati secondo una politica NUMA
+ * (numautil.h) e toccati per primi dai worker proprietari delle partizioni;
+ * con -a i worker sono fissati alle CPU, distribuiti a turno sui nodi.
+ * L'input è generato in parallelo dai worker (datagen.h) con la forma scelta
+ * da --dist; a parità di --seed l'array generato è sempre lo stesso.
+ * Con --stats i tempi (e i contatori hardware) di ogni fase di ogni worker
+ * sono scritti in CSV o JSON (trace.h).
+ * Per default il programma stampa solo tempi e verifica: con -v 1 stampa anche
+ * l'avanzamento e gli array, con -v 2 anche il registro eventi dei worker
+ * (eventlog.h), raccolto senza stampe durante l'ordinamento.
+ * La verifica degli int è eseguita dai worker (verify.h): ordine delle coppie
+ * adiacenti e checksum del multinsieme confrontato con quello dell'input;
+ * --no-verify la salta per le sole misure di tempo.
  */
 
 #include <unistd.h>  
+#include <getopt.h>  // Per getopt_long (--seed, --dist)
 #include <time.h>    
 #include <pthread.h>
+#include <stdint.h>
+#include <stdarg.h>  // Per va_list (info)
 
 #include "common.h"
-#include "queue.h"
-#include "worker.h"
 #include "myutils.h"
+#include "psort.h"
+#include "extsort.h"
+#include "numautil.h"
+#include "datagen.h"
+#include "verify.h"
 
-// Dichiarazione della mutex globale per la fase di merge su temp_array
-pthread_mutex_t merge_temp_array_mutex;
+// Livello di dettaglio delle stampe (-v): 0 solo risultati, 1 avanzamento e array,
+// 2 anche il registro eventi dei worker
+static int verbosity = 0;
 
-// Dichiarazione della mutex globale per la fase di copia da temp_array ad array
-pthread_mutex_t copy_phase_mutex;
+/**
+ * @brief printf dei messaggi di avanzamento, solo con -v 1 o superiore.
+ */
+static void info(const char *format, ...) {
+    if (verbosity < 1) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Attiva il registro eventi dei worker se richiesto da -v 2.
+ */
+static void enable_event_log(psort_context *ctx) {
+    if (verbosity < 2) return;
+    CHECK_ERR(psort_enable_event_log(ctx) != 0, "Errore allocazione del registro eventi");
+}
+
+// Nomi delle modalità di merge accettati da -m, indicizzati per MergeMode
+static const char *merge_mode_names[MERGE_MODE_COUNT] = { "serial", "parallel", "corank", "kway" };
+
+// Nomi delle politiche di allocazione accettate da -N, indicizzati per NumaPolicy
+static const char *numa_policy_names[NUMA_POLICY_COUNT] = { "malloc", "firsttouch", "interleave" };
+
+// Nomi degli algoritmi di ordinamento accettati da -s, indicizzati per SortMode
+static const char *sort_mode_names[SORT_MODE_COUNT] = { "qsort", "radix", "sample" };
+
+/**
+ * @brief Chiave pseudo-casuale del record di indice originale 'idx' (mix di splitmix64).
+ *
+ * Derivare la chiave dall'indice permette di verificare dopo l'ordinamento
+ * che ogni record sia stato spostato intero, senza tenere una copia dell'input.
+ */
+static int64_t record_key(uint64_t seed, long idx, long n) {
+    return (int64_t)(datagen_mix(seed, (uint64_t)idx) % (uint64_t)(n * 10));
+}
+
+// GenerateArgs: Argomenti di generate_slice per psort_parallel_for.
+typedef struct {
+    int *data;         // Array da riempire
+    long n;            // Elementi dell'array
+    Distribution dist; // Forma dei dati (--dist)
+    uint64_t seed;     // Seed dei flussi pseudo-casuali (--seed)
+} GenerateArgs;
+
+/**
+ * @brief Genera la fetta [lo, hi) dell'array: eseguita da ogni worker del pool.
+ */
+static void generate_slice(void *arg, int index, long lo, long hi) {
+    (void)index;
+    const GenerateArgs *gen = arg;
+    datagen_fill(gen->data, lo, hi, gen->n, gen->dist, gen->seed);
+}
+
+// StatsOptions: Destinazione della misura per fase (--stats, --stats-format).
+typedef struct {
+    const char *path; // File di output ("-" per stdout), NULL se la misura non è richiesta
+    int json;         // 1 per JSON con riepilogo, 0 per CSV
+} StatsOptions;
+
+/**
+ * @brief Attiva la misura per fase sul contesto se richiesta da --stats.
+ */
+static void enable_stats(psort_context *ctx, const StatsOptions *stats) {
+    if (stats->path == NULL) return;
+    CHECK_ERR(psort_enable_stats(ctx) != 0, "Errore allocazione della misura per fase");
+}
+
+/**
+ * @brief Scrive la misura per fase dell'ultimo ordinamento nel file di --stats.
+ */
+static void write_stats(const psort_context *ctx, const StatsOptions *stats, const char *label) {
+    if (stats->path == NULL) return;
+    int to_stdout = (strcmp(stats->path, "-") == 0);
+    FILE *out = to_stdout ? stdout : fopen(stats->path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Attenzione: impossibile scrivere le statistiche in '%s': %s\n", stats->path, strerror(errno));
+        return;
+    }
+    psort_write_stats(ctx, out, stats->json, label);
+    if (!to_stdout) {
+        fclose(out);
+        printf("Statistiche per fase (%s) scritte in %s\n", stats->json ? "JSON" : "CSV", stats->path);
+    }
+}
+
+/**
+ * @brief Ordina il file di int 'input_path' in 'output_path' (opzioni -i/-o/-M)
+ * con external_sort_file, poi rilegge l'output in sequenza e verifica ordine,
+ * numero di elementi e checksum rispetto all'input.
+ *
+ * @return EXIT_SUCCESS se l'ordinamento esterno è riuscito, EXIT_FAILURE altrimenti.
+ */
+static int run_external_sort(const char *input_path, const char *output_path, int p,
+                             SortMode sort_mode, MergeMode merge_mode, long mem_mb) {
+    ExtSortStats stats;
+    info("Creazione di %d thread worker (da -w)...\n", p);
+    double sort_start_ms = get_time_ms();
+    if (external_sort_file(input_path, output_path, p, sort_mode, merge_mode,
+                           mem_mb * 1024 * 1024, &stats) != 0) {
+        fprintf(stderr, "Errore: ordinamento esterno di '%s' fallito.\n", input_path);
+        return EXIT_FAILURE;
+    }
+    double sort_time_ms = get_time_ms() - sort_start_ms;
+    printf("Ordinati %ld elementi in %d run.\n", stats.elements, stats.runs);
+    printf("Tempo ordinamento: %.3f ms\n", sort_time_ms);
+    printf("Tempo generazione run: %.3f ms\n", stats.run_time_ms);
+    printf("Tempo fase merge: %.3f ms\n", stats.merge_time_ms);
+
+    // --- Verifica Correttezza Ordinamento (lettura sequenziale dell'output) ---
+    FILE *f = fopen(output_path, "rb");
+    CHECK_ERR(f == NULL, "Errore apertura output per la verifica");
+    int buffer[4096];
+    size_t got;
+    long count = 0;
+    uint64_t checksum = 0;
+    int prev = 0;
+    int sorted = 1;
+    while ((got = fread(buffer, sizeof(int), 4096, f)) > 0) {
+        for (size_t i = 0; i < got; ++i) {
+            if (count > 0 && buffer[i] < prev && sorted) {
+                fprintf(stderr, "ERRORE: l'output NON è ordinato! elemento %ld=%d < precedente %d\n",
+                        count, buffer[i], prev);
+                sorted = 0;
+            }
+            prev = buffer[i];
+            count++;
+        }
+        checksum += checksum_int_block(buffer, (long)got);
+    }
+    fclose(f);
+    if (count != stats.elements || checksum != stats.checksum) {
+        fprintf(stderr, "ERRORE: l'output ha %ld elementi (attesi %ld) o checksum diverso dall'input.\n",
+                count, stats.elements);
+        sorted = 0;
+    }
+    if (sorted) {
+        printf("Verifica: L'array è ordinato correttamente.\n");
+    } else {
+        printf("Verifica: ERRORE, l'array NON è ordinato!\n");
+    }
+    info("Esecuzione terminata con successo.\n");
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Ordina N record del tipo 'kernel' (opzione -t) e ne verifica il risultato.
+ *
+ * Ogni record contiene la chiave, l'indice originale nei primi 8 byte dopo la
+ * chiave (il campo index di KeyIndexRecord) e, nei byte restanti del payload,
+ * valori derivati dall'indice. La verifica controlla l'ordine delle chiavi e
+ * che chiave e payload corrispondano ancora all'indice memorizzato.
+ *
+ * @return EXIT_SUCCESS (l'esito della verifica è stampato come per gli int).
+ */
+static int run_record_sort(const RecordKernel *kernel, long n, int p, uint64_t seed, const StatsOptions *stats) {
+    size_t size = kernel->size;
+    unsigned char *records = malloc(n * size);
+    CHECK_ERR(records == NULL, "Errore allocazione record");
+    unsigned char *temp_records = malloc(n * size);
+    CHECK_ERR(temp_records == NULL, "Errore allocazione record temporanei");
+
+    info("Inizializzazione di %ld record %s (%zu byte) con chiavi casuali...\n", n, kernel->name, size);
+    for (long i = 0; i < n; ++i) {
+        unsigned char *rec = records + i * size;
+        int64_t key = record_key(seed, i, n);
+        int64_t idx = i;
+        memcpy(rec, &key, sizeof(key));
+        memcpy(rec + 8, &idx, sizeof(idx));
+        for (size_t b = 16; b < size; ++b) rec[b] = (unsigned char)(i * 31 + b);
+    }
+
+    info("Creazione di %d thread worker (da -w)...\n", p);
+    psort_context *ctx = psort_create(p, SORT_QSORT, MERGE_CORANK);
+    CHECK_ERR(ctx == NULL, "Errore creazione contesto di ordinamento");
+    enable_stats(ctx, stats);
+    enable_event_log(ctx);
+    double sort_start_ms = get_time_ms();
+    CHECK_ERR(psort_sort_records(ctx, kernel, records, n, temp_records) != 0, "Errore durante l'ordinamento");
+    double sort_time_ms = get_time_ms() - sort_start_ms;
+    info("Tutti i thread hanno terminato.\n");
+    psort_dump_event_log(ctx, stdout);
+    printf("Tempo ordinamento: %.3f ms\n", sort_time_ms);
+    char label[128];
+    snprintf(label, sizeof(label), "N=%ld P=%d type=%s seed=%llu", n, p, kernel->name, (unsigned long long)seed);
+    write_stats(ctx, stats, label);
+
+    int sorted = 1;
+    uint64_t idx_sum = 0; // Somma degli indici: n(n-1)/2 se nessun record è duplicato o perso
+    int64_t prev_key = INT64_MIN;
+    for (long i = 0; i < n && sorted; ++i) {
+        const unsigned char *rec = records + i * size;
+        int64_t key, idx;
+        memcpy(&key, rec, sizeof(key));
+        memcpy(&idx, rec + 8, sizeof(idx));
+        int intact = (idx >= 0 && idx < n && key == record_key(seed, idx, n));
+        for (size_t b = 16; b < size && intact; ++b) intact = (rec[b] == (unsigned char)(idx * 31 + b));
+        if (key < prev_key || !intact) {
+            fprintf(stderr, "ERRORE: record %ld non ordinato o corrotto (chiave=%lld, indice=%lld)\n",
+                    i, (long long)key, (long long)idx);
+            sorted = 0;
+        }
+        prev_key = key;
+        idx_sum += (uint64_t)idx;
+    }
+    if (sorted && idx_sum != (uint64_t)n * (uint64_t)(n - 1) / 2) {
+        fprintf(stderr, "ERRORE: indici dei record duplicati o persi.\n");
+        sorted = 0;
+    }
+    if (sorted) {
+        printf("Verifica: L'array è ordinato correttamente.\n");
+    } else {
+        printf("Verifica: ERRORE, l'array NON è ordinato!\n");
+    }
+
+    info("Pulizia risorse...\n");
+    free(records);
+    free(temp_records);
+    psort_destroy(ctx);
+    info("Esecuzione terminata con successo.\n");
+    return EXIT_SUCCESS;
+}
 
 
 int main(int argc, char *argv[]) {
     long n = 0; // Numero elementi array (N) - Da opzione -n
     int p = 0;  // Numero thread worker (P) - Da opzione -w
     int opt;    // Variabile per getopt
-    int err;    // Variabile per controllo errori pthread
+    MergeMode merge_mode = MERGE_PARALLEL; // Strategia di merge - Da opzione -m
+    SortMode sort_mode = SORT_QSORT;       // Algoritmo di ordinamento - Da opzione -s
+    const RecordKernel *record_kernel = NULL; // Tipo di record (NULL: int) - Da opzione -t
+    const char *input_path = NULL;  // File di int da ordinare (ordinamento esterno) - Da opzione -i
+    const char *output_path = NULL; // File ordinato prodotto - Da opzione -o
+    long mem_mb = 1024;             // Memoria per i buffer dell'ordinamento esterno, in MB - Da opzione -M
+    NumaPolicy numa_policy = NUMA_MALLOC; // Allocazione di array e temp_array - Da opzione -N
+    int pin_threads = 0;            // 1 per fissare i worker alle CPU - Da opzione -a
+    uint64_t seed = (uint64_t)time(NULL); // Seed dei dati generati - Da opzione --seed
+    Distribution dist = DIST_UNIFORM;     // Forma dei dati generati - Da opzione --dist
+    StatsOptions stats = { NULL, 0 };     // Misura per fase - Da opzioni --stats e --stats-format
+    int adaptive = 1;                     // Rilevamento dei run naturali - Disattivato da --no-adaptive
+    int verify = 1;                       // Verifica di ordine e checksum - Disattivata da --no-verify
+
+    // Opzioni lunghe: il valore restituito da getopt_long è il 'case' dello switch
+    static const struct option long_options[] = {
+        { "seed", required_argument, NULL, 'S' },
+        { "dist", required_argument, NULL, 'D' },
+        { "stats", required_argument, NULL, 'T' },
+        { "stats-format", required_argument, NULL, 'F' },
+        { "verbose", required_argument, NULL, 'v' },
+        { "no-adaptive", no_argument, NULL, 'R' },
+        { "no-verify", no_argument, NULL, 'K' },
+        { NULL, 0, NULL, 0 }
+    };
 
     // --- Parsing Argomenti Riga di Comando ---
-    // Utilizza getopt per leggere le opzioni -n (numero elementi) e -w (numero worker)
-    while ((opt = getopt(argc, argv, "n:w:")) != -1) {
+    // Utilizza getopt per leggere le opzioni -n (numero elementi), -w (numero worker)
+    // -m (strategia di merge: "serial", "parallel", "corank" o "kway")
+    // -s (algoritmo di ordinamento: "qsort", "radix" o "sample")
+    // -t (tipo di elemento: "int" oppure un record "keyindex", "rec8", "rec16", "rec32", "rec64")
+    // -i/-o/-M (ordinamento esterno: file di input, file di output, memoria in MB)
+    // -N (allocazione: "malloc", "firsttouch" o "interleave"), -a (pinning dei worker)
+    // --seed (seed dei dati generati), --dist (forma dei dati: uniform, sorted, ...)
+    // --stats/--stats-format (file e formato, "csv" o "json", della misura per fase)
+    // -v/--verbose (0 solo risultati, 1 avanzamento e array, 2 registro eventi dei worker)
+    // --no-adaptive (ordina sempre da capo, anche l'input già ordinato o fatto di pochi run)
+    // e --no-verify (nessuna verifica dopo l'ordinamento, per le sole misure di tempo)
+    while ((opt = getopt_long(argc, argv, "n:w:m:s:t:i:o:M:N:av:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'n':
                 n = atol(optarg); // Converte l'argomento di -n a long
@@ -40,165 +321,272 @@ int main(int argc, char *argv[]) {
             case 'w':
                 p = atoi(optarg); // Converte l'argomento di -w a int
                 break;
+            case 'm': {
+                int found = 0;
+                for (int i = 0; i < MERGE_MODE_COUNT; ++i) {
+                    if (strcmp(optarg, merge_mode_names[i]) == 0) {
+                        merge_mode = (MergeMode)i;
+                        found = 1;
+                    }
+                }
+                if (!found) {
+                    fprintf(stderr, "Errore: modalità di merge '%s' non valida (usare serial, parallel, corank o kway).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 's': {
+                int found = 0;
+                for (int i = 0; i < SORT_MODE_COUNT; ++i) {
+                    if (strcmp(optarg, sort_mode_names[i]) == 0) {
+                        sort_mode = (SortMode)i;
+                        found = 1;
+                    }
+                }
+                if (!found) {
+                    fprintf(stderr, "Errore: algoritmo di ordinamento '%s' non valido (usare qsort, radix o sample).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 't':
+                if (strcmp(optarg, "int") != 0) {
+                    record_kernel = record_kernel_by_name(optarg);
+                    if (record_kernel == NULL) {
+                        fprintf(stderr, "Errore: tipo di elemento '%s' non valido (usare int, keyindex, rec8, rec16, rec32 o rec64).\n", optarg);
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                break;
+            case 'i':
+                input_path = optarg;
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'M':
+                mem_mb = atol(optarg);
+                break;
+            case 'N': {
+                int found = 0;
+                for (int i = 0; i < NUMA_POLICY_COUNT; ++i) {
+                    if (strcmp(optarg, numa_policy_names[i]) == 0) {
+                        numa_policy = (NumaPolicy)i;
+                        found = 1;
+                    }
+                }
+                if (!found) {
+                    fprintf(stderr, "Errore: politica di allocazione '%s' non valida (usare malloc, firsttouch o interleave).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'a':
+                pin_threads = 1;
+                break;
+            case 'S':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'D':
+                dist = distribution_by_name(optarg);
+                if (dist == DIST_COUNT) {
+                    fprintf(stderr, "Errore: distribuzione '%s' non valida (usare uniform, sorted, reverse, nearly-sorted, few-unique, zipf o organ-pipe).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'T':
+                stats.path = optarg;
+                break;
+            case 'R':
+                adaptive = 0;
+                break;
+            case 'K':
+                verify = 0;
+                break;
+            case 'v':
+                verbosity = atoi(optarg);
+                if (verbosity < 0 || verbosity > 2 || strspn(optarg, "0123456789") != strlen(optarg)) {
+                    fprintf(stderr, "Errore: livello di verbosità '%s' non valido (usare 0, 1 o 2).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'F':
+                if (strcmp(optarg, "csv") == 0) {
+                    stats.json = 0;
+                } else if (strcmp(optarg, "json") == 0) {
+                    stats.json = 1;
+                } else {
+                    fprintf(stderr, "Errore: formato delle statistiche '%s' non valido (usare csv o json).\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
             default:
                 // Se viene usata un'opzione non valida, stampa un messaggio di errore ed esce
-                fprintf(stderr, "Uso: %s -n <num_elementi> -w <num_worker>\n", argv[0]);
+                fprintf(stderr, "Uso: %s -n <num_elementi> -w <num_worker> [-m serial|parallel|corank|kway] [-s qsort|radix|sample] [-t int|keyindex|rec8|rec16|rec32|rec64] [-N malloc|firsttouch|interleave] [-a] [--seed <n>] [--dist <forma>] [--stats <file>] [--stats-format csv|json] [-v 0|1|2] [--no-adaptive] [--no-verify]\n"
+                                "     %s -i <input> -o <output> -w <num_worker> [-M <MB>] [-m ...] [-s ...]\n", argv[0], argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
 
+    // --- Ordinamento Esterno (-i/-o): N è la dimensione del file ---
+    if (input_path != NULL || output_path != NULL) {
+        if (input_path == NULL || output_path == NULL || p <= 0 || mem_mb <= 0) {
+            fprintf(stderr, "Errore: l'ordinamento esterno richiede -i <input>, -o <output>, -w <num_worker> (positivo) e -M <MB> (positivo).\n");
+            exit(EXIT_FAILURE);
+        }
+        info("Avvio parallel_sort esterno su '%s' -> '%s' con P=%d worker (da -w), %ld MB, ordinamento %s, merge %s.\n",
+               input_path, output_path, p, mem_mb, sort_mode_names[sort_mode], merge_mode_names[merge_mode]);
+        return run_external_sort(input_path, output_path, p, sort_mode, merge_mode, mem_mb);
+    }
+
     // --- Controllo Validità Argomenti ---
     if (n <= 0 || p <= 0) {
         fprintf(stderr, "Errore: Specificare -n <num_elementi> (positivo) e -w <num_worker> (positivo).\n");
         fflush(stderr);
         exit(EXIT_FAILURE);
     }
-    // Controllo se P è una potenza di 2.
-    // p = 1 è una potenza di 2 (2^0), quindi è valido.
-    // Per p > 1, (p & (p - 1)) == 0 se p è una potenza di 2.
-    // Quindi, (p & (p - 1)) != 0 se p NON è una potenza di 2 (per p > 1).
-    if ((p != 1) && ((p & (p - 1)) != 0)) {
-        fprintf(stderr, "ERRORE: Il numero di worker P=%d (da opzione -w) non è una potenza di 2.\n", p);
-        fprintf(stderr, "         Per questo algoritmo, P deve essere una potenza di 2 (es. 1, 2, 4, 8, ...).\n");
-        exit(EXIT_FAILURE); // Interrompe l'esecuzione 
+    // P può essere qualsiasi (non serve una potenza di 2): il merge a coppie usa ceil(log2(P)) passi
+    // e i gruppi di partizioni senza compagno passano intatti al passo successivo.
+
+    if (record_kernel != NULL) {
+        info("Avvio parallel_sort con N=%ld record e P=%d worker (da -w), tipo %s.\n", n, p, record_kernel->name);
+        return run_record_sort(record_kernel, n, p, seed, &stats);
     }
 
-    printf("Avvio parallel_sort con N=%ld elementi e P=%d worker (da -w).\n", n, p);
+    info("Avvio parallel_sort con N=%ld elementi e P=%d worker (da -w), ordinamento %s, merge %s.\n",
+           n, p, sort_mode_names[sort_mode], merge_mode_names[merge_mode]);
+
+    // --- Creazione del Contesto (pool di thread riusabile, vedi psort.h) ---
+    // Coda, barriera, mutex di merge/copia, istogrammi e ThreadArgs sono
+    // posseduti dal contesto; temp_array è passato come buffer temporaneo.
+    // Il contesto è creato prima degli array perché con -N i suoi worker
+    // eseguono la prima scrittura delle pagine.
+    info("Creazione di %d thread worker (da -w)...\n", p);
+    psort_context *ctx = psort_create(p, sort_mode, merge_mode);
+    CHECK_ERR(ctx == NULL, "Errore creazione contesto di ordinamento");
+    enable_stats(ctx, &stats);
+    enable_event_log(ctx);
+    psort_set_adaptive(ctx, adaptive);
+    if (pin_threads && psort_pin_threads(ctx) != 0) {
+        fprintf(stderr, "Attenzione: impossibile fissare tutti i worker alle CPU, si prosegue senza pinning.\n");
+    }
 
     // --- Allocazione Memoria ---
     // Alloca memoria per l'array principale che conterrà i dati da ordinare
-    int *array = malloc(n * sizeof(int));
-    CHECK_ERR(array == NULL, "Errore allocazione array principale"); // Controlla se malloc ha fallito
-
-    // Alloca memoria per l'array temporaneo usato durante la fase di merge
-    int *temp_array = malloc(n * sizeof(int));
+    // e per l'array temporaneo usato durante la fase di merge
+    size_t array_bytes = n * sizeof(int);
+    int *array = numa_alloc_buffer(array_bytes, numa_policy);
+    CHECK_ERR(array == NULL, "Errore allocazione array principale"); // Controlla se l'allocazione è fallita
+    int *temp_array = numa_alloc_buffer(array_bytes, numa_policy);
     CHECK_ERR(temp_array == NULL, "Errore allocazione array temporaneo");
 
-   
-    // --- Inizializzazione Array Casuale ---
-    srand(time(NULL)); // Inizializza il generatore di numeri casuali
-    printf("Inizializzazione array con valori casuali...\n");
-    for (long i = 0; i < n; ++i) {
-        array[i] = rand() % (n * 10); // Riempie l'array con valori casuali
+    // Con firsttouch/interleave ogni worker tocca per primo la propria partizione
+    // di temp_array; quella di array la scrive per primo il generatore qui sotto.
+    if (numa_policy != NUMA_MALLOC) {
+        psort_first_touch(ctx, temp_array, n, sizeof(int));
     }
 
-    // Stampa l'array iniziale se DEBUG è 0 (richiesta specifica)
+    // --- Generazione Parallela dell'Array ---
+    // Ogni worker genera la propria partizione; il valore di array[i] dipende
+    // solo da seed, i e N, quindi lo stesso --seed riproduce lo stesso input.
+    info("Inizializzazione array (distribuzione %s, seed %llu)...\n",
+           distribution_names[dist], (unsigned long long)seed);
+    GenerateArgs gen = { array, n, dist, seed };
+    psort_parallel_for(ctx, n, generate_slice, &gen);
+    // Checksum dell'input per la verifica (fuori dalla misura del tempo di ordinamento)
+    uint64_t input_checksum = verify ? verify_checksum_int(ctx, array, n) : 0;
+
+    // Stampa l'array iniziale se DEBUG è 0 e -v >= 1
     // o se DEBUG è diverso da 0 (comportamento standard della macro DEBUG_PRINT)
     #if DEBUG == 0
-    if (n > 0) print_array("Array Iniziale", array, n);
+    if (verbosity >= 1 && n > 0) print_array("Array Iniziale", array, n);
     #else
     print_array("Array Iniziale (DEBUG ATTIVO)", array, n); // Questa è la stampa originale sotto #if DEBUG
     #endif
 
+    double sort_start_ms = get_time_ms(); // Inizio misura del tempo complessivo di ordinamento
+    CHECK_ERR(psort_sort_int(ctx, array, n, temp_array) != 0, "Errore durante l'ordinamento");
+    double sort_time_ms = get_time_ms() - sort_start_ms;
+    info("Tutti i thread hanno terminato.\n");
+    psort_dump_event_log(ctx, stdout);
+    printf("Tempo ordinamento: %.3f ms\n", sort_time_ms);
+    printf("Tempo fase merge: %.3f ms\n", psort_merge_time_ms(ctx));
+    char label[160];
+    snprintf(label, sizeof(label), "N=%ld P=%d sort=%s merge=%s dist=%s seed=%llu", n, p,
+             sort_mode_names[sort_mode], merge_mode_names[merge_mode], distribution_names[dist],
+             (unsigned long long)seed);
+    write_stats(ctx, &stats, label);
+
+    // Località delle pagine rispetto ai worker proprietari: approssima il traffico
+    // remoto/locale delle fasi divise staticamente (richiede il nodo dei worker, -N o -a)
+    if (numa_policy != NUMA_MALLOC || pin_threads) {
+        long local_pages, remote_pages;
+        if (psort_page_locality(ctx, array, n, sizeof(int), &local_pages, &remote_pages) == 0) {
+            printf("NUMA: %d nodi, allocazione %s, pagine dell'array locali %ld, remote %ld\n",
+                   numa_count_nodes(), numa_policy_names[numa_policy], local_pages, remote_pages);
+        } else {
+            printf("NUMA: %d nodi, allocazione %s, località delle pagine non disponibile\n",
+                   numa_count_nodes(), numa_policy_names[numa_policy]);
+        }
+    }
 
-    // --- Inizializzazione Strutture di Sincronizzazione ---
-    ConcurrentQueue queue; // Istanza della coda concorrente
-    CHECK_ERR(init_queue(&queue) != 0, "Errore inizializzazione coda"); // Inizializza la coda
-
-    pthread_barrier_t barrier; // Istanza della barriera
-    // Inizializza la barriera per 'p' thread worker
-    err = pthread_barrier_init(&barrier, NULL, p);
-    CHECK_PTHREAD_ERR(err, "Errore pthread_barrier_init");
-
-    // Inizializza il mutex usato per proteggere l'accesso a temp_array durante il merge
-    err = pthread_mutex_init(&merge_temp_array_mutex, NULL);
-    CHECK_PTHREAD_ERR(err, "Errore pthread_mutex_init for merge_temp_array_mutex");
-
-    // Inizializza il mutex usato per proteggere la copia da temp_array ad array
-    err = pthread_mutex_init(&copy_phase_mutex, NULL);
-    CHECK_PTHREAD_ERR(err, "Errore pthread_mutex_init for copy_phase_mutex");
-
-
-
-    // --- Preparazione Argomenti Thread ---
-    // Alloca memoria per un array di strutture ThreadArgs, una per ogni worker
-    ThreadArgs *thread_args = malloc(p * sizeof(ThreadArgs));
-    CHECK_ERR(thread_args == NULL, "Errore allocazione ThreadArgs");
-    // Alloca memoria per un array di identificatori di thread (pthread_t)
-    pthread_t *threads = malloc(p * sizeof(pthread_t));
-    CHECK_ERR(threads == NULL, "Errore allocazione pthread_t");
-
-    // --- Creazione Thread Worker ---
-    printf("Creazione di %d thread worker (da -w)...\n", p);
-    for (int i = 0; i < p; ++i) {
-        // Popola la struttura ThreadArgs per il worker corrente
-        thread_args[i].thread_id = i;
-        thread_args[i].array = array;
-        thread_args[i].temp_array = temp_array;
-        thread_args[i].n_elements = n;
-        thread_args[i].n_threads = p;
-        thread_args[i].queue = &queue;
-        thread_args[i].barrier = &barrier;
-        thread_args[i].merge_mutex_ptr = &merge_temp_array_mutex;
-        thread_args[i].copy_phase_mutex_ptr = &copy_phase_mutex;
-        
-        // Crea il thread worker, passando la funzione worker_thread e gli argomenti specifici
-        err = pthread_create(&threads[i], NULL, worker_thread, &thread_args[i]);
-        CHECK_PTHREAD_ERR(err, "Errore creazione thread");
-    }
-
-    // --- Attesa Terminazione Thread (Join) ---
-    // Il thread principale attende che tutti i thread worker terminino la loro esecuzione.
-    printf("Attesa terminazione thread (join)...\n");
-    for (int i = 0; i < p; ++i) {
-        pthread_join(threads[i], NULL); // Attende la terminazione del thread i-esimo
-    }
-    printf("Tutti i thread hanno terminato.\n");
-
-    // Stampa l'array finale se DEBUG è 0 
+    // Stampa l'array finale se DEBUG è 0 e -v >= 1
     // o se DEBUG è diverso da 0 (comportamento standard della macro DEBUG_PRINT)
     #if DEBUG == 0
-    if (n > 0) print_array("Array Finale", array, n);
+    if (verbosity >= 1 && n > 0) print_array("Array Finale", array, n);
     #else
     print_array("Array Finale (DEBUG ATTIVO)", array, n); // Questa è la stampa originale sotto #if DEBUG
     #endif
 
 
-    // --- Verifica Correttezza Ordinamento ---
-    DEBUG_PRINT_GEN("Inizio verifica ordinamento array...");
-    int sorted = 1; // Flag per indicare se l'array è ordinato
-    // Scorre l'array per verificare se è ordinato confrontando elementi adiacenti
-    for (long i = 0; i < n - 1; ++i) {
-        if (array[i] > array[i + 1]) {
-            fprintf(stderr, "ERRORE: l'array NON è ordinato! array[%ld]=%d > array[%ld]=%d\n",
-                    i, array[i], i + 1, array[i + 1]);
+    // --- Verifica Correttezza Ordinamento (in parallelo sul pool) ---
+    // Ordine: ogni worker controlla le coppie adiacenti della propria fetta, compresa
+    // quella a cavallo con la fetta successiva. Permutazione: il checksum del multinsieme
+    // dell'output deve coincidere con quello calcolato sull'input prima dell'ordinamento.
+    if (!verify) {
+        printf("Verifica: saltata (--no-verify).\n");
+    } else {
+        DEBUG_PRINT_GEN("Inizio verifica ordinamento array...");
+        long i = verify_sorted_int(ctx, array, n);
+        int sorted = (i < 0); // Flag per indicare se l'array è ordinato
+        if (!sorted) {
+            // Il seed è stampato solo con -v 1: qui serve per riprodurre l'errore
+            fprintf(stderr, "ERRORE: l'array NON è ordinato! array[%ld]=%d > array[%ld]=%d (dist %s, seed %llu)\n",
+                    i, array[i], i + 1, array[i + 1], distribution_names[dist], (unsigned long long)seed);
             // Se DEBUG è attivo e si trova un errore, stampa una porzione dell'array attorno all'errore
             #if DEBUG
             long start_print = (i > 10) ? i - 10 : 0;
             long end_print = (i + 10 < n) ? i + 10 : n -1;
-            if (n > 0) {
-                fprintf(stderr, "[DEBUG] Elementi intorno all'errore (indici %ld-%ld):\n", start_print, end_print);
-                for(long j = start_print; j <= end_print; ++j) {
-                    fprintf(stderr, "[DEBUG] array[%ld] = %d%s\n", j, array[j], (j==i || j==i+1) ? " <<< ERRORE QUI" : "");
-                }
+            fprintf(stderr, "[DEBUG] Elementi intorno all'errore (indici %ld-%ld):\n", start_print, end_print);
+            for(long j = start_print; j <= end_print; ++j) {
+                fprintf(stderr, "[DEBUG] array[%ld] = %d%s\n", j, array[j], (j==i || j==i+1) ? " <<< ERRORE QUI" : "");
             }
             #endif
-            sorted = 0; // Imposta il flag a 0 (non ordinato)
-            break;      // Interrompe il ciclo, non è necessario continuare
         }
+        uint64_t output_checksum = verify_checksum_int(ctx, array, n);
+        if (output_checksum != input_checksum) {
+            fprintf(stderr, "ERRORE: l'array ordinato non è una permutazione dell'input (checksum %016llx, atteso %016llx; dist %s, seed %llu)\n",
+                    (unsigned long long)output_checksum, (unsigned long long)input_checksum,
+                    distribution_names[dist], (unsigned long long)seed);
+            sorted = 0;
+        }
+        if (sorted) {
+            printf("Verifica: L'array è ordinato correttamente.\n");
+        } else {
+            printf("Verifica: ERRORE, l'array NON è ordinato!\n");
+        }
+        DEBUG_PRINT_GEN("Verifica ordinamento completata.");
     }
-    if (sorted) {
-        printf("Verifica: L'array è ordinato correttamente.\n");
-    } else {
-        printf("Verifica: ERRORE, l'array NON è ordinato!\n");
-    }
-    DEBUG_PRINT_GEN("Verifica ordinamento completata.");
 
     // --- Cleanup Risorse ---
     // Libera tutta la memoria allocata dinamicamente e distrugge le primitive di sincronizzazione.
     DEBUG_PRINT_GEN("Inizio cleanup risorse...");
-    printf("Pulizia risorse...\n");
-    free(array);                      // Libera l'array principale
-    free(temp_array);                 // Libera l'array temporaneo
-    free(thread_args);                // Libera l'array degli argomenti dei thread
-    free(threads);                    // Libera l'array degli ID dei thread
-    destroy_queue(&queue);            // Distrugge la coda concorrente
-    pthread_barrier_destroy(&barrier); // Distrugge la barriera
-    pthread_mutex_destroy(&merge_temp_array_mutex); // Distrugge il mutex di merge
-    pthread_mutex_destroy(&copy_phase_mutex);       // Distrugge il mutex di copia
-    DEBUG_PRINT_GEN("Mutex per fase di copia distrutto.");
+    info("Pulizia risorse...\n");
+    numa_free_buffer(array, array_bytes, numa_policy);      // Libera l'array principale
+    numa_free_buffer(temp_array, array_bytes, numa_policy); // Libera l'array temporaneo
+    psort_destroy(ctx);               // Termina il pool e distrugge coda, barriera e mutex
     DEBUG_PRINT_GEN("Cleanup completato.");
 
-    printf("Esecuzione terminata con successo.\n");
+    info("Esecuzione terminata con successo.\n");
     return EXIT_SUCCESS; // Termina il programma con successo
 }
\ No newline at end of file
@@ -5,15 +5,25 @@
  * Questo file contiene:
  * - qsort_compare: una funzione di confronto standard per qsort per interi.
  * - merge_sections: la logica chiave per unire due sezioni ordinate di un array sorgente
- * in un array destinazione. Include stampe di debug dettagliate se DEBUG è attivo.
+ * in un array destinazione. Include stampe di debug dettagliate se DEBUG è attivo;
+ * con DEBUG a 0 il merge vero e proprio è delegato a merge_int (sortkernel.c).
  * - print_array: una funzione per stampare il contenuto di un array, con gestione
  * per array grandi (stampa solo inizio e fine) e casi limite (array nullo o vuoto).
+ * - partition_start: indice di inizio di una partizione della Fase 1.
+ * - co_rank: divisione merge-path di un merge tra più worker (modalità MERGE_CORANK).
+ * - kway_split / kway_merge: splitter e loser tree per il merge P-way in un
+ * solo passo (modalità MERGE_KWAY).
+ * - cache_aligned_calloc: allocazione azzerata allineata alla linea di cache.
+ * - get_time_ms: lettura del clock monotono per misurare le fasi.
  */
 
 #include "myutils.h" // Contiene la dichiarazione di merge_sections e qsort_compare
+#include "sortkernel.h" // Contiene merge_int (kernel di merge branchless/AVX2)
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>  
+#include <time.h>    // Per clock_gettime
+#include <limits.h>  // Per INT_MIN, INT_MAX
 
 /**
  * @brief Funzione di confronto per qsort per ordinare interi in ordine ascendente.
@@ -53,8 +63,8 @@ int qsort_compare(const void *a, const void *b) {
  * l'esecuzione del merge passo-passo per verifiche.
  */
 void merge_sections(int *source, int *dest,
-                    int start1, int end1,
-                    int start2, int end2,
+                    long start1, long end1,
+                    long start2, long end2,
                     long N_total) {
 
     // -------------- INIZIO BLOCCO STAMPE DI DEBUG PER MERGE_SECTIONS --------------
@@ -62,18 +72,18 @@ void merge_sections(int *source, int *dest,
     // Queste stampe sono attive solo se DEBUG è settato 1
     // Forniscono informazioni dettagliate sugli input e lo stato del merge.
     printf("[MERGE_SECTIONS DEBUG ENTRY] (TID non disponibile direttamente qui)\n");
-    printf("  Parametri: source=%p, dest=%p, s1=%d, e1=%d, s2=%d, e2=%d, N_total=%ld\n",
+    printf("  Parametri: source=%p, dest=%p, s1=%ld, e1=%ld, s2=%ld, e2=%ld, N_total=%ld\n",
            (void*)source, (void*)dest, start1, end1, start2, end2, N_total);
     
-    long dbg_num_elements1_calc = (end1 >= start1) ? (long)end1 - start1 + 1 : 0;
-    long dbg_num_elements2_calc = (end2 >= start2) ? (long)end2 - start2 + 1 : 0;
+    long dbg_num_elements1_calc = (end1 >= start1) ? end1 - start1 + 1 : 0;
+    long dbg_num_elements2_calc = (end2 >= start2) ? end2 - start2 + 1 : 0;
 
-    printf("  Source Block1 (indices %d-%d, %ld elementi): ", start1, end1, dbg_num_elements1_calc);
-    if(dbg_num_elements1_calc > 0 && start1 >=0 && end1 < N_total) for(int x=start1; x<=end1; ++x) printf("%d ", source[x]); else printf("(vuoto o non valido)");
+    printf("  Source Block1 (indices %ld-%ld, %ld elementi): ", start1, end1, dbg_num_elements1_calc);
+    if(dbg_num_elements1_calc > 0 && start1 >=0 && end1 < N_total) for(long x=start1; x<=end1; ++x) printf("%d ", source[x]); else printf("(vuoto o non valido)");
     printf("\n");
 
-    printf("  Source Block2 (indices %d-%d, %ld elementi): ", start2, end2, dbg_num_elements2_calc);
-    if(dbg_num_elements2_calc > 0 && start2 >=0 && end2 < N_total) for(int x=start2; x<=end2; ++x) printf("%d ", source[x]); else printf("(vuoto o non valido)");
+    printf("  Source Block2 (indices %ld-%ld, %ld elementi): ", start2, end2, dbg_num_elements2_calc);
+    if(dbg_num_elements2_calc > 0 && start2 >=0 && end2 < N_total) for(long x=start2; x<=end2; ++x) printf("%d ", source[x]); else printf("(vuoto o non valido)");
     printf("\n");
     fflush(stdout); // Assicura che le stampe di debug appaiano immediatamente
     #endif
@@ -95,18 +105,18 @@ void merge_sections(int *source, int *dest,
     }
 
     // Indici per scorrere le due sezioni sorgente (i, j) e la sezione destinazione (k)
-    int i = start1; // Indice per la prima sezione (source[start1...end1])
-    int j = start2; // Indice per la seconda sezione (source[start2...end2])
-    int k = start1; // Indice per l'array destinazione (dest[start1...])
+    long i = start1; // Indice per la prima sezione (source[start1...end1])
+    long j = start2; // Indice per la seconda sezione (source[start2...end2])
+    long k = start1; // Indice per l'array destinazione (dest[start1...])
 
     // Calcola il numero di elementi in ciascuna sezione sorgente
-    long num_elements1 = (end1 >= start1) ? (long)end1 - start1 + 1 : 0;
-    long num_elements2 = (end2 >= start2) ? (long)end2 - start2 + 1 : 0;
+    long num_elements1 = (end1 >= start1) ? end1 - start1 + 1 : 0;
+    long num_elements2 = (end2 >= start2) ? end2 - start2 + 1 : 0;
 
     // Se entrambe le sezioni sorgente sono vuote, non c'è nulla da unire.
     if (num_elements1 == 0 && num_elements2 == 0) {
         #if DEBUG
-        printf("[MERGE_SECTIONS s1=%d] Entrambi i blocchi sorgente vuoti. Uscita.\n", start1); fflush(stdout);
+        printf("[MERGE_SECTIONS s1=%ld] Entrambi i blocchi sorgente vuoti. Uscita.\n", start1); fflush(stdout);
         #endif
         return; // Termina la funzione
     }
@@ -119,12 +129,12 @@ void merge_sections(int *source, int *dest,
     }
 
     #if DEBUG
-    printf("[MERGE_SECTIONS PRE-LOOP s1=%d] i=%d, j=%d, k_start_write=%d, expected_end_write=%ld\n",
+    printf("[MERGE_SECTIONS PRE-LOOP s1=%ld] i=%ld, j=%ld, k_start_write=%ld, expected_end_write=%ld\n",
            start1, i, j, k, expected_end_k);
     fflush(stdout);
-    #endif
 
-    // Loop principale del merge: confronta elementi dalle due sezioni sorgente
+    // Build di debug: loop di riferimento elemento per elemento, con asserzioni
+    // e stampe a ogni scrittura. Loop principale del merge: confronta elementi dalle due sezioni sorgente
     // e copia il minore nell'array destinazione. Continua finché ci sono elementi
     // in entrambe le sezioni.
     while ( (num_elements1 > 0 && i <= end1) && (num_elements2 > 0 && j <= end2) ) {
@@ -144,15 +154,13 @@ void merge_sections(int *source, int *dest,
             val_to_write = val_j;
             j++; // Avanza l'indice per la seconda sezione
         }
-        #if DEBUG
         // Stampa di debug per tracciare quale valore viene scritto e da dove proviene
-        printf("[MERGE_SECTIONS LOOP s1=%d] k_write=%d: Scrivo %d (da src_i=%d o src_j=%d). Prox i=%d,j=%d\n",
+        printf("[MERGE_SECTIONS LOOP s1=%ld] k_write=%ld: Scrivo %d (da src_i=%d o src_j=%d). Prox i=%ld,j=%ld\n",
                start1, k, val_to_write, 
                (val_to_write == val_i && i > start1) ? source[i-1] : ( (val_to_write == val_i) ? val_i : -1 ), // Logica complessa per stampare il valore letto
                (val_to_write == val_j && j > start2) ? source[j-1] : ( (val_to_write == val_j) ? val_j : -1 ),
                i, j);
         fflush(stdout);
-        #endif
         dest[k++] = val_to_write; // Scrive il valore scelto in dest e avanza k
     }
 
@@ -161,9 +169,7 @@ void merge_sections(int *source, int *dest,
     while (num_elements1 > 0 && i <= end1) {
         assert(k >= start1 && k <= expected_end_k);
         assert(i >= start1 && i <= end1);
-        #if DEBUG
-        printf("[MERGE_SECTIONS REM1 s1=%d] k_write=%d: Scrivo %d (da src[%d])\n", start1, k, source[i], i); fflush(stdout);
-        #endif
+        printf("[MERGE_SECTIONS REM1 s1=%ld] k_write=%ld: Scrivo %d (da src[%ld])\n", start1, k, source[i], i); fflush(stdout);
         dest[k++] = source[i++];
     }
 
@@ -171,11 +177,14 @@ void merge_sections(int *source, int *dest,
     while (num_elements2 > 0 && j <= end2) {
         assert(k >= start1 && k <= expected_end_k);
         assert(j >= start2 && j <= end2);
-        #if DEBUG
-        printf("[MERGE_SECTIONS REM2 s1=%d] k_write=%d: Scrivo %d (da src[%d])\n", start1, k, source[j], j); fflush(stdout);
-        #endif
+        printf("[MERGE_SECTIONS REM2 s1=%ld] k_write=%ld: Scrivo %d (da src[%ld])\n", start1, k, source[j], j); fflush(stdout);
         dest[k++] = source[j++];
     }
+    #else
+    // Percorso veloce (DEBUG = 0): kernel branchless/AVX2 di sortkernel.c.
+    merge_int(&source[i], num_elements1, &source[j], num_elements2, &dest[k]);
+    k += num_elements1 + num_elements2;
+    #endif
 
     // Verifica finale: l'indice k dovrebbe ora puntare all'elemento successivo
     // all'ultimo elemento scritto.
@@ -187,7 +196,7 @@ void merge_sections(int *source, int *dest,
 
     #if DEBUG
     // Stampa il contenuto della sezione di destinazione dopo il merge
-    printf("[MERGE_SECTIONS EXIT s1=%d] Contenuto finale di dest[%d...%ld]: ", start1, start1, expected_end_k);
+    printf("[MERGE_SECTIONS EXIT s1=%ld] Contenuto finale di dest[%ld...%ld]: ", start1, start1, expected_end_k);
     if(num_elements1 + num_elements2 > 0 && start1 >=0 && expected_end_k < N_total) {
         for(long x_dbg=start1; x_dbg <= expected_end_k; ++x_dbg) printf("%d ", dest[x_dbg]);
     } else {
@@ -198,6 +207,196 @@ void merge_sections(int *source, int *dest,
     #endif
 }
 
+/**
+ * @brief Indice di inizio della partizione originale 'i' (i >= 0).
+ *
+ * Replica la suddivisione della Fase 1: le prime N % P partizioni hanno un
+ * elemento in più. Per i >= P vale N: con P non potenza di 2 l'albero dei merge
+ * ha blocchi che "sporgono" oltre l'ultima partizione, e vanno trattati come vuoti.
+ */
+long partition_start(long N, int P, long i) {
+    if (i >= P) return N;
+    long chunk = N / P;
+    long rem = N % P;
+    return i * chunk + (i < rem ? i : rem);
+}
+
+/**
+ * @brief Calcola il co-rank di una posizione di output del merge di due run.
+ *
+ * Il merge di a[0..na) e b[0..nb) produce na + nb elementi; i primi 'd' sono
+ * formati da a[0..i) e b[0..d-i) per un unico i. La ricerca binaria trova il
+ * più piccolo i tale che a[i] > b[d-i-1] (oppure i == na o d-i == 0), cioè
+ * il punto in cui prendere un altro elemento di 'a' violerebbe l'ordine.
+ * A parità di valore gli elementi di 'a' precedono quelli di 'b', come in
+ * merge_sections. Costo O(log(min(na, nb))).
+ *
+ * @param d Numero di elementi di output (0 <= d <= na + nb).
+ * @param a Primo run ordinato.
+ * @param na Lunghezza del primo run.
+ * @param b Secondo run ordinato.
+ * @param nb Lunghezza del secondo run.
+ * @return Numero di elementi di 'a' tra i primi 'd' dell'output.
+ */
+long co_rank(long d, const int *a, long na, const int *b, long nb) {
+    assert(d >= 0 && d <= na + nb);
+    long lo = (d > nb) ? d - nb : 0; // Servono almeno d - nb elementi da 'a'
+    long hi = (d < na) ? d : na;     // E non più di min(d, na)
+
+    while (lo < hi) {
+        long i = lo + (hi - lo) / 2; // i < hi <= na, quindi a[i] è valido
+        long j = d - i;              // j >= 1 perché i < hi <= d
+        if (a[i] <= b[j - 1]) {
+            lo = i + 1; // a[i] precede b[j-1]: servono più elementi di 'a'
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Calcola gli splitter di una posizione di output del merge P-way.
+ *
+ * Cerca con una ricerca binaria sui valori il più piccolo v tale che almeno
+ * 'd' elementi siano <= v. Da ogni run si prendono tutti gli elementi < v, poi
+ * gli elementi pari a v mancanti per arrivare a 'd', dal run 0 in avanti:
+ * lo stesso criterio di stabilità del loser tree, così le fette calcolate da
+ * worker diversi combaciano esattamente. Costo O(32 * k * log(n)).
+ *
+ * @param runs Puntatori ai k run ordinati.
+ * @param lens Lunghezze dei run.
+ * @param k Numero di run.
+ * @param d Posizione di output (0 <= d <= somma delle lunghezze).
+ * @param pos Output: per ogni run, il numero di elementi tra i primi 'd'.
+ */
+void kway_split(const int *const *runs, const long *lens, int k, long d, long *pos) {
+    if (d == 0) {
+        for (int r = 0; r < k; ++r) pos[r] = 0;
+        return;
+    }
+
+    // Ricerca binaria del più piccolo valore v con count(<= v) >= d
+    long long lo = INT_MIN, hi = INT_MAX;
+    while (lo < hi) {
+        long long mid = lo + (hi - lo) / 2;
+        long count_le = 0;
+        for (int r = 0; r < k; ++r) {
+            // upper_bound di mid nel run r
+            long a = 0, b = lens[r];
+            while (a < b) {
+                long m = a + (b - a) / 2;
+                if (runs[r][m] <= mid) a = m + 1; else b = m;
+            }
+            count_le += a;
+        }
+        if (count_le >= d) hi = mid; else lo = mid + 1;
+    }
+    int v = (int)lo;
+
+    // Prende tutti gli elementi < v, poi distribuisce i pari a v in ordine di run
+    long taken = 0;
+    for (int r = 0; r < k; ++r) {
+        long a = 0, b = lens[r];
+        while (a < b) { // lower_bound di v
+            long m = a + (b - a) / 2;
+            if (runs[r][m] < v) a = m + 1; else b = m;
+        }
+        pos[r] = a;
+        taken += a;
+    }
+    for (int r = 0; r < k && taken < d; ++r) {
+        long a = pos[r], b = lens[r];
+        while (a < b) { // upper_bound di v: gli elementi pari a v sono in [pos[r], a)
+            long m = a + (b - a) / 2;
+            if (runs[r][m] <= v) a = m + 1; else b = m;
+        }
+        long equal = a - pos[r];
+        if (equal > d - taken) equal = d - taken;
+        pos[r] += equal;
+        taken += equal;
+    }
+    assert(taken == d);
+}
+
+/**
+ * @brief Confronto tra le teste di due run del loser tree.
+ * @return 1 se il run 'x' deve uscire prima del run 'y'. Un run esaurito perde
+ * sempre; a parità di valore vince il run con indice minore (merge stabile).
+ */
+static int kway_before(const int *const *runs, const long *lens, const long *cur, int k, int x, int y) {
+    int x_done = (x >= k || cur[x] >= lens[x]);
+    int y_done = (y >= k || cur[y] >= lens[y]);
+    if (x_done) return 0;
+    if (y_done) return 1;
+    int vx = runs[x][cur[x]];
+    int vy = runs[y][cur[y]];
+    return vx < vy || (vx == vy && x < y);
+}
+
+/**
+ * @brief Merge P-way di k run ordinati tramite loser tree.
+ *
+ * L'albero ha K foglie (K = prima potenza di 2 >= k; le foglie in eccesso sono
+ * run vuoti). Ogni nodo interno conserva il perdente del confronto tra i due
+ * sottoalberi, tree[0] il vincitore globale. Dopo ogni estrazione si risale
+ * solo il cammino dalla foglia del vincitore alla radice: log2(K) confronti per
+ * elemento, e ogni elemento viene letto e scritto una sola volta.
+ *
+ * @param runs Puntatori ai k run ordinati.
+ * @param lens Lunghezze dei run.
+ * @param k Numero di run (k >= 1).
+ * @param out Destinazione (somma delle lunghezze elementi).
+ */
+void kway_merge(const int *const *runs, const long *lens, int k, int *out) {
+    int K = 1;
+    while (K < k) K <<= 1;
+
+    long total = 0;
+    for (int r = 0; r < k; ++r) total += lens[r];
+    if (total == 0) return;
+
+    long *cur = calloc(k, sizeof(long)); // Prossimo elemento da leggere per ogni run
+    int *tree = malloc(K * sizeof(int)); // tree[0] vincitore, tree[1..K-1] perdenti dei nodi interni
+    CHECK_ERR(cur == NULL || tree == NULL, "kway_merge: Errore allocazione loser tree");
+
+    // Costruzione bottom-up: i vincitori parziali (array di appoggio 'winner',
+    // foglie in winner[K..2K-1]) salgono, i perdenti restano nel nodo.
+    int *winner = malloc(2 * K * sizeof(int));
+    CHECK_ERR(winner == NULL, "kway_merge: Errore allocazione loser tree");
+    for (int i = 0; i < K; ++i) winner[K + i] = i;
+    for (int node = K - 1; node >= 1; --node) {
+        int l = winner[2 * node];
+        int r = winner[2 * node + 1];
+        if (kway_before(runs, lens, cur, k, l, r)) {
+            winner[node] = l;
+            tree[node] = r;
+        } else {
+            winner[node] = r;
+            tree[node] = l;
+        }
+    }
+    tree[0] = winner[1];
+    free(winner);
+
+    for (long o = 0; o < total; ++o) {
+        int w = tree[0];
+        out[o] = runs[w][cur[w]++];
+        // Risale dalla foglia del vincitore: a ogni nodo il nuovo candidato sfida il perdente salvato
+        for (int node = (K + w) >> 1; node >= 1; node >>= 1) {
+            if (kway_before(runs, lens, cur, k, tree[node], w)) {
+                int tmp = tree[node];
+                tree[node] = w;
+                w = tmp;
+            }
+        }
+        tree[0] = w;
+    }
+
+    free(tree);
+    free(cur);
+}
+
 /**
  * @brief Stampa il contenuto dell'array (o una sua parte) a schermo.
  *
@@ -241,4 +440,36 @@ void print_array(const char *label, int *arr, long n) {
     }
     printf("\n-------------------------\n");
     fflush(stdout); // Assicura che l'output sia visibile immediatamente (utile per pipe o redirect)
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Allocazione azzerata allineata alla linea di cache (vedi myutils.h).
+ *
+ * aligned_alloc richiede una dimensione multipla dell'allineamento: la
+ * richiesta viene arrotondata alla linea di cache successiva.
+ */
+void *cache_aligned_calloc(size_t n, size_t size) {
+    if (size != 0 && n > (size_t)-1 / size - CACHE_LINE_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size_t bytes = (n * size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    if (bytes == 0) bytes = CACHE_LINE_SIZE;
+    void *p = aligned_alloc(CACHE_LINE_SIZE, bytes);
+    if (p != NULL) memset(p, 0, bytes);
+    return p;
+}
+
+/**
+ * @brief Restituisce il tempo corrente del clock monotono in millisecondi.
+ *
+ * CLOCK_MONOTONIC non subisce salti dovuti a modifiche dell'orario di sistema,
+ * quindi la differenza tra due chiamate misura correttamente un intervallo.
+ *
+ * @return Istante corrente in millisecondi (con parte frazionaria).
+ */
+double get_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
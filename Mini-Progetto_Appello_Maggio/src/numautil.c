@@ -0,0 +1,170 @@
+/**
+ * @file numautil.c
+ * @brief Utilità NUMA basate solo su sysfs e syscall Linux (nessuna dipendenza da libnuma).
+ *
+ * - Topologia: i nodi e le loro CPU sono letti da /sys/devices/system/node.
+ * - Allocazione: con NUMA_FIRST_TOUCH la memoria è una mappatura anonima le cui
+ * pagine finiscono sul nodo del primo thread che le scrive (politica di default
+ * del kernel), con NUMA_INTERLEAVE la mappatura riceve mbind(MPOL_INTERLEAVE).
+ * - Pinning: sched_setaffinity sul thread chiamante.
+ * - Interrogazione: move_pages con nodes == NULL restituisce il nodo di ogni pagina.
+ */
+
+#define _GNU_SOURCE // Per sched_getaffinity, CPU_SET, syscall
+
+#include <stdlib.h>   // Per malloc, free, strtol
+#include <stdint.h>   // Per uintptr_t
+#include <string.h>   // Per strncmp
+#include <dirent.h>   // Per opendir, readdir
+#include <sched.h>    // Per sched_getaffinity, sched_setaffinity
+#include <unistd.h>   // Per syscall, sysconf
+#include <sys/mman.h> // Per mmap, munmap
+#include <sys/syscall.h>       // Per SYS_mbind, SYS_move_pages, SYS_getcpu
+#include <linux/mempolicy.h>   // Per MPOL_INTERLEAVE
+
+#include "numautil.h"
+
+#define NUMA_MAX_NODES 64 // Nodi considerati (una sola parola di nodemask)
+
+/**
+ * @brief Legge la lista di CPU del nodo 'node' (formato "0-3,8-11") in 'set'.
+ * @return 0 in caso di successo, -1 se il nodo non esiste.
+ */
+static int read_node_cpus(int node, cpu_set_t *set) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[4096];
+    CPU_ZERO(set);
+    if (fgets(line, sizeof(line), f) != NULL) {
+        char *p = line;
+        while (*p != '\0' && *p != '\n') {
+            long lo = strtol(p, &p, 10);
+            long hi = lo;
+            if (*p == '-') hi = strtol(p + 1, &p, 10);
+            for (long c = lo; c <= hi && c < CPU_SETSIZE; ++c) CPU_SET(c, set);
+            if (*p == ',') p++;
+            else break;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+/**
+ * @brief Conta i nodi online (vedi numautil.h).
+ */
+int numa_count_nodes(void) {
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (dir == NULL) return 1;
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return (count > 0) ? count : 1;
+}
+
+/**
+ * @brief Nodo della CPU corrente (vedi numautil.h).
+ */
+int numa_node_of_current_cpu(void) {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return 0;
+    return (int)node;
+}
+
+/**
+ * @brief Alloca un buffer secondo la politica (vedi numautil.h).
+ */
+void *numa_alloc_buffer(size_t bytes, NumaPolicy policy) {
+    if (policy == NUMA_MALLOC) return malloc(bytes);
+
+    void *buf = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) return NULL;
+    if (policy == NUMA_INTERLEAVE) {
+        int nodes = numa_count_nodes();
+        if (nodes > NUMA_MAX_NODES) nodes = NUMA_MAX_NODES;
+        unsigned long mask = (nodes == NUMA_MAX_NODES) ? ~0UL : (1UL << nodes) - 1;
+        // Su un solo nodo (o senza supporto NUMA nel kernel) l'interleave non cambia nulla
+        if (syscall(SYS_mbind, buf, bytes, MPOL_INTERLEAVE, &mask, (unsigned long)NUMA_MAX_NODES + 1, 0) != 0) {
+            DEBUG_PRINT_GEN("mbind(MPOL_INTERLEAVE) non riuscita: uso la politica di default.");
+        }
+    }
+    return buf;
+}
+
+/**
+ * @brief Libera un buffer di numa_alloc_buffer (vedi numautil.h).
+ */
+void numa_free_buffer(void *buf, size_t bytes, NumaPolicy policy) {
+    if (buf == NULL) return;
+    if (policy == NUMA_MALLOC) free(buf);
+    else munmap(buf, bytes);
+}
+
+/**
+ * @brief Restituisce la k-esima CPU (da 0) presente in 'set', o -1 se ce ne sono meno di k+1.
+ */
+static int nth_cpu(const cpu_set_t *set, int k) {
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, set) && k-- == 0) return c;
+    }
+    return -1;
+}
+
+/**
+ * @brief Fissa il thread chiamante a una CPU, a turno sui nodi (vedi numautil.h).
+ *
+ * Le CPU permesse sono raggruppate per nodo; l'indice 'index' sceglie il nodo
+ * index % nodi e, in quel nodo, la CPU (index / nodi) % CPU_del_nodo. Se la
+ * topologia non è leggibile si usa la index-esima CPU permessa. Ogni nodo è
+ * tenuto come cpu_set_t, quindi sono usate tutte le sue CPU, anche oltre 64.
+ */
+int numa_pin_thread(int index) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return -1;
+
+    cpu_set_t node_set[NUMA_MAX_NODES]; // CPU permesse di ogni nodo con almeno una CPU permessa
+    int node_ncpus[NUMA_MAX_NODES];
+    int n_nodes = 0;
+    for (int node = 0; node < NUMA_MAX_NODES; ++node) {
+        cpu_set_t set;
+        if (read_node_cpus(node, &set) != 0) continue;
+        CPU_AND(&node_set[n_nodes], &set, &allowed);
+        int n = CPU_COUNT(&node_set[n_nodes]);
+        if (n > 0) node_ncpus[n_nodes++] = n;
+    }
+
+    int cpu;
+    if (n_nodes > 0) {
+        int node = index % n_nodes;
+        cpu = nth_cpu(&node_set[node], (index / n_nodes) % node_ncpus[node]);
+    } else {
+        cpu = nth_cpu(&allowed, index % CPU_COUNT(&allowed));
+    }
+    if (cpu < 0) return -1;
+
+    cpu_set_t target;
+    CPU_ZERO(&target);
+    CPU_SET(cpu, &target);
+    return (sched_setaffinity(0, sizeof(target), &target) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Nodo di ciascuna pagina (vedi numautil.h).
+ */
+int numa_query_pages(const void *addr, long count, int *nodes) {
+    long page = sysconf(_SC_PAGESIZE);
+    void **pages = malloc(count * sizeof(void *));
+    CHECK_ERR(pages == NULL, "numa_query_pages: Errore allocazione");
+    uintptr_t base = (uintptr_t)addr & ~(uintptr_t)(page - 1);
+    for (long i = 0; i < count; ++i) pages[i] = (void *)(base + i * page);
+    long ret = syscall(SYS_move_pages, 0, (unsigned long)count, pages, NULL, nodes, 0);
+    free(pages);
+    return (ret == 0) ? 0 : -1;
+}
@@ -0,0 +1,580 @@
+/**
+ * @file psort.c
+ * @brief Contesto riusabile per l'ordinamento parallelo (pool di thread persistente).
+ *
+ * psort_create crea P thread che restano in attesa di un nuovo ordinamento su
+ * `start_cond`. psort_sort_int prepara i ThreadArgs per i buffer del chiamante,
+ * riapre la coda, incrementa `generation` e sveglia il pool; ogni thread esegue
+ * worker_thread (identico al programma standalone) e decrementa `pending`,
+ * l'ultimo segnala `done_cond` al chiamante. In questo modo il costo di
+ * pthread_create/pthread_join e delle allocazioni di array temporaneo,
+ * coda, barriera e istogrammi è pagato una volta per contesto e non per
+ * ogni array ordinato. psort_sort_records usa lo stesso pool per i record
+ * a chiave int64_t (recsort.h): cambia solo il kernel passato ai worker.
+ * Lo stesso meccanismo di risveglio (dispatch) esegue anche lavori diversi
+ * dall'ordinamento: pinning dei thread, first-touch dei buffer per NUMA e
+ * cicli paralleli generici (psort_parallel_for).
+ */
+
+#include <stdlib.h> // Per malloc, realloc, free
+#include <stdint.h> // Per uintptr_t
+#include <string.h> // Per memset, strerror
+#include <unistd.h> // Per sysconf
+
+#include "psort.h"   // Contiene la dichiarazione dell'API
+#include "queue.h"   // Contiene ConcurrentQueue e le sue operazioni
+#include "worker.h"  // Contiene worker_thread
+#include "recsort.h" // Contiene RecordKernel
+#include "myutils.h" // Contiene partition_start, get_time_ms
+#include "numautil.h" // Contiene numa_pin_thread, numa_query_pages
+#include "trace.h"    // Contiene WorkerTrace e le funzioni di misura
+#include "eventlog.h" // Contiene EventRing e le funzioni del registro eventi
+#include "steal.h"    // Contiene WorkStealer e le funzioni dei deque
+#include "runs.h"     // Contiene runs_sort_int
+#include "intsort.h"  // Contiene SAMPLE_HIST_STRIDE
+#include "spinbarrier.h" // Contiene SpinBarrier
+
+// Lavoro eseguito dal thread 'index' del pool a ogni risveglio.
+typedef void (*PoolJob)(psort_context *ctx, int index);
+
+// Slot del pool: il thread 'index' del contesto 'ctx'.
+typedef struct {
+    psort_context *ctx;
+    int index;
+} PoolSlot;
+
+struct psort_context {
+    int n_threads;                  // Numero di worker (P)
+    SortMode sort_mode;             // Algoritmo di ordinamento (come -s)
+    MergeMode merge_mode;           // Strategia di merge (come -m)
+    int adaptive;                   // 1 se psort_sort_int cerca prima i run naturali
+    pthread_t *threads;             // Thread del pool
+    PoolSlot *slots;                // Argomenti dei thread del pool
+    ThreadArgs *thread_args;        // Argomenti di worker_thread, aggiornati ad ogni ordinamento
+    ConcurrentQueue queue;          // Coda dei task, riaperta ad ogni ordinamento
+    WorkStealer stealer;            // Deque di work stealing (solo -s qsort, deques NULL altrimenti)
+    SpinBarrier barrier;            // Barriera dei P worker (spin-then-block)
+    pthread_mutex_t merge_mutex;    // Mutex di merge (solo -m serial)
+    pthread_mutex_t copy_mutex;     // Mutex di copia (solo -m serial)
+    long *histograms;               // Istogrammi per -s radix / -s sample (NULL con -s qsort)
+    int *splitters;                 // Splitter per -s sample (NULL con -s qsort)
+    void *scratch;                  // Buffer temporaneo interno (usato se il chiamante passa NULL)
+    size_t scratch_bytes;           // Capacità di 'scratch' in byte
+    double merge_time_ms;           // Durata del merge dell'ultimo ordinamento
+    WorkerTrace *traces;            // Misura per fase di ogni worker (NULL se disattivata)
+    EventRing *event_rings;         // Registro eventi di ogni worker (NULL se disattivato)
+    int *thread_node;               // Nodo NUMA di ogni thread (-1 se non ancora noto)
+    int pin_failed;                 // 1 se almeno un thread non è stato fissato alla sua CPU
+    char *touch_buf;                // Buffer da toccare in psort_first_touch
+    long touch_n;                   // Elementi di touch_buf
+    size_t touch_elem_size;         // Dimensione di un elemento di touch_buf
+    PsortRangeFn range_fn;          // Funzione di psort_parallel_for
+    void *range_arg;                // Argomento di range_fn
+    long range_n;                   // Estensione dell'intervallo diviso tra i thread
+
+    PoolJob job;                    // Lavoro del risveglio corrente
+    pthread_mutex_t pool_mutex;     // Protegge job, generation, pending, shutdown e pin_failed
+    pthread_cond_t start_cond;      // Segnalata quando c'è un nuovo ordinamento (o lo shutdown)
+    pthread_cond_t done_cond;       // Segnalata dall'ultimo worker che termina l'ordinamento
+    unsigned long generation;       // Numero dell'ordinamento corrente
+    int pending;                    // Worker che non hanno ancora finito l'ordinamento corrente
+    int shutdown;                   // 1 se i thread del pool devono terminare
+};
+
+/**
+ * @brief Ciclo di vita di un thread del pool.
+ *
+ * Attende che 'generation' cambi, esegue il lavoro corrente (worker_thread sui
+ * ThreadArgs preparati da psort_sort_int, oppure pinning o first-touch) e
+ * segnala il completamento. Termina quando psort_destroy imposta 'shutdown'.
+ */
+static void *pool_thread(void *args) {
+    PoolSlot *slot = (PoolSlot *)args;
+    psort_context *ctx = slot->ctx;
+    unsigned long seen = 0; // Ultimo ordinamento eseguito da questo thread
+
+    for (;;) {
+        pthread_mutex_lock(&ctx->pool_mutex);
+        while (ctx->generation == seen && !ctx->shutdown) {
+            pthread_cond_wait(&ctx->start_cond, &ctx->pool_mutex);
+        }
+        if (ctx->shutdown) {
+            pthread_mutex_unlock(&ctx->pool_mutex);
+            break;
+        }
+        seen = ctx->generation;
+        PoolJob job = ctx->job;
+        pthread_mutex_unlock(&ctx->pool_mutex);
+
+        job(ctx, slot->index);
+
+        pthread_mutex_lock(&ctx->pool_mutex);
+        if (--ctx->pending == 0) {
+            pthread_cond_signal(&ctx->done_cond);
+        }
+        pthread_mutex_unlock(&ctx->pool_mutex);
+    }
+    DEBUG_PRINT(slot->index, "Thread del pool in terminazione.");
+    return NULL;
+}
+
+// Primitive di sincronizzazione create da psort_create, nell'ordine di creazione:
+// psort_release ne distrugge le prime 'n_inited'.
+enum {
+    CTX_INIT_QUEUE = 1,
+    CTX_INIT_BARRIER,
+    CTX_INIT_MERGE_MUTEX,
+    CTX_INIT_COPY_MUTEX,
+    CTX_INIT_POOL_MUTEX,
+    CTX_INIT_START_COND,
+    CTX_INIT_DONE_COND,
+    CTX_INIT_ALL = CTX_INIT_DONE_COND
+};
+
+/**
+ * @brief Termina i primi 'n_started' thread del pool e attende la loro uscita.
+ */
+static void stop_pool(psort_context *ctx, int n_started) {
+    pthread_mutex_lock(&ctx->pool_mutex);
+    ctx->shutdown = 1;
+    pthread_cond_broadcast(&ctx->start_cond);
+    pthread_mutex_unlock(&ctx->pool_mutex);
+    for (int i = 0; i < n_started; ++i) {
+        pthread_join(ctx->threads[i], NULL);
+    }
+}
+
+/**
+ * @brief Distrugge le prime 'n_inited' primitive (vedi CTX_INIT_*) e libera il
+ * contesto con tutti i suoi buffer. I thread del pool devono essere già terminati.
+ *
+ * Usata da psort_destroy e da psort_create per disfare una creazione fallita a
+ * metà: i puntatori non ancora allocati sono NULL (contesto azzerato).
+ */
+static void psort_release(psort_context *ctx, int n_inited) {
+    if (ctx->traces != NULL) {
+        for (int i = 0; i < ctx->n_threads; ++i) trace_close(&ctx->traces[i]);
+        free(ctx->traces);
+    }
+    free(ctx->event_rings);
+    if (n_inited >= CTX_INIT_QUEUE) destroy_queue(&ctx->queue);
+    steal_destroy(&ctx->stealer); // Nessun effetto se i deque non sono stati allocati
+    if (n_inited >= CTX_INIT_BARRIER) spin_barrier_destroy(&ctx->barrier);
+    if (n_inited >= CTX_INIT_MERGE_MUTEX) pthread_mutex_destroy(&ctx->merge_mutex);
+    if (n_inited >= CTX_INIT_COPY_MUTEX) pthread_mutex_destroy(&ctx->copy_mutex);
+    if (n_inited >= CTX_INIT_POOL_MUTEX) pthread_mutex_destroy(&ctx->pool_mutex);
+    if (n_inited >= CTX_INIT_START_COND) pthread_cond_destroy(&ctx->start_cond);
+    if (n_inited >= CTX_INIT_DONE_COND) pthread_cond_destroy(&ctx->done_cond);
+    free(ctx->scratch);
+    free(ctx->histograms);
+    free(ctx->splitters);
+    free(ctx->thread_args);
+    free(ctx->thread_node);
+    free(ctx->slots);
+    free(ctx->threads);
+    free(ctx);
+}
+
+/**
+ * @brief Crea un contesto e avvia i suoi P thread (vedi psort.h).
+ *
+ * Ogni errore disfa quanto già creato (thread avviati, primitive, buffer) e
+ * restituisce NULL: il processo che usa la libreria non viene terminato.
+ */
+psort_context *psort_create(int n_threads, SortMode sort_mode, MergeMode merge_mode) {
+    if (n_threads <= 0 || sort_mode < 0 || sort_mode >= SORT_MODE_COUNT ||
+        merge_mode < 0 || merge_mode >= MERGE_MODE_COUNT) {
+        fprintf(stderr, "psort_create: argomenti non validi (P=%d).\n", n_threads);
+        return NULL;
+    }
+
+    // Allineato alla linea di cache: il contesto contiene la barriera e la coda, con campi _Alignas
+    psort_context *ctx = cache_aligned_calloc(1, sizeof(psort_context));
+    if (ctx == NULL) {
+        perror("psort_create: Errore allocazione contesto");
+        return NULL;
+    }
+    int p = n_threads;
+    ctx->n_threads = p;
+    ctx->sort_mode = sort_mode;
+    ctx->merge_mode = merge_mode;
+    ctx->adaptive = 1;
+    ctx->threads = malloc(p * sizeof(pthread_t));
+    ctx->slots = malloc(p * sizeof(PoolSlot));
+    ctx->thread_args = cache_aligned_calloc(p, sizeof(ThreadArgs));
+    ctx->thread_node = malloc(p * sizeof(int));
+    if (ctx->threads == NULL || ctx->slots == NULL || ctx->thread_args == NULL || ctx->thread_node == NULL) {
+        perror("psort_create: Errore allocazione argomenti dei thread");
+        psort_release(ctx, 0);
+        return NULL;
+    }
+    for (int i = 0; i < p; ++i) ctx->thread_node[i] = -1;
+    if (sort_mode != SORT_QSORT) {
+        // Riga: 256 cifre (radix) o P bucket a passo SAMPLE_HIST_STRIDE (sample), righe su linee distinte
+        long hist_row = (SAMPLE_HIST_STRIDE(p) > 256) ? SAMPLE_HIST_STRIDE(p) : 256;
+        ctx->histograms = cache_aligned_calloc((long)p * hist_row, sizeof(long));
+        ctx->splitters = malloc(p * sizeof(int));
+        if (ctx->histograms == NULL || ctx->splitters == NULL) {
+            perror("psort_create: Errore allocazione istogrammi");
+            psort_release(ctx, 0);
+            return NULL;
+        }
+    }
+
+    // Al più un task per partizione o bucket: a regime la coda non alloca mai
+    if (init_queue(&ctx->queue, p) != 0) {
+        fprintf(stderr, "psort_create: Errore inizializzazione coda\n");
+        psort_release(ctx, 0);
+        return NULL;
+    }
+    if (sort_mode == SORT_QSORT && steal_init(&ctx->stealer, p) != 0) {
+        fprintf(stderr, "psort_create: Errore inizializzazione deque di work stealing\n");
+        psort_release(ctx, CTX_INIT_QUEUE);
+        return NULL;
+    }
+    // Ogni passo parte solo se il precedente è riuscito; n_inited conta le primitive create
+    int n_inited = CTX_INIT_QUEUE;
+    const char *what = "spin_barrier_init";
+    int err = spin_barrier_init(&ctx->barrier, p);
+    if (err == 0) {
+        n_inited = CTX_INIT_BARRIER;
+        what = "pthread_mutex_init (merge)";
+        err = pthread_mutex_init(&ctx->merge_mutex, NULL);
+    }
+    if (err == 0) {
+        n_inited = CTX_INIT_MERGE_MUTEX;
+        what = "pthread_mutex_init (copia)";
+        err = pthread_mutex_init(&ctx->copy_mutex, NULL);
+    }
+    if (err == 0) {
+        n_inited = CTX_INIT_COPY_MUTEX;
+        what = "pthread_mutex_init (pool)";
+        err = pthread_mutex_init(&ctx->pool_mutex, NULL);
+    }
+    if (err == 0) {
+        n_inited = CTX_INIT_POOL_MUTEX;
+        what = "pthread_cond_init (start)";
+        err = pthread_cond_init(&ctx->start_cond, NULL);
+    }
+    if (err == 0) {
+        n_inited = CTX_INIT_START_COND;
+        what = "pthread_cond_init (done)";
+        err = pthread_cond_init(&ctx->done_cond, NULL);
+    }
+    if (err != 0) {
+        fprintf(stderr, "psort_create: Errore %s: %s\n", what, strerror(err));
+        psort_release(ctx, n_inited);
+        return NULL;
+    }
+
+    for (int i = 0; i < p; ++i) {
+        ctx->slots[i].ctx = ctx;
+        ctx->slots[i].index = i;
+        err = pthread_create(&ctx->threads[i], NULL, pool_thread, &ctx->slots[i]);
+        if (err != 0) {
+            fprintf(stderr, "psort_create: Errore creazione thread del pool: %s\n", strerror(err));
+            stop_pool(ctx, i);
+            psort_release(ctx, CTX_INIT_ALL);
+            return NULL;
+        }
+    }
+    DEBUG_PRINT_GEN("Contesto creato con %d thread.", p);
+    return ctx;
+}
+
+/**
+ * @brief Restituisce un buffer temporaneo di almeno 'bytes' byte: quello del
+ * chiamante se fornito, altrimenti il buffer interno (ingrandito se serve).
+ * @return Il buffer, NULL se non è stato possibile ingrandirlo (il buffer
+ * interno precedente resta valido e viene liberato da psort_destroy).
+ */
+static void *scratch_buffer(psort_context *ctx, void *scratch, size_t bytes) {
+    if (scratch != NULL) return scratch;
+    if (ctx->scratch_bytes < bytes) {
+        void *grown = realloc(ctx->scratch, bytes);
+        if (grown == NULL) {
+            fprintf(stderr, "psort: Errore allocazione buffer temporaneo (%zu byte)\n", bytes);
+            return NULL;
+        }
+        ctx->scratch = grown;
+        ctx->scratch_bytes = bytes;
+    }
+    return ctx->scratch;
+}
+
+/**
+ * @brief Sveglia il pool perché ogni thread esegua 'job' e attende che tutti abbiano terminato.
+ *
+ * Tutto ciò che il chiamante ha scritto nel contesto prima della chiamata
+ * (ThreadArgs, buffer da toccare) è pubblicato ai thread dal pool_mutex.
+ */
+static void dispatch(psort_context *ctx, PoolJob job) {
+    pthread_mutex_lock(&ctx->pool_mutex);
+    ctx->job = job;
+    ctx->pending = ctx->n_threads;
+    ctx->generation++;
+    pthread_cond_broadcast(&ctx->start_cond);
+    while (ctx->pending > 0) {
+        pthread_cond_wait(&ctx->done_cond, &ctx->pool_mutex);
+    }
+    pthread_mutex_unlock(&ctx->pool_mutex);
+}
+
+/**
+ * @brief Lavoro di ordinamento: la funzione worker_thread del programma standalone.
+ */
+static void sort_job(psort_context *ctx, int index) {
+    worker_thread(&ctx->thread_args[index]);
+}
+
+/**
+ * @brief Lavoro di pinning: fissa il thread alla sua CPU e ne registra il nodo.
+ */
+static void pin_job(psort_context *ctx, int index) {
+    if (numa_pin_thread(index) != 0) {
+        pthread_mutex_lock(&ctx->pool_mutex);
+        ctx->pin_failed = 1;
+        pthread_mutex_unlock(&ctx->pool_mutex);
+    }
+    ctx->thread_node[index] = numa_node_of_current_cpu();
+}
+
+/**
+ * @brief Lavoro di first-touch: azzera la fetta [partition_start(index), partition_start(index+1))
+ * di touch_buf, così le sue pagine sono assegnate al nodo del thread.
+ */
+static void touch_job(psort_context *ctx, int index) {
+    long lo = partition_start(ctx->touch_n, ctx->n_threads, index);
+    long hi = partition_start(ctx->touch_n, ctx->n_threads, index + 1);
+    if (hi > lo) memset(ctx->touch_buf + lo * ctx->touch_elem_size, 0, (hi - lo) * ctx->touch_elem_size);
+    ctx->thread_node[index] = numa_node_of_current_cpu();
+}
+
+/**
+ * @brief Lavoro di psort_parallel_for: range_fn sulla fetta del thread.
+ */
+static void range_job(psort_context *ctx, int index) {
+    long lo = partition_start(ctx->range_n, ctx->n_threads, index);
+    long hi = partition_start(ctx->range_n, ctx->n_threads, index + 1);
+    ctx->range_fn(ctx->range_arg, index, lo, hi);
+}
+
+/**
+ * @brief Prepara i ThreadArgs per un ordinamento di n elementi, sveglia il pool
+ * e attende che tutti i worker abbiano terminato.
+ *
+ * Per gli int 'kernel' è NULL e i buffer sono passati in array/temp_array;
+ * per i record sono passati in records/temp_records.
+ */
+static void run_pool(psort_context *ctx, const RecordKernel *kernel, void *data, void *scratch, long n) {
+    for (int i = 0; i < ctx->n_threads; ++i) {
+        ThreadArgs *a = &ctx->thread_args[i];
+        a->thread_id = i;
+        a->array = (kernel == NULL) ? data : NULL;
+        a->temp_array = (kernel == NULL) ? scratch : NULL;
+        a->n_elements = n;
+        a->n_threads = ctx->n_threads;
+        a->queue = &ctx->queue;
+        a->stealer = &ctx->stealer;
+        a->barrier = &ctx->barrier;
+        a->merge_mutex_ptr = &ctx->merge_mutex;
+        a->copy_phase_mutex_ptr = &ctx->copy_mutex;
+        a->merge_mode = ctx->merge_mode;
+        a->merge_time_ms_ptr = &ctx->merge_time_ms;
+        a->sort_mode = ctx->sort_mode;
+        a->histograms = ctx->histograms;
+        a->splitters = ctx->splitters;
+        a->record_kernel = kernel;
+        a->records = (kernel != NULL) ? data : NULL;
+        a->temp_records = (kernel != NULL) ? scratch : NULL;
+        a->trace = (ctx->traces != NULL) ? &ctx->traces[i] : NULL;
+        a->events = (ctx->event_rings != NULL) ? &ctx->event_rings[i] : NULL;
+    }
+    // La coda è stata chiusa dall'ordinamento precedente: nessun worker la usa adesso
+    reset_queue(&ctx->queue);
+    // Con -s qsort sugli int la fase di sorting usa i deque: partizione i al worker i
+    if (kernel == NULL && ctx->stealer.deques != NULL) steal_reset(&ctx->stealer, n);
+    dispatch(ctx, sort_job);
+}
+
+/**
+ * @brief Azzera misura per fase e registro eventi di tutti i worker all'avvio di un ordinamento.
+ */
+static void reset_instrumentation(psort_context *ctx) {
+    double t0_ms = get_time_ms();
+    for (int i = 0; i < ctx->n_threads; ++i) {
+        if (ctx->traces != NULL) trace_reset(&ctx->traces[i], t0_ms);
+        if (ctx->event_rings != NULL) eventlog_reset(&ctx->event_rings[i], t0_ms);
+    }
+}
+
+/**
+ * @brief Ordina data[0..n) con il pool del contesto (vedi psort.h).
+ */
+int psort_sort_int(psort_context *ctx, int *data, long n, int *scratch) {
+    if (ctx == NULL || data == NULL || n < 0) {
+        return -1;
+    }
+    ctx->merge_time_ms = 0.0;
+    reset_instrumentation(ctx);
+    if (n < 2) {
+        return 0;
+    }
+    int *buf = scratch_buffer(ctx, scratch, n * sizeof(int));
+    if (buf == NULL) {
+        return -1;
+    }
+    if (ctx->adaptive && runs_sort_int(ctx, data, n, buf, &ctx->merge_time_ms) != RUNS_NONE) {
+        return 0;
+    }
+    run_pool(ctx, NULL, data, buf, n);
+    return 0;
+}
+
+/**
+ * @brief Attiva o disattiva il rilevamento dei run naturali (vedi psort.h).
+ */
+void psort_set_adaptive(psort_context *ctx, int enabled) {
+    ctx->adaptive = (enabled != 0);
+}
+
+/**
+ * @brief Numero di worker del contesto (vedi psort.h).
+ */
+int psort_n_threads(const psort_context *ctx) {
+    return ctx->n_threads;
+}
+
+/**
+ * @brief Ordina n record del tipo descritto da 'kernel' (vedi psort.h).
+ */
+int psort_sort_records(psort_context *ctx, const RecordKernel *kernel, void *data, long n, void *scratch) {
+    if (ctx == NULL || kernel == NULL || data == NULL || n < 0) {
+        return -1;
+    }
+    ctx->merge_time_ms = 0.0;
+    reset_instrumentation(ctx);
+    if (n < 2) {
+        return 0;
+    }
+    void *buf = scratch_buffer(ctx, scratch, n * kernel->size);
+    if (buf == NULL) {
+        return -1;
+    }
+    run_pool(ctx, kernel, data, buf, n);
+    return 0;
+}
+
+/**
+ * @brief Fissa ogni thread del pool a una CPU (vedi psort.h).
+ */
+int psort_pin_threads(psort_context *ctx) {
+    ctx->pin_failed = 0;
+    dispatch(ctx, pin_job);
+    return ctx->pin_failed ? -1 : 0;
+}
+
+/**
+ * @brief Prima scrittura parallela di un buffer, fetta per fetta (vedi psort.h).
+ */
+void psort_first_touch(psort_context *ctx, void *buf, long n, size_t elem_size) {
+    ctx->touch_buf = buf;
+    ctx->touch_n = n;
+    ctx->touch_elem_size = elem_size;
+    dispatch(ctx, touch_job);
+    ctx->touch_buf = NULL;
+}
+
+/**
+ * @brief Esegue fn sulle fette di [0, n) in parallelo (vedi psort.h).
+ */
+void psort_parallel_for(psort_context *ctx, long n, PsortRangeFn fn, void *arg) {
+    ctx->range_fn = fn;
+    ctx->range_arg = arg;
+    ctx->range_n = n;
+    dispatch(ctx, range_job);
+}
+
+/**
+ * @brief Conta le pagine di ogni fetta che stanno sul nodo del suo thread (vedi psort.h).
+ */
+int psort_page_locality(const psort_context *ctx, const void *buf, long n, size_t elem_size,
+                        long *local_pages, long *remote_pages) {
+    long page = sysconf(_SC_PAGESIZE);
+    *local_pages = 0;
+    *remote_pages = 0;
+    for (int i = 0; i < ctx->n_threads; ++i) {
+        long lo = partition_start(n, ctx->n_threads, i) * (long)elem_size;
+        long hi = partition_start(n, ctx->n_threads, i + 1) * (long)elem_size;
+        if (hi <= lo || ctx->thread_node[i] < 0) continue;
+        uintptr_t first = ((uintptr_t)buf + lo) & ~(uintptr_t)(page - 1);
+        long count = (long)(((uintptr_t)buf + hi - 1 - first) / page) + 1;
+        int *nodes = malloc(count * sizeof(int));
+        CHECK_ERR(nodes == NULL, "psort_page_locality: Errore allocazione");
+        if (numa_query_pages((const void *)first, count, nodes) != 0) {
+            free(nodes);
+            return -1;
+        }
+        for (long j = 0; j < count; ++j) {
+            if (nodes[j] < 0) continue; // Pagina non presente
+            if (nodes[j] == ctx->thread_node[i]) (*local_pages)++;
+            else (*remote_pages)++;
+        }
+        free(nodes);
+    }
+    return 0;
+}
+
+/**
+ * @brief Attiva la misura per fase dei worker (vedi psort.h).
+ */
+int psort_enable_stats(psort_context *ctx) {
+    if (ctx->traces != NULL) return 0;
+    ctx->traces = cache_aligned_calloc(ctx->n_threads, sizeof(WorkerTrace));
+    return (ctx->traces != NULL) ? 0 : -1;
+}
+
+/**
+ * @brief Scrive la misura per fase dell'ultimo ordinamento (vedi psort.h).
+ */
+int psort_write_stats(const psort_context *ctx, FILE *out, int json, const char *label) {
+    if (ctx->traces == NULL) return -1;
+    if (json) trace_write_json(out, ctx->traces, ctx->n_threads, label);
+    else trace_write_csv(out, ctx->traces, ctx->n_threads);
+    return 0;
+}
+
+/**
+ * @brief Attiva il registro eventi dei worker (vedi psort.h).
+ */
+int psort_enable_event_log(psort_context *ctx) {
+    if (ctx->event_rings != NULL) return 0;
+    ctx->event_rings = cache_aligned_calloc(ctx->n_threads, sizeof(EventRing));
+    return (ctx->event_rings != NULL) ? 0 : -1;
+}
+
+/**
+ * @brief Stampa il registro eventi dell'ultimo ordinamento (vedi psort.h).
+ */
+void psort_dump_event_log(const psort_context *ctx, FILE *out) {
+    if (ctx->event_rings == NULL) return;
+    eventlog_dump(out, ctx->event_rings, ctx->n_threads);
+}
+
+/**
+ * @brief Durata della fase di merge dell'ultimo ordinamento (vedi psort.h).
+ */
+double psort_merge_time_ms(const psort_context *ctx) {
+    return ctx->merge_time_ms;
+}
+
+/**
+ * @brief Termina il pool e libera il contesto (vedi psort.h).
+ */
+void psort_destroy(psort_context *ctx) {
+    if (ctx == NULL) return;
+
+    stop_pool(ctx, ctx->n_threads);
+    psort_release(ctx, CTX_INIT_ALL);
+    DEBUG_PRINT_GEN("Contesto distrutto.");
+}
@@ -2,7 +2,12 @@
  * @file queue.c
  * @brief Implementazione di una coda concorrente (thread-safe) per task di partizioni.
  *
- * La coda è implementata come una lista linkata singolarmente.
+ * La coda è implementata come un buffer circolare di task, allocato una volta
+ * da `init_queue` con la capacità richiesta: `push` e `pop` copiano il task
+ * nel buffer e fuori dal buffer senza toccare l'allocatore (la versione con
+ * lista linkata faceva una malloc per push e una free per pop). Se una `push`
+ * trova la coda piena il buffer raddoppia, quindi la capacità è solo un
+ * dimensionamento iniziale e non un limite.
  * Le operazioni `push` e `pop` sono rese thread-safe utilizzando un mutex (`q->mutex`)
  * per l'accesso esclusivo alla struttura dati della coda e una variabile di condizione
  * (`q->cond_non_empty`) per gestire l'attesa dei thread consumatori (pop) quando
@@ -10,47 +15,337 @@
  * La coda può essere "chiusa" (`q->closed = 1`), segnalando che non verranno più
  * aggiunti nuovi task. Questo permette ai thread consumatori di terminare
  * correttamente quando la coda è vuota e chiusa.
+ *
+ * Variante lock-free (`init_queue_lockfree`, vedi queue.h): ogni operazione
+ * pubblica è smistata su q->lf. Ordinamento della memoria: un produttore
+ * scrive il task e poi lo pubblica con una store release di slot->seq; il
+ * consumatore la legge con una load acquire prima di copiare il task, e
+ * restituisce lo slot al giro successivo allo stesso modo. Per non perdere
+ * risvegli, chi si blocca incrementa 'waiters' dell'EventCount prima di
+ * riprovare l'operazione e chi cambia lo slot legge 'waiters' dopo, con una
+ * fence seq_cst da entrambe le parti: almeno uno dei due vede la scrittura
+ * dell'altro. Chi si blocca legge 'events' prima di registrarsi, quindi se
+ * viene incrementato nel frattempo FUTEX_WAIT restituisce subito EAGAIN.
+ *
+ * Attese con scadenza (`pop_timeout`): la variabile di condizione usa
+ * CLOCK_MONOTONIC, così pthread_cond_timedwait riceve direttamente la scadenza
+ * assoluta del chiamante; la variante lock-free usa FUTEX_WAIT_BITSET, che
+ * accetta la stessa scadenza assoluta. pop, push e il caso con task presenti
+ * non cambiano: scadenza e cancellazione sono controllate solo sulla coda vuota.
  */
 
+#define _GNU_SOURCE // Per syscall
+
 #include "queue.h" 
+#include "myutils.h"      // Per cache_aligned_calloc
+#include <errno.h>        // Per ETIMEDOUT, EAGAIN, EINTR
+#include <limits.h>       // Per INT_MAX
 #include <stdio.h>  // Per perror (anche se CHECK_ERR potrebbe già usarlo)
 #include <stdlib.h> // Per malloc, free
+#include <string.h> // Per memcpy
+#include <unistd.h>       // Per syscall, sysconf
+#include <sys/syscall.h>  // Per SYS_futex
+#include <linux/futex.h>  // Per FUTEX_WAIT_BITSET_PRIVATE, FUTEX_WAKE_PRIVATE
 
 /**
  * @brief Inizializza una coda concorrente.
  *
- * Imposta head e tail a NULL, closed a 0, task_count a 0.
- * Inizializza il mutex e la variabile di condizione associati alla coda.
+ * Alloca il buffer circolare per 'capacity' task, imposta head a 0, closed a 0,
+ * task_count a 0. Inizializza il mutex e la variabile di condizione associati alla coda.
  *
  * @param q Puntatore alla struttura ConcurrentQueue da inizializzare.
- * @return 0 in caso di successo, -1 in caso di fallimento nell'inizializzazione
- * del mutex o della variabile di condizione (con messaggio di errore stampato).
+ * @param capacity Task che la coda contiene senza crescere (QUEUE_DEFAULT_CAPACITY se <= 0).
+ * @return 0 in caso di successo, -1 in caso di fallimento nell'allocazione del buffer
+ * o nell'inizializzazione del mutex o della variabile di condizione (con messaggio di errore stampato).
  */
-int init_queue(ConcurrentQueue *q) {
+int init_queue(ConcurrentQueue *q, long capacity) {
     DEBUG_PRINT_GEN("Inizializzazione coda...");
-    q->head = q->tail = NULL; // Coda inizialmente vuota
+    if (capacity <= 0) capacity = QUEUE_DEFAULT_CAPACITY;
+    q->tasks = malloc(capacity * sizeof(Partition_Index_Task));
+    if (q->tasks == NULL) {
+        perror("Errore allocazione buffer coda");
+        return -1;
+    }
+    q->capacity = capacity;
+    q->head = 0;              // Coda inizialmente vuota
     q->closed = 0;            // Coda inizialmente aperta
+    q->cancelled = 0;
     q->task_count = 0;        // Nessun task presente
+    q->lf = NULL;             // Versione con mutex
 
     // Inizializza il mutex per la sincronizzazione dell'accesso alla coda
     if (pthread_mutex_init(&q->mutex, NULL) != 0) {
         perror("Errore inizializzazione mutex coda"); // Stampa errore di sistema
+        free(q->tasks);
         return -1; // Fallimento
     }
-    // Inizializza la variabile di condizione usata per segnalare che la coda non è vuota
-    if (pthread_cond_init(&q->cond_non_empty, NULL) != 0) {
+    // Inizializza la variabile di condizione usata per segnalare che la coda non è vuota,
+    // sull'orologio monotono delle scadenze di pop_timeout
+    pthread_condattr_t cond_attr;
+    int err = pthread_condattr_init(&cond_attr);
+    if (err == 0) {
+        err = pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+        if (err == 0) err = pthread_cond_init(&q->cond_non_empty, &cond_attr);
+        pthread_condattr_destroy(&cond_attr);
+    }
+    if (err != 0) {
         perror("Errore inizializzazione cond var coda");
         pthread_mutex_destroy(&q->mutex); // Pulisce il mutex già creato prima di fallire
+        free(q->tasks);
         return -1; // Fallimento
     }
-    DEBUG_PRINT_GEN("Coda inizializzata.");
+    DEBUG_PRINT_GEN("Coda inizializzata (capacità %ld task).", capacity);
     return 0; // Successo
 }
 
+/**
+ * @brief Inizializza un EventCount senza thread in attesa.
+ */
+static void ec_init(EventCount *ec) {
+    atomic_init(&ec->events, 0);
+    atomic_init(&ec->waiters, 0);
+    atomic_init(&ec->notified, 0);
+}
+
+/**
+ * @brief Sveglia un thread bloccato su ec, se ce n'è uno e nessun altro risveglio è in corso.
+ *
+ * Va chiamata dopo aver reso vera la condizione (task pubblicato o slot liberato).
+ */
+static void ec_notify(EventCount *ec) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ec->waiters, memory_order_relaxed) > 0 &&
+        atomic_load_explicit(&ec->notified, memory_order_relaxed) == 0 &&
+        atomic_exchange(&ec->notified, 1) == 0) {
+        atomic_fetch_add(&ec->events, 1);
+        syscall(SYS_futex, &ec->events, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief Registra il chiamante tra i thread in attesa su ec.
+ * @return Il valore di 'events' da passare a ec_wait, letto prima della registrazione.
+ */
+static unsigned int ec_prepare(EventCount *ec) {
+    unsigned int ev = atomic_load(&ec->events);
+    atomic_fetch_add(&ec->waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    return ev;
+}
+
+/**
+ * @brief Si blocca su ec finché 'events' vale ev (al più fino a 'deadline',
+ * assoluta su CLOCK_MONOTONIC, NULL: nessuna scadenza); poi annulla la registrazione di ec_prepare.
+ *
+ * Con do_wait a 0 (la condizione è diventata vera dopo ec_prepare) annulla solo la registrazione.
+ * EAGAIN (events già cambiato) ed EINTR fanno solo riprovare il chiamante.
+ * @return 0, oppure l'errore dell'attesa: ETIMEDOUT se la scadenza è passata,
+ * EINVAL se la scadenza non è valida.
+ */
+static int ec_wait(EventCount *ec, unsigned int ev, int do_wait, const struct timespec *deadline) {
+    int err = 0;
+    if (do_wait && syscall(SYS_futex, &ec->events, FUTEX_WAIT_BITSET_PRIVATE, ev, deadline, NULL,
+                           FUTEX_BITSET_MATCH_ANY) != 0 && errno != EAGAIN && errno != EINTR) {
+        err = errno;
+    }
+    atomic_fetch_sub(&ec->waiters, 1);
+    atomic_store(&ec->notified, 0);
+    return err;
+}
+
+/**
+ * @brief Suggerimento alla CPU durante l'attesa attiva (pause su x86).
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Inizializza la coda nella variante lock-free (vedi queue.h).
+ *
+ * Lo slot i parte con seq = i, cioè libero per la posizione i del primo giro.
+ * Mutex, variabile di condizione e buffer circolare della versione con mutex
+ * non vengono creati.
+ *
+ * @param q Puntatore alla struttura ConcurrentQueue da inizializzare.
+ * @param capacity Task contenuti al massimo, arrotondati alla potenza di 2 successiva.
+ * @return 0 in caso di successo, -1 in caso di errore di allocazione (con messaggio stampato).
+ */
+int init_queue_lockfree(ConcurrentQueue *q, long capacity) {
+    if (capacity <= 0) capacity = QUEUE_DEFAULT_CAPACITY;
+    long size = 2;
+    while (size < capacity) size *= 2;
+
+    LockFreeRing *r = cache_aligned_calloc(1, sizeof(LockFreeRing)); // Campi _Alignas
+    QueueSlot *slots = cache_aligned_calloc(size, sizeof(QueueSlot));
+    if (r == NULL || slots == NULL) {
+        perror("Errore allocazione ring lock-free");
+        free(r);
+        free(slots);
+        return -1;
+    }
+    for (long i = 0; i < size; ++i) atomic_init(&slots[i].seq, i);
+    r->slots = slots;
+    r->mask = size - 1;
+    r->spin_limit = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? QUEUE_LOCKFREE_SPINS : 0;
+    atomic_init(&r->enqueue_pos, 0);
+    atomic_init(&r->dequeue_pos, 0);
+    ec_init(&r->not_empty);
+    ec_init(&r->not_full);
+    atomic_init(&r->closed, 0);
+    atomic_init(&r->cancelled, 0);
+
+    q->tasks = NULL;
+    q->capacity = size;
+    q->head = 0;
+    q->closed = 0;
+    q->cancelled = 0;
+    q->task_count = 0;
+    q->lf = r;
+    DEBUG_PRINT_GEN("Coda lock-free inizializzata (capacità %ld task).", size);
+    return 0;
+}
+
+/**
+ * @brief Tenta di inserire un task nel ring lock-free.
+ * @return 1 se il task è stato inserito, 0 se il ring è pieno.
+ */
+static int lf_try_push(LockFreeRing *r, Partition_Index_Task task) {
+    long pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    QueueSlot *slot;
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        long dif = atomic_load_explicit(&slot->seq, memory_order_acquire) - pos;
+        if (dif == 0) {
+            // Slot libero per pos: lo prenota avanzando enqueue_pos (pos aggiornato se la CAS fallisce)
+            if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return 0; // Lo slot contiene ancora il task di un giro precedente: ring pieno
+        } else {
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed); // Un altro produttore è passato avanti
+        }
+    }
+    slot->task = task;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief Tenta di estrarre un task dal ring lock-free.
+ * @return 1 se un task è stato estratto in *task, 0 se il ring è vuoto.
+ */
+static int lf_try_pop(LockFreeRing *r, Partition_Index_Task *task) {
+    long pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+    QueueSlot *slot;
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        long dif = atomic_load_explicit(&slot->seq, memory_order_acquire) - (pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return 0; // Nessun task pubblicato in pos: ring vuoto
+        } else {
+            pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    *task = slot->task;
+    // Libera lo slot per la posizione pos + capacità (il giro successivo)
+    atomic_store_explicit(&slot->seq, pos + r->mask + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief Vero se lo slot in testa contiene un task pubblicato (lettura senza estrarre).
+ */
+static int lf_has_task(LockFreeRing *r) {
+    long pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+    return atomic_load_explicit(&r->slots[pos & r->mask].seq, memory_order_acquire) == pos + 1;
+}
+
+/**
+ * @brief Vero se lo slot in coda è libero (lettura senza inserire).
+ */
+static int lf_has_space(LockFreeRing *r) {
+    long pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    return atomic_load_explicit(&r->slots[pos & r->mask].seq, memory_order_acquire) == pos;
+}
+
+/**
+ * @brief Inserisce un task nel ring lock-free; se il ring è pieno attende uno
+ * slot (attesa attiva breve, poi futex su not_full). Sveglia i consumatori solo
+ * prima di bloccarsi: altrimenti lo fa il chiamante, una volta per push o push_n.
+ */
+static void lf_push_wait(LockFreeRing *r, Partition_Index_Task task) {
+    for (int i = 0; !lf_try_push(r, task); ++i) {
+        if (i < r->spin_limit) {
+            cpu_relax();
+            continue;
+        }
+        // Ring pieno: i consumatori devono ripartire anche se il chiamante (push_n) non li ha ancora svegliati
+        ec_notify(&r->not_empty);
+        unsigned int ev = ec_prepare(&r->not_full);
+        int done = lf_try_push(r, task);
+        ec_wait(&r->not_full, ev, !done, NULL);
+        if (done || lf_try_push(r, task)) {
+            // I pop arrivati durante il risveglio non hanno svegliato nessuno: lo fa chi è ripartito
+            if (lf_has_space(r)) ec_notify(&r->not_full);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief push della variante lock-free: inserisce il task, poi sveglia un consumatore bloccato.
+ */
+static void lf_push(LockFreeRing *r, Partition_Index_Task task) {
+    lf_push_wait(r, task);
+    ec_notify(&r->not_empty);
+}
+
+/**
+ * @brief pop della variante lock-free: se il ring è vuoto attende un task
+ * (attesa attiva breve, poi futex su not_empty); un pop libera uno slot e
+ * sveglia un produttore bloccato.
+ *
+ * Se la coda è chiusa basta un ultimo tentativo: close_queue viene chiamata dopo
+ * l'ultima push, quindi un ring vuoto a quel punto resta vuoto.
+ * @param deadline Scadenza assoluta su CLOCK_MONOTONIC (NULL: nessuna scadenza).
+ * @return 1 con il task in *task, 0 (chiusa), QUEUE_CANCELLED, QUEUE_TIMEOUT o QUEUE_INVALID.
+ */
+static int lf_pop(LockFreeRing *r, Partition_Index_Task *task, const struct timespec *deadline) {
+    int got = 0;
+    for (int i = 0; !got; ++i) {
+        if (lf_try_pop(r, task)) break;
+        if (atomic_load(&r->closed) || atomic_load(&r->cancelled)) {
+            if (lf_try_pop(r, task)) break;
+            return atomic_load(&r->cancelled) ? QUEUE_CANCELLED : 0;
+        }
+        if (i < r->spin_limit) {
+            cpu_relax();
+            continue;
+        }
+        unsigned int ev = ec_prepare(&r->not_empty);
+        got = lf_try_pop(r, task);
+        int err = ec_wait(&r->not_empty, ev,
+                          !got && !atomic_load(&r->closed) && !atomic_load(&r->cancelled), deadline);
+        if (!got) got = lf_try_pop(r, task);
+        // Le push arrivate durante il risveglio non hanno svegliato nessuno: lo fa chi è ripartito
+        if (got && lf_has_task(r)) ec_notify(&r->not_empty);
+        // Scadenza passata o non valida (EINVAL): riprovare non cambierebbe l'esito
+        if (!got && err != 0) return (err == ETIMEDOUT) ? QUEUE_TIMEOUT : QUEUE_INVALID;
+    }
+    ec_notify(&r->not_full);
+    return 1;
+}
+
 /**
  * @brief Distrugge una coda concorrente.
  *
- * Libera la memoria di tutti i nodi rimanenti nella coda.
+ * Libera il buffer dei task (compresi quelli rimasti nella coda).
  * Distrugge il mutex e la variabile di condizione associati.
  * È importante che nessun thread stia usando la coda quando questa funzione viene chiamata.
  *
@@ -58,23 +353,22 @@ int init_queue(ConcurrentQueue *q) {
  */
 void destroy_queue(ConcurrentQueue *q) {
     DEBUG_PRINT_GEN("Distruzione coda...");
+    if (q->lf != NULL) { // Variante lock-free: niente mutex né cond var
+        free(q->lf->slots);
+        free(q->lf);
+        q->lf = NULL;
+        DEBUG_PRINT_GEN("Coda lock-free distrutta.");
+        return;
+    }
     // Blocca il mutex per assicurare l'accesso esclusivo durante la distruzione,
     // sebbene idealmente non ci dovrebbero essere altri thread attivi sulla coda.
     pthread_mutex_lock(&q->mutex);
 
-    Node *current = q->head; // Puntatore per scorrere la lista dei nodi
-    Node *next;
-    long freed_count = 0; // Contatore dei nodi liberati (per debug)
-
-    // Libera tutti i nodi rimanenti nella lista
-    while (current != NULL) {
-        next = current->next; // Salva il puntatore al nodo successivo
-        free(current);        // Libera il nodo corrente
-        current = next;       // Passa al nodo successivo
-        freed_count++;
-    }
-    q->head = q->tail = NULL; // Resetta head e tail
-    DEBUG_PRINT_GEN("Liberati %ld nodi rimanenti.", freed_count);
+    DEBUG_PRINT_GEN("Scartati %ld task rimanenti.", q->task_count);
+    free(q->tasks);
+    q->tasks = NULL;
+    q->capacity = 0;
+    q->head = 0;
     q->task_count = 0; // Resetta il contatore dei task
 
     pthread_mutex_unlock(&q->mutex); // Rilascia il mutex
@@ -85,11 +379,32 @@ void destroy_queue(ConcurrentQueue *q) {
     DEBUG_PRINT_GEN("Coda distrutta.");
 }
 
+/**
+ * @brief Raddoppia il buffer di una coda piena. Va chiamata con q->mutex acquisito.
+ *
+ * I task vengono copiati nel nuovo buffer a partire dall'indice 0, in ordine di
+ * estrazione, quindi dopo la crescita la coda non è più "spezzata" dal giro del buffer.
+ */
+static void grow_queue(ConcurrentQueue *q) {
+    long new_capacity = 2 * q->capacity;
+    Partition_Index_Task *grown = malloc(new_capacity * sizeof(Partition_Index_Task));
+    CHECK_ERR(grown == NULL, "Push: Errore allocazione buffer coda");
+    long first = q->capacity - q->head; // Task da head alla fine del vecchio buffer
+    if (first > q->task_count) first = q->task_count;
+    memcpy(grown, q->tasks + q->head, first * sizeof(Partition_Index_Task));
+    memcpy(grown + first, q->tasks, (q->task_count - first) * sizeof(Partition_Index_Task));
+    free(q->tasks);
+    q->tasks = grown;
+    q->capacity = new_capacity;
+    q->head = 0;
+    DEBUG_PRINT_GEN("Coda piena: capacità raddoppiata a %ld task.", new_capacity);
+}
+
 /**
  * @brief Inserisce un task (operazione push) in fondo alla coda in modo thread-safe.
  *
- * Alloca un nuovo nodo, vi copia il task, e lo aggiunge alla fine della lista (tail).
- * Se la coda era vuota, head e tail punteranno al nuovo nodo.
+ * Copia il task nella prima posizione libera del buffer circolare, dopo l'ultimo
+ * task presente; se il buffer è pieno lo raddoppia (grow_queue).
  * Segnala (pthread_cond_signal) alla variabile di condizione `cond_non_empty`
  * per svegliare un eventuale thread in attesa su `pop`.
  *
@@ -97,22 +412,20 @@ void destroy_queue(ConcurrentQueue *q) {
  * @param task Il Partition_Index_Task da inserire.
  */
 void push(ConcurrentQueue *q, Partition_Index_Task task) {
-    // Alloca memoria per un nuovo nodo della lista
-    Node *newNode = malloc(sizeof(Node));
-    CHECK_ERR(newNode == NULL, "Push: Errore allocazione nodo coda"); // Controlla fallimento malloc
-    newNode->task = task; // Copia il task nel nodo
-    newNode->next = NULL; // Il nuovo nodo è l'ultimo, quindi next è NULL
+    if (q->lf != NULL) {
+        lf_push(q->lf, task);
+        return;
+    }
 
     // Acquisisce il lock per l'accesso esclusivo alla coda
     pthread_mutex_lock(&q->mutex);
 
-    // Aggiunge il nuovo nodo in coda alla lista
-    if (q->tail == NULL) { // Se la coda era vuota
-        q->head = q->tail = newNode; // Head e Tail puntano al nuovo (unico) nodo
-    } else { // Se la coda non era vuota
-        q->tail->next = newNode; // Il vecchio tail punta al nuovo nodo
-        q->tail = newNode;       // Il nuovo nodo diventa il nuovo tail
-    }
+    if (q->task_count == q->capacity) grow_queue(q); // Unico caso in cui push alloca
+
+    // Copia il task dopo l'ultimo presente (con il giro del buffer circolare)
+    long tail = q->head + q->task_count;
+    if (tail >= q->capacity) tail -= q->capacity;
+    q->tasks[tail] = task;
     q->task_count++; // Incrementa il contatore dei task
 
     // Segnala a UN thread in attesa su pop (se ce ne sono) che la coda non è più vuota.
@@ -129,22 +442,24 @@ void push(ConcurrentQueue *q, Partition_Index_Task task) {
  * Se la coda è vuota e non è chiusa (`q->closed == 0`), il thread chiamante
  * si mette in attesa sulla variabile di condizione `q->cond_non_empty` finché
  * un task non viene inserito o la coda non viene chiusa.
- * Se la coda è vuota e chiusa (`q->closed == 1`), restituisce 0 (nessun task).
- * Altrimenti, rimuove il nodo dalla testa (head), copia il task, libera il nodo,
- * e restituisce 1.
+ * Se la coda è vuota e chiusa (`q->closed == 1`) o cancellata (`q->cancelled == 1`),
+ * restituisce 0 (nessun task).
+ * Altrimenti, copia il task in testa (head), avanza head e restituisce 1.
  *
  * @param q Puntatore alla ConcurrentQueue.
  * @param task Puntatore a Partition_Index_Task dove verrà copiato il task estratto.
  * @return 1 se un task è stato estratto con successo e copiato in `*task`.
- * @return 0 se la coda è vuota E chiusa (quindi non arriveranno altri task).
+ * @return 0 se la coda è vuota E chiusa (quindi non arriveranno altri task) o cancellata.
  */
 int pop(ConcurrentQueue *q, Partition_Index_Task *task) {
+    if (q->lf != NULL) return lf_pop(q->lf, task, NULL) > 0;
+
     // Acquisisce il lock per l'accesso esclusivo alla coda
     pthread_mutex_lock(&q->mutex);
 
     // Attende finché la coda è vuota E non è ancora stata chiusa.
     // Questo ciclo `while` è cruciale per gestire "spurious wakeups" di pthread_cond_wait.
-    while (q->head == NULL && !q->closed) {
+    while (q->task_count == 0 && !q->closed && !q->cancelled) {
         DEBUG_PRINT_GEN("POP: Coda vuota ma non chiusa. Attesa su cond_non_empty...");
         // Attesa condizionale: rilascia atomicamente il mutex `q->mutex` e si mette in attesa
         // che `q->cond_non_empty` venga segnalata. Quando risvegliato, ri-acquisisce
@@ -155,28 +470,178 @@ int pop(ConcurrentQueue *q, Partition_Index_Task *task) {
     }
 
     // Se la coda è ancora vuota a questo punto, significa che deve essere stata chiusa
-    // (altrimenti il while sopra non sarebbe terminato se q->head è NULL).
-    if (q->head == NULL) { // Implica q->closed == 1
+    // o cancellata (altrimenti il while sopra non sarebbe terminato con task_count a 0).
+    if (q->task_count == 0) { // Implica q->closed == 1 o q->cancelled == 1
         pthread_mutex_unlock(&q->mutex); // Rilascia il lock prima di uscire
         return 0; // Segnala che non ci sono più task e non ne arriveranno (coda vuota e chiusa)
     }
 
-    // Estrae il nodo dalla testa della coda
-    Node *nodeToRemove = q->head;    // Nodo da rimuovere
-    *task = nodeToRemove->task;      // Copia il task nel puntatore fornito dal chiamante
-    q->head = q->head->next;         // Avanza head al nodo successivo
-    if (q->head == NULL) {           // Se la coda è diventata vuota dopo il pop
-        q->tail = NULL;              // Anche tail diventa NULL
+    // Estrae il task dalla testa della coda
+    *task = q->tasks[q->head];       // Copia il task nel puntatore fornito dal chiamante
+    if (++q->head == q->capacity) {  // Avanza head, con il giro del buffer circolare
+        q->head = 0;
     }
     q->task_count--; // Decrementa il contatore dei task
 
     // Rilascia il lock
     pthread_mutex_unlock(&q->mutex);
-
-    free(nodeToRemove); // Libera la memoria del nodo estratto (dopo aver rilasciato il mutex)
     return 1; // Segnala che un task è stato estratto con successo
 }
 
+/**
+ * @brief Estrae il task in testa a una coda non vuota, o dice perché non può farlo.
+ * Va chiamata con q->mutex acquisito, dopo l'eventuale attesa.
+ *
+ * @param if_open Esito da restituire se la coda è vuota ma né chiusa né cancellata
+ * (QUEUE_EMPTY per try_pop, QUEUE_TIMEOUT per pop_timeout).
+ * @return 1 con il task in *task, QUEUE_CANCELLED, 0 (chiusa) o if_open.
+ */
+static int take_task_locked(ConcurrentQueue *q, Partition_Index_Task *task, int if_open) {
+    if (q->task_count == 0) {
+        if (q->cancelled) return QUEUE_CANCELLED;
+        return q->closed ? 0 : if_open;
+    }
+    *task = q->tasks[q->head];
+    if (++q->head == q->capacity) q->head = 0;
+    q->task_count--;
+    return 1;
+}
+
+/**
+ * @brief Estrae un task senza attendere (operazione try_pop).
+ *
+ * Prende comunque il mutex: "senza attendere" riguarda la coda vuota, non la contesa.
+ * Nella variante lock-free è un solo tentativo sul ring.
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ * @param task Puntatore a Partition_Index_Task dove verrà copiato il task estratto.
+ * @return 1 con il task estratto, 0 se la coda è vuota e chiusa, QUEUE_CANCELLED
+ * se è vuota e cancellata, QUEUE_EMPTY se è vuota e possono ancora arrivare task.
+ */
+int try_pop(ConcurrentQueue *q, Partition_Index_Task *task) {
+    if (q->lf != NULL) {
+        LockFreeRing *r = q->lf;
+        int closed = atomic_load(&r->closed) || atomic_load(&r->cancelled);
+        // Dopo aver visto la chiusura un ring vuoto resta vuoto (vedi lf_pop)
+        if (lf_try_pop(r, task)) {
+            ec_notify(&r->not_full);
+            return 1;
+        }
+        if (!closed) return QUEUE_EMPTY;
+        return atomic_load(&r->cancelled) ? QUEUE_CANCELLED : 0;
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    int result = take_task_locked(q, task, QUEUE_EMPTY);
+    pthread_mutex_unlock(&q->mutex);
+    return result;
+}
+
+/**
+ * @brief Estrae un task attendendo al più fino a una scadenza (operazione pop_timeout).
+ *
+ * Come pop, ma l'attesa su `cond_non_empty` è una pthread_cond_timedwait con la
+ * scadenza assoluta del chiamante (la variabile di condizione usa CLOCK_MONOTONIC).
+ * Se il task arriva insieme alla scadenza viene comunque estratto. L'attesa si
+ * interrompe a qualunque errore di pthread_cond_timedwait, non solo ETIMEDOUT:
+ * con una scadenza non valida (EINVAL) riprovare girerebbe all'infinito.
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ * @param task Puntatore a Partition_Index_Task dove verrà copiato il task estratto.
+ * @param deadline Istante assoluto su CLOCK_MONOTONIC (NULL: nessuna scadenza, come pop).
+ * @return 1 con il task estratto, 0 se la coda è vuota e chiusa, QUEUE_CANCELLED
+ * se è vuota e cancellata, QUEUE_TIMEOUT se la scadenza è passata senza task,
+ * QUEUE_INVALID se la coda è vuota e la scadenza non è valida.
+ */
+int pop_timeout(ConcurrentQueue *q, Partition_Index_Task *task, const struct timespec *deadline) {
+    if (q->lf != NULL) return lf_pop(q->lf, task, deadline);
+
+    pthread_mutex_lock(&q->mutex);
+    int err = 0;
+    while (q->task_count == 0 && !q->closed && !q->cancelled && err == 0) {
+        if (deadline == NULL) err = pthread_cond_wait(&q->cond_non_empty, &q->mutex);
+        else err = pthread_cond_timedwait(&q->cond_non_empty, &q->mutex, deadline);
+    }
+    int result = take_task_locked(q, task, (err == 0 || err == ETIMEDOUT) ? QUEUE_TIMEOUT : QUEUE_INVALID);
+    pthread_mutex_unlock(&q->mutex);
+    return result;
+}
+
+/**
+ * @brief Inserisce k task (operazione push_n) in fondo alla coda con una sola sezione critica.
+ *
+ * Fa crescere il buffer una volta sola fino a contenere tutti i task, li copia
+ * (al più due memcpy per il giro del buffer circolare) e sveglia i consumatori
+ * con un solo pthread_cond_broadcast: tutti possono trovare un task.
+ * Nella variante lock-free inserisce i task uno alla volta, ma sveglia i
+ * consumatori una sola volta alla fine.
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ * @param tasks Array dei k task da inserire, nell'ordine di estrazione.
+ * @param k Numero di task (nessuna operazione se k <= 0).
+ */
+void push_n(ConcurrentQueue *q, const Partition_Index_Task *tasks, long k) {
+    if (k <= 0) return;
+    if (q->lf != NULL) {
+        for (long i = 0; i < k; ++i) lf_push_wait(q->lf, tasks[i]);
+        ec_notify(&q->lf->not_empty);
+        return;
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    while (q->capacity - q->task_count < k) grow_queue(q);
+
+    long tail = q->head + q->task_count;
+    if (tail >= q->capacity) tail -= q->capacity;
+    long first = q->capacity - tail; // Posti da tail alla fine del buffer
+    if (first > k) first = k;
+    memcpy(q->tasks + tail, tasks, first * sizeof(Partition_Index_Task));
+    memcpy(q->tasks, tasks + first, (k - first) * sizeof(Partition_Index_Task));
+    q->task_count += k;
+
+    if (k == 1) pthread_cond_signal(&q->cond_non_empty);
+    else pthread_cond_broadcast(&q->cond_non_empty);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+/**
+ * @brief Estrae fino a k task (operazione pop_n) dalla testa della coda con una sola sezione critica.
+ *
+ * Come pop attende finché la coda è vuota e non chiusa; poi estrae i task
+ * presenti, al più k, senza attendere gli altri.
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ * @param tasks Array di almeno k posti dove vengono copiati i task estratti.
+ * @param k Numero massimo di task da estrarre (>= 1).
+ * @return Numero di task estratti (da 1 a k), 0 se la coda è vuota E chiusa.
+ */
+long pop_n(ConcurrentQueue *q, Partition_Index_Task *tasks, long k) {
+    if (q->lf != NULL) {
+        if (lf_pop(q->lf, &tasks[0], NULL) <= 0) return 0;
+        long n = 1;
+        while (n < k && lf_try_pop(q->lf, &tasks[n])) n++;
+        if (n > 1) ec_notify(&q->lf->not_full); // lf_pop ha segnalato solo il primo slot liberato
+        return n;
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    while (q->task_count == 0 && !q->closed && !q->cancelled) {
+        pthread_cond_wait(&q->cond_non_empty, &q->mutex);
+    }
+    long n = (q->task_count < k) ? q->task_count : k; // 0 solo se vuota e chiusa (o cancellata)
+
+    long first = q->capacity - q->head; // Task da head alla fine del buffer
+    if (first > n) first = n;
+    memcpy(tasks, q->tasks + q->head, first * sizeof(Partition_Index_Task));
+    memcpy(tasks + first, q->tasks, (n - first) * sizeof(Partition_Index_Task));
+    q->head += n;
+    if (q->head >= q->capacity) q->head -= q->capacity;
+    q->task_count -= n;
+
+    pthread_mutex_unlock(&q->mutex);
+    return n;
+}
+
 /**
  * @brief Chiude la coda, segnalando che non verranno più aggiunti task.
  *
@@ -189,16 +654,68 @@ int pop(ConcurrentQueue *q, Partition_Index_Task *task) {
  * @param q Puntatore alla ConcurrentQueue.
  */
 void close_queue(ConcurrentQueue *q) {
+    if (q->lf != NULL) {
+        // Sveglia tutti i consumatori: chi è bloccato vede 'closed' al risveglio
+        atomic_store(&q->lf->closed, 1);
+        atomic_fetch_add(&q->lf->not_empty.events, 1);
+        syscall(SYS_futex, &q->lf->not_empty.events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+        return;
+    }
     // Acquisisce il lock
     pthread_mutex_lock(&q->mutex);
     if (!q->closed) { // Esegue l'operazione solo se la coda non è già chiusa
         q->closed = 1; // Imposta il flag 'closed'
         DEBUG_PRINT_GEN("CLOSE_QUEUE: Flag 'closed' impostato.");
         // Sveglia TUTTI i thread potenzialmente in attesa su pthread_cond_wait.
-        // Questo assicura che i thread controllino nuovamente la condizione (q->head == NULL && !q->closed)
-        // e, vedendo q->closed == 1, escano dal loop di attesa se q->head è NULL.
+        // Questo assicura che i thread controllino nuovamente la condizione (q->task_count == 0 && !q->closed)
+        // e, vedendo q->closed == 1, escano dal loop di attesa se la coda è vuota.
         pthread_cond_broadcast(&q->cond_non_empty);
     }
     // Rilascia il lock
     pthread_mutex_unlock(&q->mutex);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Cancella la coda e sveglia tutti i consumatori in attesa (vedi queue.h).
+ *
+ * Imposta il flag `q->cancelled` ed esegue un `pthread_cond_broadcast` su
+ * `q->cond_non_empty`: ogni thread in attesa su pop ricontrolla la condizione ed
+ * esce se la coda è vuota. Nella variante lock-free incrementa il contatore di
+ * eventi dei consumatori e li sveglia tutti con FUTEX_WAKE.
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ */
+void cancel_queue(ConcurrentQueue *q) {
+    if (q->lf != NULL) {
+        atomic_store(&q->lf->cancelled, 1);
+        atomic_fetch_add(&q->lf->not_empty.events, 1);
+        syscall(SYS_futex, &q->lf->not_empty.events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+        return;
+    }
+    pthread_mutex_lock(&q->mutex);
+    q->cancelled = 1;
+    DEBUG_PRINT_GEN("CANCEL_QUEUE: Coda cancellata (task presenti: %ld).", q->task_count);
+    pthread_cond_broadcast(&q->cond_non_empty);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+/**
+ * @brief Riapre la coda dopo close_queue, per riusarla in un nuovo ordinamento.
+ *
+ * Azzera i flag `q->closed` e `q->cancelled`. La coda deve essere vuota e nessun thread deve
+ * essere in attesa su `pop` (tra due ordinamenti i worker del pool sono fermi).
+ *
+ * @param q Puntatore alla ConcurrentQueue.
+ */
+void reset_queue(ConcurrentQueue *q) {
+    if (q->lf != NULL) {
+        atomic_store(&q->lf->closed, 0);
+        atomic_store(&q->lf->cancelled, 0);
+        return;
+    }
+    pthread_mutex_lock(&q->mutex);
+    q->closed = 0;
+    q->cancelled = 0;
+    DEBUG_PRINT_GEN("RESET_QUEUE: Coda riaperta (task presenti: %ld).", q->task_count);
+    pthread_mutex_unlock(&q->mutex);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file recsort.c
+ * @brief Ordinamento parallelo di record a chiave int64_t (chiave + indice, chiave + payload).
+ *
+ * I kernel (introsort, merge branchless, co-rank) sono generati da
+ * recsort_template.h per ogni tipo di record: il tipo, e quindi la dimensione
+ * degli spostamenti, è fisso a tempo di compilazione. record_sort_phase li usa
+ * tramite la RecordKernel del tipo richiesto, solo per puntare alle partizioni:
+ * - Fase 1 e 2 come per gli int: il Worker 0 accoda le P partizioni
+ * [partition_start(i), partition_start(i+1)), tutti i worker le ordinano.
+ * - Fase 3 come -m corank: ping-pong tra records e temp_records, e ad ogni passo
+ * ogni coppia di blocchi è divisa tra tutti i worker del suo gruppo col co-rank.
+ * - Copia finale in parallelo se il risultato è nel buffer temporaneo.
+ */
+
+#include <stdlib.h> // Per malloc, free
+#include <string.h> // Per memcpy, strcmp
+
+#include "recsort.h" // Contiene RecordKernel e i tipi di record
+#include "queue.h"   // Contiene ConcurrentQueue e le sue operazioni
+#include "myutils.h" // Contiene partition_start
+#include "trace.h"   // Contiene trace_begin, trace_barrier_wait
+
+#define RECORD_LEAF_SIZE 16 // Partizioni <= RECORD_LEAF_SIZE vanno all'insertion sort
+
+/**
+ * @brief Limite di profondità dell'introsort: 2 * floor(log2(n)).
+ */
+static int record_depth_limit(long n) {
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth++;
+    }
+    return 2 * depth;
+}
+
+// --- Istanze dei kernel (una per tipo di record) ---
+#define RECORD_TYPE KeyIndexRecord
+#define RECORD_PREFIX key_index
+#define RECORD_NAME "keyindex"
+#include "recsort_template.h"
+
+#define RECORD_TYPE PayloadRecord8
+#define RECORD_PREFIX payload8
+#define RECORD_NAME "rec8"
+#include "recsort_template.h"
+
+#define RECORD_TYPE PayloadRecord16
+#define RECORD_PREFIX payload16
+#define RECORD_NAME "rec16"
+#include "recsort_template.h"
+
+#define RECORD_TYPE PayloadRecord32
+#define RECORD_PREFIX payload32
+#define RECORD_NAME "rec32"
+#include "recsort_template.h"
+
+#define RECORD_TYPE PayloadRecord64
+#define RECORD_PREFIX payload64
+#define RECORD_NAME "rec64"
+#include "recsort_template.h"
+
+static const RecordKernel *const record_kernels[] = {
+    &key_index_kernel, &payload8_kernel, &payload16_kernel, &payload32_kernel, &payload64_kernel
+};
+
+/**
+ * @brief Cerca il kernel per nome (vedi recsort.h).
+ */
+const RecordKernel *record_kernel_by_name(const char *name) {
+    for (size_t i = 0; i < sizeof(record_kernels) / sizeof(record_kernels[0]); ++i) {
+        if (strcmp(name, record_kernels[i]->name) == 0) return record_kernels[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parte del worker 'tid' nel passo di merge 'k' (come corank_merge_step in worker.c).
+ */
+static void record_merge_step(const RecordKernel *kern, const char *src, char *dst,
+                              long N, int P, int tid, int k) {
+    size_t size = kern->size;
+    long group_size = 1L << (k + 1);
+    long pair = tid >> (k + 1);
+    long rank = tid & (group_size - 1);
+    long workers_in_group = P - pair * group_size;
+    if (workers_in_group > group_size) workers_in_group = group_size;
+
+    long s1 = partition_start(N, P, pair * group_size);
+    long s2 = partition_start(N, P, pair * group_size + group_size / 2);
+    long end = partition_start(N, P, (pair + 1) * group_size);
+    long n1 = s2 - s1;
+    long n2 = end - s2;
+    long total = n1 + n2;
+
+    long out_lo = total * rank / workers_in_group;
+    long out_hi = total * (rank + 1) / workers_in_group;
+    if (out_lo == out_hi) return;
+
+    const char *a = src + s1 * size;
+    const char *b = src + s2 * size;
+    long i_lo = kern->co_rank(out_lo, a, n1, b, n2);
+    long i_hi = kern->co_rank(out_hi, a, n1, b, n2);
+    long j_lo = out_lo - i_lo;
+    long j_hi = out_hi - i_hi;
+
+    DEBUG_PRINT(tid, "[RECORD Step %d] coppia %ld, output [%ld-%ld]", k, pair, s1 + out_lo, s1 + out_hi - 1);
+    kern->merge(a + i_lo * size, i_hi - i_lo, b + j_lo * size, j_hi - j_lo, dst + (s1 + out_lo) * size);
+}
+
+/**
+ * @brief Ordinamento parallelo di record (vedi descrizione del file).
+ * @param t_args Argomenti del worker; usa record_kernel, records e temp_records.
+ */
+void record_sort_phase(ThreadArgs *t_args) {
+    const RecordKernel *kern = t_args->record_kernel;
+    size_t size = kern->size;
+    int tid = t_args->thread_id;
+    int P = t_args->n_threads;
+    long N = t_args->n_elements;
+    char *records = t_args->records;
+    WorkerTrace *tr = t_args->trace;
+
+    // --- Fase 1: (Solo Worker 0) accodamento delle partizioni, con una sola push_n ---
+    if (tid == 0) {
+        trace_begin(tr, TRACE_PARTITION, -1);
+        Partition_Index_Task *tasks = malloc(P * sizeof(Partition_Index_Task));
+        CHECK_ERR(tasks == NULL, "Worker 0: Errore allocazione task delle partizioni");
+        long n_tasks = 0;
+        for (int i = 0; i < P; ++i) {
+            tasks[n_tasks].start = partition_start(N, P, i);
+            tasks[n_tasks].end = partition_start(N, P, i + 1) - 1;
+            if (tasks[n_tasks].start <= tasks[n_tasks].end) n_tasks++;
+        }
+        push_n(t_args->queue, tasks, n_tasks);
+        free(tasks);
+        close_queue(t_args->queue);
+    }
+
+    // --- Fase 2: ordinamento delle partizioni prelevate dalla coda ---
+    trace_begin(tr, TRACE_SORT, -1);
+    Partition_Index_Task task;
+    while (pop(t_args->queue, &task)) {
+        DEBUG_PRINT(tid, "[RECORD] Ordino %s [%ld-%ld]", kern->name, task.start, task.end);
+        kern->sort(records + task.start * size, task.end - task.start + 1);
+    }
+    trace_barrier_wait(tr, t_args->barrier, -1, "Errore in spin_barrier_wait (record, post-sorting)");
+
+    // --- Fase 3: merge co-rank ping-pong in ceil(log2(P)) passi ---
+    char *src = records;
+    char *dst = t_args->temp_records;
+    for (int k = 0; (1L << k) < P; ++k) {
+        trace_begin(tr, TRACE_MERGE, k);
+        record_merge_step(kern, src, dst, N, P, tid, k);
+        trace_barrier_wait(tr, t_args->barrier, k, "Errore in spin_barrier_wait (record, passo di merge)");
+        char *swap_tmp = src;
+        src = dst;
+        dst = swap_tmp;
+    }
+
+    // --- Copia finale se il risultato è nel buffer temporaneo ---
+    if (src != records) {
+        trace_begin(tr, TRACE_COPY, -1);
+        long lo = partition_start(N, P, tid);
+        long hi = partition_start(N, P, tid + 1);
+        if (hi > lo) memcpy(records + lo * size, src + lo * size, (hi - lo) * size);
+        trace_end(tr);
+    }
+}
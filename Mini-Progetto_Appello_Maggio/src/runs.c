@@ -0,0 +1,234 @@
+/**
+ * @file runs.c
+ * @brief Rilevamento dei run naturali e ordinamento adattivo degli int (vedi runs.h).
+ *
+ * Tutte le fasi sono cicli psort_parallel_for sul pool del contesto:
+ * 1. Scansione: il thread i registra, tra le coppie (a[j], a[j+1]) della sua
+ * fetta, dove cambia la direzione (salita o discesa); la prima e l'ultima
+ * direzione della fetta permettono poi di unire i run a cavallo tra due fette.
+ * Dopo RUNS_MAX_RUNS cambi la fetta si ferma, perché la risposta sarà comunque
+ * "ordinamento completo": sui dati casuali legge poche centinaia di elementi.
+ * 2. Inversione dei run decrescenti: le coppie da scambiare (a[j], a[s+e-1-j])
+ * di tutti i run decrescenti [s, e) formano un unico intervallo di indici,
+ * diviso in P fette uguali (un solo run decrescente: inversione di tutto l'array).
+ * 3. Merge dei run (pochi run): ad ogni passo i run 2r e 2r+1 vengono uniti da
+ * src a dst (ping-pong); l'output di tutto il passo è diviso in P fette uguali
+ * e il thread i unisce con il co-rank la parte di ogni coppia che cade nella sua
+ * fetta, quindi il lavoro resta bilanciato anche se i run hanno lunghezze diverse.
+ */
+
+#include <stdlib.h> // Per malloc, free
+#include <string.h> // Per memcpy
+
+#include "runs.h"
+#include "myutils.h"    // Contiene co_rank, get_time_ms
+#include "sortkernel.h" // Contiene merge_int
+
+// RunScan: Risultato della scansione di una fetta.
+typedef struct {
+    int first_dir;   // Direzione della prima coppia non uguale (+1 salita, -1 discesa, 0 nessuna)
+    long first_pos;  // j di quella coppia
+    int last_dir;    // Direzione dell'ultima coppia non uguale
+    long turns;      // Cambi di direzione nella fetta
+    long turn_pos[RUNS_MAX_RUNS]; // Inizio (j+1) del run creato dai primi RUNS_MAX_RUNS cambi
+} RunScan;
+
+typedef struct {
+    const int *data;
+    RunScan *scans; // Uno per thread
+} ScanArgs;
+
+/**
+ * @brief Scansione della fetta [lo, hi) delle coppie (a[j], a[j+1]).
+ */
+static void scan_slice(void *arg, int index, long lo, long hi) {
+    const ScanArgs *s = arg;
+    const int *a = s->data;
+    RunScan *r = &s->scans[index];
+    int dir = 0;
+    r->first_dir = 0;
+    r->turns = 0;
+    for (long j = lo; j < hi; ++j) {
+        int d = (a[j] < a[j + 1]) - (a[j] > a[j + 1]);
+        if (d == 0 || d == dir) continue;
+        if (dir == 0) {
+            r->first_dir = d;
+            r->first_pos = j;
+        } else {
+            if (r->turns < RUNS_MAX_RUNS) r->turn_pos[r->turns] = j + 1;
+            // Troppi run: né ordinato, né invertibile, né da unire
+            if (++r->turns >= RUNS_MAX_RUNS) break;
+        }
+        dir = d;
+    }
+    r->last_dir = dir;
+}
+
+/**
+ * @brief Ricostruisce i run di data[0..n) dalle scansioni delle P fette.
+ *
+ * Un run a cavallo tra due fette continua se la prima direzione della fetta
+ * è uguale all'ultima della precedente; dopo ogni cambio la direzione si alterna.
+ * @return Numero di run (0 se tutti gli elementi sono uguali), -1 se sono più di RUNS_MAX_RUNS.
+ */
+static long collect_runs(const RunScan *scans, int P, long n, long *starts, int *dirs) {
+    long n_runs = 0;
+    int prev = 0;
+    for (int i = 0; i < P; ++i) {
+        const RunScan *r = &scans[i];
+        if (r->turns >= RUNS_MAX_RUNS) return -1;
+        if (r->first_dir == 0) continue;
+        if (prev == 0 || r->first_dir != prev) {
+            if (n_runs == RUNS_MAX_RUNS) return -1;
+            starts[n_runs] = (prev == 0) ? 0 : r->first_pos + 1;
+            dirs[n_runs++] = r->first_dir;
+        }
+        for (long t = 0; t < r->turns; ++t) {
+            if (n_runs == RUNS_MAX_RUNS) return -1;
+            starts[n_runs] = r->turn_pos[t];
+            dirs[n_runs] = -dirs[n_runs - 1];
+            n_runs++;
+        }
+        prev = r->last_dir;
+    }
+    starts[n_runs] = n;
+    return n_runs;
+}
+
+typedef struct {
+    int *data;
+    const long *starts;  // starts[0..n_runs]
+    const int *dirs;     // Direzione di ogni run
+    const long *halves;  // halves[r]: coppie da scambiare nei run decrescenti prima di r
+    long n_runs;
+} ReverseArgs;
+
+/**
+ * @brief Esegue gli scambi [lo, hi) dell'intervallo unico delle coppie dei run decrescenti.
+ */
+static void reverse_slice(void *arg, int index, long lo, long hi) {
+    (void)index;
+    const ReverseArgs *v = arg;
+    for (long r = 0; r < v->n_runs && lo < hi; ++r) {
+        if (v->dirs[r] > 0 || v->halves[r + 1] <= lo) continue;
+        long s = v->starts[r], e = v->starts[r + 1];
+        long k_hi = ((hi < v->halves[r + 1]) ? hi : v->halves[r + 1]) - v->halves[r];
+        for (long k = lo - v->halves[r]; k < k_hi; ++k) {
+            int tmp = v->data[s + k];
+            v->data[s + k] = v->data[e - 1 - k];
+            v->data[e - 1 - k] = tmp;
+        }
+        lo = v->halves[r + 1];
+    }
+}
+
+/**
+ * @brief Inverte in parallelo i run decrescenti, che diventano crescenti.
+ */
+static void reverse_runs(psort_context *ctx, int *data, const long *starts, const int *dirs, long n_runs) {
+    long halves[RUNS_MAX_RUNS + 1];
+    halves[0] = 0;
+    for (long r = 0; r < n_runs; ++r) {
+        halves[r + 1] = halves[r] + ((dirs[r] < 0) ? (starts[r + 1] - starts[r]) / 2 : 0);
+    }
+    if (halves[n_runs] == 0) return;
+    ReverseArgs rev = { data, starts, dirs, halves, n_runs };
+    psort_parallel_for(ctx, halves[n_runs], reverse_slice, &rev);
+}
+
+typedef struct {
+    const int *src;
+    int *dst;
+    const long *starts; // starts[0..n_runs]: inizio di ogni run, starts[n_runs] = n
+    long n_runs;
+} MergeLevelArgs;
+
+/**
+ * @brief Produce la fetta [lo, hi) dell'output di un passo di merge dei run.
+ *
+ * La coppia r copre [starts[r], starts[r+2]); un run senza compagno (ultimo, con
+ * n_runs dispari) è unito a un run vuoto, cioè copiato.
+ */
+static void merge_level_slice(void *arg, int index, long lo, long hi) {
+    (void)index;
+    const MergeLevelArgs *m = arg;
+    for (long r = 0; r < m->n_runs && lo < hi; r += 2) {
+        long s1 = m->starts[r];
+        long s2 = m->starts[r + 1];
+        long end = (r + 2 <= m->n_runs) ? m->starts[r + 2] : s2;
+        if (end <= lo) continue;
+        long out_lo = ((lo > s1) ? lo : s1) - s1;
+        long out_hi = ((hi < end) ? hi : end) - s1;
+        const int *a = m->src + s1;
+        const int *b = m->src + s2;
+        long i_lo = co_rank(out_lo, a, s2 - s1, b, end - s2);
+        long i_hi = co_rank(out_hi, a, s2 - s1, b, end - s2);
+        merge_int(a + i_lo, i_hi - i_lo, b + (out_lo - i_lo), (out_hi - i_hi) - (out_lo - i_lo),
+                  m->dst + s1 + out_lo);
+        lo = end;
+    }
+}
+
+typedef struct {
+    const int *src;
+    int *dst;
+} CopyArgs;
+
+static void copy_slice(void *arg, int index, long lo, long hi) {
+    (void)index;
+    const CopyArgs *c = arg;
+    if (hi > lo) memcpy(c->dst + lo, c->src + lo, (hi - lo) * sizeof(int));
+}
+
+/**
+ * @brief Unisce a coppie i run naturali di data (starts[0..n_runs]), vedi descrizione del file.
+ */
+static void merge_runs(psort_context *ctx, int *data, long n, int *scratch, long *starts, long n_runs) {
+    int *src = data;
+    int *dst = scratch;
+    while (n_runs > 1) {
+        MergeLevelArgs level = { src, dst, starts, n_runs };
+        psort_parallel_for(ctx, n, merge_level_slice, &level);
+        // Il run j del passo successivo inizia dove iniziava la coppia 2j
+        long merged = (n_runs + 1) / 2;
+        for (long j = 0; j < merged; ++j) starts[j] = starts[2 * j];
+        starts[merged] = n;
+        n_runs = merged;
+        int *swap_tmp = src;
+        src = dst;
+        dst = swap_tmp;
+    }
+    if (src != data) {
+        CopyArgs copy = { src, data };
+        psort_parallel_for(ctx, n, copy_slice, &copy);
+    }
+}
+
+/**
+ * @brief Ordinamento adattivo sui run naturali (vedi runs.h).
+ */
+RunsOutcome runs_sort_int(psort_context *ctx, int *data, long n, int *scratch, double *merge_time_ms) {
+    *merge_time_ms = 0.0;
+    if (n < 2) return RUNS_SORTED;
+
+    int P = psort_n_threads(ctx);
+    RunScan *scans = malloc(P * sizeof(RunScan));
+    if (scans == NULL) return RUNS_NONE; // Senza scansione si ordina da capo
+    ScanArgs scan = { data, scans };
+    psort_parallel_for(ctx, n - 1, scan_slice, &scan);
+
+    long starts[RUNS_MAX_RUNS + 1];
+    int dirs[RUNS_MAX_RUNS];
+    long n_runs = collect_runs(scans, P, n, starts, dirs);
+    free(scans);
+
+    if (n_runs < 0 || (n_runs > 1 && n / n_runs < RUNS_MIN_RUN_LEN)) return RUNS_NONE;
+    if (n_runs == 0 || (n_runs == 1 && dirs[0] > 0)) return RUNS_SORTED;
+    reverse_runs(ctx, data, starts, dirs, n_runs);
+    if (n_runs == 1) return RUNS_REVERSED;
+
+    double t0 = get_time_ms();
+    merge_runs(ctx, data, n, scratch, starts, n_runs);
+    *merge_time_ms = get_time_ms() - t0;
+    return RUNS_MERGED;
+}
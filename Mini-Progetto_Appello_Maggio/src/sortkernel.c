@@ -0,0 +1,359 @@
+/**
+ * @file sortkernel.c
+ * @brief Kernel di ordinamento e merge per int specializzati (introsort, reti bitoniche AVX2).
+ *
+ * Questo file contiene:
+ * - sort_int: introsort (quicksort con pivot mediana di tre, fallback heapsort
+ * oltre 2*log2(n) livelli di ricorsione) con i confronti scritti direttamente
+ * sugli int, senza passare da un comparatore void* come qsort.
+ * - Caso base per partizioni di al più 16 elementi: rete di ordinamento bitonica
+ * su due registri AVX2 (gli elementi mancanti sono riempiti con INT_MAX),
+ * oppure insertion sort scalare sulle CPU senza AVX2. La scelta avviene a
+ * runtime con __builtin_cpu_supports, quindi lo stesso eseguibile funziona
+ * su qualunque x86-64 (e su architetture diverse usa sempre il percorso scalare).
+ * - merge_int: merge di due run ordinati. Con AVX2 tiene 8 elementi "in volo" in
+ * un registro e li unisce con i successivi 8 (presi dal run con la testa minore)
+ * tramite una rete bitonica a 16 ingressi, scrivendo 8 elementi per iterazione.
+ * Senza AVX2, e per le code, usa un merge scalare branchless.
+ */
+
+#include "sortkernel.h"
+#include <limits.h> // Per INT_MAX
+#include <string.h> // Per memcpy
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SORTKERNEL_HAVE_AVX2 1
+#include <immintrin.h>
+#else
+#define SORTKERNEL_HAVE_AVX2 0
+#endif
+
+#define SORT_LEAF_SIZE 16 // Partizioni <= SORT_LEAF_SIZE vanno al caso base
+
+/**
+ * @brief Insertion sort scalare: caso base senza AVX2.
+ */
+static inline void insertion_sort_int(int *a, long n) {
+    for (long i = 1; i < n; ++i) {
+        int v = a[i];
+        long j = i - 1;
+        while (j >= 0 && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+}
+
+#if SORTKERNEL_HAVE_AVX2
+// Un passo di compare-exchange della rete bitonica su 8 lane: ogni lane si
+// confronta con la lane partner indicata da 'idx'; le lane in MASK prendono il
+// massimo, le altre il minimo.
+#define CMP_EXCHANGE_8(v, idx, MASK) do { \
+        __m256i p_ = _mm256_permutevar8x32_epi32((v), (idx)); \
+        (v) = _mm256_blend_epi32(_mm256_min_epi32((v), p_), _mm256_max_epi32((v), p_), (MASK)); \
+    } while (0)
+
+/**
+ * @brief Ordina le 8 lane di un registro (rete bitonica, 6 passi).
+ */
+__attribute__((target("avx2")))
+static inline __m256i bitonic_sort_8(__m256i v) {
+    const __m256i x1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6); // partner i^1
+    const __m256i x2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5); // partner i^2
+    const __m256i x4 = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3); // partner i^4
+    CMP_EXCHANGE_8(v, x1, 0x66);
+    CMP_EXCHANGE_8(v, x2, 0x3c);
+    CMP_EXCHANGE_8(v, x1, 0x5a);
+    CMP_EXCHANGE_8(v, x4, 0xf0);
+    CMP_EXCHANGE_8(v, x2, 0xcc);
+    CMP_EXCHANGE_8(v, x1, 0xaa);
+    return v;
+}
+
+/**
+ * @brief Ordina una sequenza bitonica di 8 lane (ultimi 3 passi della rete).
+ */
+__attribute__((target("avx2")))
+static inline __m256i bitonic_merge_8(__m256i v) {
+    const __m256i x1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    const __m256i x2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    const __m256i x4 = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3);
+    CMP_EXCHANGE_8(v, x4, 0xf0);
+    CMP_EXCHANGE_8(v, x2, 0xcc);
+    CMP_EXCHANGE_8(v, x1, 0xaa);
+    return v;
+}
+
+/**
+ * @brief Caso base AVX2: ordina fino a 16 interi in due registri.
+ *
+ * Carica gli n elementi con una load mascherata (le lane oltre n valgono
+ * INT_MAX e finiscono in fondo), ordina i due registri, li unisce con un
+ * passo bitonico (il secondo registro viene invertito) e salva le prime n lane.
+ */
+__attribute__((target("avx2")))
+static void sort_leaf_avx2(int *a, long n) {
+    const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i pad = _mm256_set1_epi32(INT_MAX);
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i mask_lo = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)n), iota);
+    __m256i mask_hi = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)n - 8), iota);
+
+    __m256i lo = _mm256_blendv_epi8(pad, _mm256_maskload_epi32(a, mask_lo), mask_lo);
+    __m256i hi = _mm256_blendv_epi8(pad, _mm256_maskload_epi32(a + 8, mask_hi), mask_hi);
+
+    lo = bitonic_sort_8(lo);
+    if (n > 8) {
+        hi = bitonic_sort_8(hi);
+        hi = _mm256_permutevar8x32_epi32(hi, rev); // lo crescente + hi decrescente = sequenza bitonica
+        __m256i mn = _mm256_min_epi32(lo, hi);
+        __m256i mx = _mm256_max_epi32(lo, hi);
+        lo = bitonic_merge_8(mn);
+        hi = bitonic_merge_8(mx);
+        _mm256_maskstore_epi32(a + 8, mask_hi, hi);
+    }
+    _mm256_maskstore_epi32(a, mask_lo, lo);
+}
+#endif
+
+/**
+ * @brief Ripristina la proprietà di max-heap scendendo dalla radice 'i'.
+ */
+static inline void sift_down_int(int *a, long i, long n) {
+    int v = a[i];
+    for (;;) {
+        long child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && a[child + 1] > a[child]) child++;
+        if (a[child] <= v) break;
+        a[i] = a[child];
+        i = child;
+    }
+    a[i] = v;
+}
+
+/**
+ * @brief Heapsort: fallback dell'introsort quando la ricorsione è troppo profonda.
+ */
+static void heap_sort_int(int *a, long n) {
+    for (long i = n / 2 - 1; i >= 0; --i) sift_down_int(a, i, n);
+    for (long end = n - 1; end > 0; --end) {
+        int tmp = a[0];
+        a[0] = a[end];
+        a[end] = tmp;
+        sift_down_int(a, 0, end);
+    }
+}
+
+/**
+ * @brief Partizione di Hoare di a[0..n) (n >= 2) attorno alla mediana di tre.
+ *
+ * Gli elementi pari al pivot si distribuiscono su entrambi i lati, quindi anche
+ * i dati con molti duplicati restano bilanciati.
+ * @return left in [1, n-1] tale che a[0..left) <= pivot <= a[left..n).
+ */
+static inline long hoare_partition_int(int *a, long n) {
+    // Pivot: mediana di tre (primo, centrale, ultimo)
+    int x = a[0], y = a[n / 2], z = a[n - 1];
+    int pivot = (x < y) ? ((y < z) ? y : (x < z ? z : x))
+                        : ((x < z) ? x : (y < z ? z : y));
+
+    long i = -1, j = n;
+    for (;;) {
+        do { i++; } while (a[i] < pivot);
+        do { j--; } while (a[j] > pivot);
+        if (i >= j) break;
+        int tmp = a[i];
+        a[i] = a[j];
+        a[j] = tmp;
+    }
+    return j + 1; // a[0..j] <= pivot <= a[j+1..n-1]
+}
+
+/**
+ * @brief Corpo dell'introsort. Ricorre sulla parte più piccola e itera sulla
+ * più grande, così la profondità dello stack resta O(log n).
+ */
+static void introsort_int(int *a, long n, int depth_limit, int use_avx2) {
+    while (n > SORT_LEAF_SIZE) {
+        if (depth_limit-- == 0) {
+            heap_sort_int(a, n);
+            return;
+        }
+        long left = hoare_partition_int(a, n);
+
+        if (left < n - left) {
+            introsort_int(a, left, depth_limit, use_avx2);
+            a += left;
+            n -= left;
+        } else {
+            introsort_int(a + left, n - left, depth_limit, use_avx2);
+            n = left;
+        }
+    }
+
+#if SORTKERNEL_HAVE_AVX2
+    if (use_avx2) {
+        if (n > 1) sort_leaf_avx2(a, n);
+        return;
+    }
+#endif
+    insertion_sort_int(a, n);
+}
+
+/**
+ * @brief Limite di profondità dell'introsort: 2 * floor(log2(n)).
+ */
+static int intro_depth_limit(long n) {
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth++;
+    }
+    return 2 * depth;
+}
+
+/**
+ * @brief Merge scalare branchless di due run ordinati.
+ *
+ * Il confronto produce 0/1 che avanza uno dei due indici: il compilatore genera
+ * cmov/setcc al posto di un salto condizionale, che su dati casuali verrebbe
+ * predetto male circa una volta su due.
+ */
+void merge_int_scalar(const int *a, long na, const int *b, long nb, int *out) {
+    long i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        int x = a[i];
+        int y = b[j];
+        int take_a = (x <= y); // A parità vince 'a', come in merge_sections
+        out[k++] = take_a ? x : y;
+        i += take_a;
+        j += !take_a;
+    }
+    // Copia la coda del run non ancora esaurito
+    if (i < na) memcpy(&out[k], &a[i], (na - i) * sizeof(int));
+    if (j < nb) memcpy(&out[k], &b[j], (nb - j) * sizeof(int));
+}
+
+#if SORTKERNEL_HAVE_AVX2
+/**
+ * @brief Merge AVX2 di due run ordinati (almeno 8 elementi ciascuno).
+ *
+ * Invariante: 'carry' contiene 8 elementi ordinati, tutti >= di quelli già scritti.
+ * A ogni iterazione si caricano 8 elementi dal run con la testa minore, la rete
+ * bitonica a 16 ingressi separa gli 8 minimi (scritti in out) dagli 8 massimi
+ * (nuovo carry). Quando uno dei due run ha meno di 8 elementi residui, il carry
+ * e quel residuo vengono uniti in un piccolo buffer, poi uniti all'altro run
+ * con il merge scalare.
+ */
+__attribute__((target("avx2")))
+static void merge_int_avx2(const int *a, long na, const int *b, long nb, int *out) {
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i next = _mm256_loadu_si256((const __m256i *)a);
+    __m256i carry = _mm256_loadu_si256((const __m256i *)b);
+    long i = 8, j = 8, k = 0;
+
+    for (;;) {
+        __m256i r = _mm256_permutevar8x32_epi32(carry, rev); // next crescente + carry decrescente = bitonica
+        __m256i lo = bitonic_merge_8(_mm256_min_epi32(next, r));
+        carry = bitonic_merge_8(_mm256_max_epi32(next, r));
+        _mm256_storeu_si256((__m256i *)&out[k], lo);
+        k += 8;
+
+        if (na - i < 8 || nb - j < 8) break;
+        if (a[i] <= b[j]) {
+            next = _mm256_loadu_si256((const __m256i *)&a[i]);
+            i += 8;
+        } else {
+            next = _mm256_loadu_si256((const __m256i *)&b[j]);
+            j += 8;
+        }
+    }
+
+    // Code: carry (8) + residuo corto (< 8) in 'small', poi merge con l'altro run
+    int carry_buf[8];
+    int small[16];
+    _mm256_storeu_si256((__m256i *)carry_buf, carry);
+    if (na - i < 8) {
+        merge_int_scalar(carry_buf, 8, &a[i], na - i, small);
+        merge_int_scalar(small, 8 + (na - i), &b[j], nb - j, &out[k]);
+    } else {
+        merge_int_scalar(carry_buf, 8, &b[j], nb - j, small);
+        merge_int_scalar(small, 8 + (nb - j), &a[i], na - i, &out[k]);
+    }
+}
+#endif
+
+/**
+ * @brief Unisce due run ordinati in 'out'; percorso AVX2 se disponibile.
+ * @param a Primo run ordinato.
+ * @param na Lunghezza del primo run.
+ * @param b Secondo run ordinato.
+ * @param nb Lunghezza del secondo run.
+ * @param out Destinazione (na + nb elementi, non sovrapposta ai run).
+ */
+void merge_int(const int *a, long na, const int *b, long nb, int *out) {
+#if SORTKERNEL_HAVE_AVX2
+    if (na >= 8 && nb >= 8 && sort_int_has_avx2()) {
+        merge_int_avx2(a, na, b, nb, out);
+        return;
+    }
+#endif
+    merge_int_scalar(a, na, b, nb, out);
+}
+
+/**
+ * @brief Restituisce 1 se la CPU supporta AVX2 (e il kernel è compilato per x86-64).
+ */
+int sort_int_has_avx2(void) {
+#if SORTKERNEL_HAVE_AVX2
+    return __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Ordina in modo crescente n interi; caso base AVX2 se disponibile.
+ * @param a Array da ordinare.
+ * @param n Numero di elementi.
+ */
+void sort_int(int *a, long n) {
+    if (n < 2) return;
+    introsort_int(a, n, intro_depth_limit(n), sort_int_has_avx2());
+}
+
+/**
+ * @brief Un passo di partizione dell'introsort, per dividere un ordinamento in task (vedi sortkernel.h).
+ *
+ * Con n == 2 la mediana di tre cade su a[1] (centrale e ultimo coincidono) e
+ * hoare_partition_int può restituire n: i due elementi vengono ordinati qui.
+ * Da n >= 3 il pivot è la mediana di tre elementi distinti, quindi almeno due
+ * sono >= pivot e la parte sinistra non può contenere tutto l'array.
+ *
+ * @param a Array da partizionare.
+ * @param n Numero di elementi (almeno 2).
+ * @return Dimensione della parte sinistra, in [1, n-1].
+ */
+long partition_int(int *a, long n) {
+    if (n == 2) {
+        if (a[1] < a[0]) {
+            int tmp = a[0];
+            a[0] = a[1];
+            a[1] = tmp;
+        }
+        return 1;
+    }
+    return hoare_partition_int(a, n);
+}
+
+/**
+ * @brief Ordina in modo crescente n interi usando sempre il caso base scalare.
+ * @param a Array da ordinare.
+ * @param n Numero di elementi.
+ */
+void sort_int_scalar(int *a, long n) {
+    if (n < 2) return;
+    introsort_int(a, n, intro_depth_limit(n), 0);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file spinbarrier.c
+ * @brief Barriera spin-then-block con futex (vedi spinbarrier.h).
+ *
+ * Ordinamento della memoria: l'ultimo thread rimette 'remaining' a n_threads
+ * prima di pubblicare il nuovo turno con un incremento release di
+ * 'generation'; chi esce dalla barriera ha letto il nuovo turno con una load
+ * acquire, quindi vede sia il contatore pronto per il turno successivo sia
+ * tutte le scritture fatte dagli altri thread prima di arrivare.
+ * Per non perdere risvegli, chi si blocca incrementa 'sleepers' prima di
+ * ricontrollare il turno e l'ultimo thread legge 'sleepers' dopo averlo
+ * cambiato (entrambi seq_cst): almeno uno dei due vede la scrittura dell'altro.
+ * Se il turno cambia tra il controllo e FUTEX_WAIT, il kernel restituisce EAGAIN.
+ */
+
+#define _GNU_SOURCE // Per syscall
+
+#include <errno.h>
+#include <limits.h>       // Per INT_MAX
+#include <unistd.h>       // Per syscall, sysconf
+#include <sys/syscall.h>  // Per SYS_futex
+#include <linux/futex.h>  // Per FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+
+#include "spinbarrier.h"
+
+/**
+ * @brief Suggerimento alla CPU durante l'attesa attiva (pause su x86).
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Inizializza la barriera (vedi spinbarrier.h).
+ */
+int spin_barrier_init(SpinBarrier *b, int n_threads) {
+    if (n_threads < 1) return EINVAL;
+    atomic_init(&b->remaining, n_threads);
+    atomic_init(&b->generation, 0);
+    atomic_init(&b->sleepers, 0);
+    b->n_threads = n_threads;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    b->spin_limit = (cpus >= n_threads) ? SPIN_BARRIER_SPINS : 0;
+    return 0;
+}
+
+/**
+ * @brief Distrugge la barriera (vedi spinbarrier.h).
+ */
+void spin_barrier_destroy(SpinBarrier *b) {
+    (void)b;
+}
+
+/**
+ * @brief Attende tutti i thread della barriera (vedi spinbarrier.h).
+ */
+int spin_barrier_wait(SpinBarrier *b) {
+    unsigned int gen = atomic_load_explicit(&b->generation, memory_order_acquire);
+
+    if (atomic_fetch_sub_explicit(&b->remaining, 1, memory_order_acq_rel) == 1) {
+        // Ultimo arrivato: prepara il turno successivo e lo pubblica
+        atomic_store_explicit(&b->remaining, b->n_threads, memory_order_relaxed);
+        atomic_fetch_add(&b->generation, 1);
+        if (atomic_load(&b->sleepers) > 0) {
+            syscall(SYS_futex, &b->generation, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+        }
+        return SPIN_BARRIER_SERIAL_THREAD;
+    }
+
+    for (int i = 0; i < b->spin_limit; ++i) {
+        if (atomic_load_explicit(&b->generation, memory_order_acquire) != gen) return 0;
+        cpu_relax();
+    }
+
+    atomic_fetch_add(&b->sleepers, 1);
+    int err = 0;
+    while (atomic_load(&b->generation) == gen) {
+        if (syscall(SYS_futex, &b->generation, FUTEX_WAIT_PRIVATE, gen, NULL, NULL, 0) != 0 &&
+            errno != EAGAIN && errno != EINTR) {
+            err = errno;
+            break;
+        }
+    }
+    atomic_fetch_sub(&b->sleepers, 1);
+    return err;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file steal.c
+ * @brief Deque per worker e work stealing della fase di sorting (vedi steal.h).
+ *
+ * Ogni deque ha il proprio mutex: il proprietario lo prende solo per il suo
+ * deque, quindi senza furti non c'è contesa tra worker (a differenza della
+ * ConcurrentQueue unica, su cui passano tutti i pop). Il lavoro finito è
+ * contato da un unico contatore atomico: un task diviso inserisce il figlio
+ * (pending + 1) prima di essere completato (pending - 1), quindi pending arriva
+ * a 0 solo quando non c'è più nulla da ordinare né da dividere.
+ *
+ * Un ladro legge la dimensione atomica di ogni deque prima di prenderne il
+ * mutex, così un worker inattivo non contende il lock ai proprietari che
+ * inseriscono task divisi. Se non trova nulla riprova per spin_limit giri e poi
+ * si blocca su un futex invece di girare a vuoto fino alla barriera. Per non
+ * perdere risvegli chi si blocca legge 'epoch', incrementa 'sleepers' e
+ * ricontrolla i deque; chi inserisce un task (o completa l'ultimo) legge
+ * 'sleepers' dopo, con una fence seq_cst da entrambe le parti, e incrementa
+ * 'epoch' prima della FUTEX_WAKE: o il ladro vede il task, o il futex non
+ * attende perché 'epoch' è cambiato.
+ */
+
+#define _GNU_SOURCE // Per syscall
+
+#include <limits.h>       // Per INT_MAX
+#include <stdlib.h>       // Per malloc, realloc, free
+#include <unistd.h>       // Per syscall, sysconf
+#include <sys/syscall.h>  // Per SYS_futex
+#include <linux/futex.h>  // Per FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+
+#include "steal.h"
+#include "myutils.h" // Contiene partition_start, cache_aligned_calloc
+
+#define STEAL_INITIAL_CAPACITY 64 // Task allocati inizialmente per deque
+
+/**
+ * @brief Alloca e inizializza i deque (vedi steal.h).
+ */
+int steal_init(WorkStealer *ws, int P) {
+    ws->n_workers = P;
+    ws->grain = STEAL_MIN_GRAIN;
+    // Con una sola CPU l'attesa attiva toglierebbe solo tempo al worker che divide i task
+    ws->spin_limit = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? STEAL_SPINS : 0;
+    atomic_init(&ws->pending, 0);
+    atomic_init(&ws->sleepers, 0);
+    atomic_init(&ws->epoch, 0);
+    ws->deques = cache_aligned_calloc(P, sizeof(WorkDeque));
+    if (ws->deques == NULL) return -1;
+    for (int i = 0; i < P; ++i) {
+        WorkDeque *d = &ws->deques[i];
+        d->tasks = malloc(STEAL_INITIAL_CAPACITY * sizeof(Partition_Index_Task));
+        d->capacity = STEAL_INITIAL_CAPACITY;
+        atomic_init(&d->size, 0);
+        if (d->tasks == NULL || pthread_mutex_init(&d->mutex, NULL) != 0) {
+            free(d->tasks);
+            for (int j = 0; j < i; ++j) {
+                pthread_mutex_destroy(&ws->deques[j].mutex);
+                free(ws->deques[j].tasks);
+            }
+            free(ws->deques);
+            ws->deques = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Libera i deque (vedi steal.h).
+ */
+void steal_destroy(WorkStealer *ws) {
+    if (ws->deques == NULL) return;
+    for (int i = 0; i < ws->n_workers; ++i) {
+        pthread_mutex_destroy(&ws->deques[i].mutex);
+        free(ws->deques[i].tasks);
+    }
+    free(ws->deques);
+    ws->deques = NULL;
+}
+
+/**
+ * @brief Semina i deque con le P partizioni per un nuovo ordinamento (vedi steal.h).
+ */
+void steal_reset(WorkStealer *ws, long N) {
+    int P = ws->n_workers;
+    long grain = N / ((long)P * STEAL_TASKS_PER_WORKER);
+    ws->grain = (grain > STEAL_MIN_GRAIN) ? grain : STEAL_MIN_GRAIN;
+    long seeded = 0;
+    for (int i = 0; i < P; ++i) {
+        WorkDeque *d = &ws->deques[i];
+        d->top = 0;
+        d->bottom = 0;
+        Partition_Index_Task task;
+        task.start = partition_start(N, P, i);
+        task.end = partition_start(N, P, i + 1) - 1;
+        if (task.start <= task.end) {
+            d->tasks[d->bottom++] = task; // capacity >= 1
+            seeded++;
+        }
+        atomic_store_explicit(&d->size, d->bottom, memory_order_relaxed);
+    }
+    atomic_store(&ws->pending, seeded);
+}
+
+/**
+ * @brief Sveglia fino a 'n' worker bloccati in steal_next, se ce ne sono.
+ *
+ * Va chiamata dopo aver reso visibile il cambiamento (task inserito o pending a 0).
+ */
+static void wake_thieves(WorkStealer *ws, int n) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ws->sleepers, memory_order_relaxed) > 0) {
+        atomic_fetch_add(&ws->epoch, 1);
+        syscall(SYS_futex, &ws->epoch, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief Inserisce un task in fondo al deque del proprietario (vedi steal.h).
+ */
+void steal_push(WorkStealer *ws, int tid, Partition_Index_Task task) {
+    WorkDeque *d = &ws->deques[tid];
+    atomic_fetch_add(&ws->pending, 1); // Prima dell'inserimento: un ladro può completarlo subito
+    pthread_mutex_lock(&d->mutex);
+    if (d->bottom == d->capacity) {
+        if (d->top > 0) {
+            // Compatta: i furti hanno liberato la testa dell'array
+            memmove(d->tasks, d->tasks + d->top, (d->bottom - d->top) * sizeof(Partition_Index_Task));
+            d->bottom -= d->top;
+            d->top = 0;
+        } else {
+            Partition_Index_Task *grown = realloc(d->tasks, 2 * d->capacity * sizeof(Partition_Index_Task));
+            CHECK_ERR(grown == NULL, "steal_push: Errore allocazione deque");
+            d->tasks = grown;
+            d->capacity *= 2;
+        }
+    }
+    d->tasks[d->bottom++] = task;
+    atomic_store_explicit(&d->size, d->bottom - d->top, memory_order_relaxed);
+    pthread_mutex_unlock(&d->mutex);
+    wake_thieves(ws, 1);
+}
+
+/**
+ * @brief Preleva dal fondo (proprietario) o dalla cima (ladro) del deque 'd'.
+ * @return 1 se un task è stato prelevato, 0 se il deque è vuoto.
+ */
+static int deque_take(WorkDeque *d, int from_bottom, Partition_Index_Task *task) {
+    int found = 0;
+    pthread_mutex_lock(&d->mutex);
+    if (d->top < d->bottom) {
+        *task = from_bottom ? d->tasks[--d->bottom] : d->tasks[d->top++];
+        if (d->top == d->bottom) d->top = d->bottom = 0; // Vuoto: riparte dall'inizio dell'array
+        atomic_store_explicit(&d->size, d->bottom - d->top, memory_order_relaxed);
+        found = 1;
+    }
+    pthread_mutex_unlock(&d->mutex);
+    return found;
+}
+
+/**
+ * @brief Suggerimento alla CPU durante l'attesa attiva (pause su x86).
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Vero se almeno un deque contiene un task (lettura senza mutex).
+ */
+static int any_task(WorkStealer *ws) {
+    for (int i = 0; i < ws->n_workers; ++i) {
+        if (atomic_load_explicit(&ws->deques[i].size, memory_order_relaxed) > 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prossimo task del worker 'tid', rubandolo se serve (vedi steal.h).
+ */
+int steal_next(WorkStealer *ws, int tid, Partition_Index_Task *task, int *victim) {
+    int P = ws->n_workers;
+    for (int spins = 0; ; ++spins) {
+        if (atomic_load_explicit(&ws->deques[tid].size, memory_order_relaxed) > 0 &&
+            deque_take(&ws->deques[tid], 1, task)) {
+            *victim = tid;
+            return 1;
+        }
+        // Vittime in ordine a partire dal worker successivo, per non concentrare i furti sul Worker 0;
+        // il mutex si prende solo se il deque non risulta vuoto
+        for (int k = 1; k < P; ++k) {
+            int v = (tid + k) % P;
+            if (atomic_load_explicit(&ws->deques[v].size, memory_order_relaxed) > 0 &&
+                deque_take(&ws->deques[v], 0, task)) {
+                *victim = v;
+                return 1;
+            }
+        }
+        if (atomic_load(&ws->pending) == 0) return 0;
+        if (spins < ws->spin_limit) {
+            cpu_relax(); // Qualcuno sta ordinando un task che può ancora essere diviso
+            continue;
+        }
+        unsigned int ev = atomic_load(&ws->epoch);
+        atomic_fetch_add(&ws->sleepers, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!any_task(ws) && atomic_load(&ws->pending) != 0) {
+            // EAGAIN (epoch già cambiato) ed EINTR fanno solo riprovare
+            syscall(SYS_futex, &ws->epoch, FUTEX_WAIT_PRIVATE, ev, NULL, NULL, 0);
+        }
+        atomic_fetch_sub(&ws->sleepers, 1);
+        spins = 0;
+    }
+}
+
+/**
+ * @brief Segnala il completamento di un task (vedi steal.h).
+ */
+void steal_done(WorkStealer *ws) {
+    // L'ultimo task completato chiude la fase: tutti i worker bloccati devono uscire
+    if (atomic_fetch_sub(&ws->pending, 1) == 1) wake_thieves(ws, INT_MAX);
+}
@@ -0,0 +1,250 @@
+/**
+ * @file trace.c
+ * @brief Misura per worker e per fase dell'ordinamento (vedi trace.h).
+ *
+ * I contatori hardware sono aperti con perf_event_open dal thread stesso alla
+ * sua prima trace_begin (pid = 0, cpu = -1: contano solo quel thread, su
+ * qualsiasi CPU) come un unico gruppo guidato da cycles, letto con una sola
+ * read. Se il kernel non li concede (perf_event_paranoid, container, VM) i
+ * tempi vengono registrati comunque e i contatori valgono -1.
+ */
+
+#define _GNU_SOURCE // Per syscall
+
+#include <unistd.h>      // Per syscall, read, close
+#include <sys/ioctl.h>   // Per ioctl
+#include <sys/syscall.h> // Per SYS_perf_event_open
+#include <linux/perf_event.h> // Per perf_event_attr
+
+#include "trace.h"
+#include "myutils.h" // Contiene get_time_ms
+
+static const char *const trace_phase_names[TRACE_PHASE_COUNT] = {
+    "partition", "sort", "merge", "copy", "barrier"
+};
+
+// Evento hardware di ogni TraceCounter, nello stesso ordine.
+static const uint64_t trace_counter_configs[TRACE_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * @brief Nome della fase (vedi trace.h).
+ */
+const char *trace_phase_name(TracePhase phase) {
+    return (phase >= 0 && phase < TRACE_PHASE_COUNT) ? trace_phase_names[phase] : "?";
+}
+
+/**
+ * @brief Apre un contatore hardware del thread chiamante nel gruppo 'group_fd' (-1: nuovo leader).
+ */
+static int perf_open(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/**
+ * @brief Apre il gruppo perf del thread chiamante; perf_state diventa 1 o -1.
+ */
+static void perf_setup(WorkerTrace *t) {
+    for (int c = 0; c < TRACE_COUNTER_COUNT; ++c) {
+        t->perf_fds[c] = -1;
+        t->perf_slot[c] = -1;
+    }
+    int leader = perf_open(trace_counter_configs[TRACE_CYCLES], -1);
+    if (leader < 0) {
+        t->perf_state = -1;
+        return;
+    }
+    t->perf_fds[TRACE_CYCLES] = leader;
+    t->perf_slot[TRACE_CYCLES] = 0;
+    int members = 1;
+    for (int c = TRACE_CYCLES + 1; c < TRACE_COUNTER_COUNT; ++c) {
+        // I membri non supportati dalla CPU restano assenti (-1) senza invalidare il gruppo
+        t->perf_fds[c] = perf_open(trace_counter_configs[c], leader);
+        if (t->perf_fds[c] >= 0) t->perf_slot[c] = members++;
+    }
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    t->perf_state = 1;
+}
+
+/**
+ * @brief Legge il gruppo perf in 'values' (-1 per i contatori assenti).
+ */
+static void perf_read(const WorkerTrace *t, int64_t *values) {
+    for (int c = 0; c < TRACE_COUNTER_COUNT; ++c) values[c] = -1;
+    if (t->perf_state != 1) return;
+    uint64_t buf[1 + TRACE_COUNTER_COUNT]; // nr, poi un valore per membro
+    if (read(t->perf_fds[TRACE_CYCLES], buf, sizeof(buf)) <= 0) return;
+    for (int c = 0; c < TRACE_COUNTER_COUNT; ++c) {
+        if (t->perf_slot[c] >= 0 && (uint64_t)t->perf_slot[c] < buf[0]) values[c] = (int64_t)buf[1 + t->perf_slot[c]];
+    }
+}
+
+/**
+ * @brief Azzera gli eventi per un nuovo ordinamento (vedi trace.h).
+ */
+void trace_reset(WorkerTrace *t, double t0_ms) {
+    t->t0_ms = t0_ms;
+    t->count = 0;
+    t->dropped = 0;
+    t->open = 0;
+}
+
+/**
+ * @brief Inizia una fase (vedi trace.h).
+ */
+void trace_begin(WorkerTrace *t, TracePhase phase, int step) {
+    if (t == NULL) return;
+    if (t->open) trace_end(t);
+    if (t->perf_state == 0) perf_setup(t);
+    if (t->count == TRACE_MAX_EVENTS) {
+        t->dropped++;
+        return;
+    }
+    TraceEvent *ev = &t->events[t->count];
+    ev->phase = phase;
+    ev->step = step;
+    perf_read(t, t->start_counters);
+    ev->start_ms = get_time_ms() - t->t0_ms;
+    t->open = 1;
+}
+
+/**
+ * @brief Chiude la fase aperta (vedi trace.h).
+ */
+void trace_end(WorkerTrace *t) {
+    if (t == NULL || !t->open) return;
+    TraceEvent *ev = &t->events[t->count];
+    ev->end_ms = get_time_ms() - t->t0_ms;
+    int64_t now[TRACE_COUNTER_COUNT];
+    perf_read(t, now);
+    for (int c = 0; c < TRACE_COUNTER_COUNT; ++c) {
+        ev->counters[c] = (now[c] >= 0 && t->start_counters[c] >= 0) ? now[c] - t->start_counters[c] : -1;
+    }
+    t->count++;
+    t->open = 0;
+}
+
+/**
+ * @brief Attesa sulla barriera misurata come TRACE_BARRIER (vedi trace.h).
+ */
+int trace_barrier_wait(WorkerTrace *t, SpinBarrier *barrier, int step, const char *message) {
+    trace_begin(t, TRACE_BARRIER, step);
+    int err = spin_barrier_wait(barrier);
+    trace_end(t);
+    if (err != 0 && err != SPIN_BARRIER_SERIAL_THREAD) {
+        CHECK_PTHREAD_ERR(err, message);
+    }
+    return err == SPIN_BARRIER_SERIAL_THREAD;
+}
+
+/**
+ * @brief Chiude il gruppo perf (vedi trace.h).
+ */
+void trace_close(WorkerTrace *t) {
+    if (t->perf_state == 1) {
+        for (int c = TRACE_COUNTER_COUNT - 1; c >= 0; --c) {
+            if (t->perf_fds[c] >= 0) close(t->perf_fds[c]); // Prima i membri, poi il leader
+        }
+    }
+    t->perf_state = 0;
+}
+
+/**
+ * @brief Eventi in CSV (vedi trace.h).
+ */
+void trace_write_csv(FILE *out, const WorkerTrace *traces, int P) {
+    fprintf(out, "worker,phase,step,start_ms,end_ms,duration_ms,cycles,instructions,cache_misses,branch_misses\n");
+    for (int w = 0; w < P; ++w) {
+        for (int e = 0; e < traces[w].count; ++e) {
+            const TraceEvent *ev = &traces[w].events[e];
+            fprintf(out, "%d,%s,%d,%.6f,%.6f,%.6f,%lld,%lld,%lld,%lld\n",
+                    w, trace_phase_name(ev->phase), ev->step, ev->start_ms, ev->end_ms,
+                    ev->end_ms - ev->start_ms,
+                    (long long)ev->counters[TRACE_CYCLES], (long long)ev->counters[TRACE_INSTRUCTIONS],
+                    (long long)ev->counters[TRACE_CACHE_MISSES], (long long)ev->counters[TRACE_BRANCH_MISSES]);
+        }
+    }
+}
+
+/**
+ * @brief Durata totale delle fasi (phase, step) del worker w; -1 se il worker non ne ha.
+ */
+static double phase_duration(const WorkerTrace *t, TracePhase phase, int step) {
+    double total = -1.0;
+    for (int e = 0; e < t->count; ++e) {
+        const TraceEvent *ev = &t->events[e];
+        if (ev->phase == phase && ev->step == step) {
+            if (total < 0) total = 0.0;
+            total += ev->end_ms - ev->start_ms;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Eventi e riepilogo per (fase, passo) in JSON (vedi trace.h).
+ */
+void trace_write_json(FILE *out, const WorkerTrace *traces, int P, const char *label) {
+    int perf_available = 0, dropped = 0, max_step = -1;
+    for (int w = 0; w < P; ++w) {
+        if (traces[w].perf_state == 1) perf_available = 1;
+        dropped += traces[w].dropped;
+        for (int e = 0; e < traces[w].count; ++e) {
+            if (traces[w].events[e].step > max_step) max_step = traces[w].events[e].step;
+        }
+    }
+
+    fprintf(out, "{\n  \"run\": \"%s\",\n  \"workers\": %d,\n  \"perf_available\": %s,\n  \"dropped_events\": %d,\n",
+            label, P, perf_available ? "true" : "false", dropped);
+
+    // Riepilogo: per ogni (fase, passo) presente, durata minima/massima/media tra i worker che la eseguono
+    fprintf(out, "  \"summary\": [");
+    int first = 1;
+    for (int phase = 0; phase < TRACE_PHASE_COUNT; ++phase) {
+        for (int step = -1; step <= max_step; ++step) {
+            double min_ms = 0.0, max_ms = 0.0, sum_ms = 0.0;
+            int workers = 0;
+            for (int w = 0; w < P; ++w) {
+                double d = phase_duration(&traces[w], (TracePhase)phase, step);
+                if (d < 0) continue;
+                if (workers == 0 || d < min_ms) min_ms = d;
+                if (workers == 0 || d > max_ms) max_ms = d;
+                sum_ms += d;
+                workers++;
+            }
+            if (workers == 0) continue;
+            double mean_ms = sum_ms / workers;
+            fprintf(out, "%s\n    {\"phase\": \"%s\", \"step\": %d, \"workers\": %d, \"min_ms\": %.6f, "
+                         "\"max_ms\": %.6f, \"mean_ms\": %.6f, \"imbalance\": %.4f}",
+                    first ? "" : ",", trace_phase_name((TracePhase)phase), step, workers,
+                    min_ms, max_ms, mean_ms, (mean_ms > 0) ? max_ms / mean_ms : 1.0);
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ],\n");
+
+    fprintf(out, "  \"events\": [");
+    first = 1;
+    for (int w = 0; w < P; ++w) {
+        for (int e = 0; e < traces[w].count; ++e) {
+            const TraceEvent *ev = &traces[w].events[e];
+            fprintf(out, "%s\n    {\"worker\": %d, \"phase\": \"%s\", \"step\": %d, \"start_ms\": %.6f, \"end_ms\": %.6f, "
+                         "\"cycles\": %lld, \"instructions\": %lld, \"cache_misses\": %lld, \"branch_misses\": %lld}",
+                    first ? "" : ",", w, trace_phase_name(ev->phase), ev->step, ev->start_ms, ev->end_ms,
+                    (long long)ev->counters[TRACE_CYCLES], (long long)ev->counters[TRACE_INSTRUCTIONS],
+                    (long long)ev->counters[TRACE_CACHE_MISSES], (long long)ev->counters[TRACE_BRANCH_MISSES]);
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
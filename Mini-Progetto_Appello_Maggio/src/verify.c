@@ -0,0 +1,89 @@
+/**
+ * @file verify.c
+ * @brief Verifica parallela di ordinamento e permutazione (vedi verify.h).
+ *
+ * Ogni thread combina il proprio risultato parziale in un solo valore atomico
+ * (una operazione per thread, non per elemento), letto dal chiamante dopo
+ * psort_parallel_for, che ritorna solo quando tutti i thread hanno terminato.
+ * Così le verifiche non allocano memoria e non possono fallire.
+ */
+
+#include <limits.h>    // Per LONG_MAX
+#include <stdatomic.h> // Per atomic_long, atomic_uint_least64_t
+
+#include "verify.h"
+
+typedef struct {
+    const int *data;
+    atomic_long first_bad; // Minima discesa trovata dai thread (LONG_MAX: nessuna)
+} SortedArgs;
+
+/**
+ * @brief Cerca la prima coppia (data[i], data[i+1]) non ordinata con i nella fetta [lo, hi).
+ */
+static void sorted_slice(void *arg, int index, long lo, long hi) {
+    SortedArgs *s = arg;
+    (void)index;
+    for (long i = lo; i < hi; ++i) {
+        if (s->data[i] > s->data[i + 1]) {
+            long cur = atomic_load(&s->first_bad);
+            while (i < cur && !atomic_compare_exchange_weak(&s->first_bad, &cur, i)) {
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Prima coppia non ordinata di data[0..n), in parallelo (vedi verify.h).
+ */
+long verify_sorted_int(psort_context *ctx, const int *data, long n) {
+    if (n < 2) return -1;
+    SortedArgs args;
+    args.data = data;
+    atomic_init(&args.first_bad, LONG_MAX);
+    psort_parallel_for(ctx, n - 1, sorted_slice, &args); // Coppie i = 0 .. n-2
+    long bad = atomic_load(&args.first_bad);
+    return (bad == LONG_MAX) ? -1 : bad;
+}
+
+/**
+ * @brief Finalizzatore di splitmix64 su un valore a 32 bit.
+ */
+static inline uint64_t checksum_mix(uint32_t x) {
+    uint64_t z = (uint64_t)x * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+typedef struct {
+    const int *data;
+    atomic_uint_least64_t total; // Somma (mod 2^64) delle somme parziali dei thread
+} ChecksumArgs;
+
+/**
+ * @brief Checksum di data[0..n) nel thread chiamante (vedi verify.h).
+ */
+uint64_t checksum_int_block(const int *data, long n) {
+    uint64_t sum = 0;
+    for (long i = 0; i < n; ++i) sum += checksum_mix((uint32_t)data[i]);
+    return sum;
+}
+
+static void checksum_slice(void *arg, int index, long lo, long hi) {
+    ChecksumArgs *c = arg;
+    (void)index;
+    atomic_fetch_add(&c->total, checksum_int_block(c->data + lo, hi - lo));
+}
+
+/**
+ * @brief Checksum del multinsieme data[0..n), in parallelo (vedi verify.h).
+ */
+uint64_t verify_checksum_int(psort_context *ctx, const int *data, long n) {
+    ChecksumArgs args;
+    args.data = data;
+    atomic_init(&args.total, 0);
+    psort_parallel_for(ctx, n, checksum_slice, &args);
+    return atomic_load(&args.total);
+}
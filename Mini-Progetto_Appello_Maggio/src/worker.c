@@ -3,29 +3,223 @@
  * @brief Implementazione della funzione eseguita dai thread Worker per l'ordinamento parallelo.
  *
  * Questa funzione orchestra le diverse fasi dell'algoritmo di ordinamento parallelo:
- * 1. (Solo Worker 0) Partizionamento dell'array e inserimento dei task (indici delle partizioni)
- * nella coda concorrente.
- * 2. (Tutti i Worker) Prelievo dei task dalla coda e ordinamento sequenziale (qsort)
- * delle partizioni assegnate.
+ * 1. Partizionamento dell'array in P partizioni: la partizione i è già nel deque del
+ * worker i (steal_reset, vedi steal.h).
+ * 2. (Tutti i Worker) Ordinamento delle partizioni con work stealing: ogni worker
+ * preleva i task dal proprio deque e, quando è vuoto, li ruba agli altri; un task
+ * grande viene diviso con un passo di partizione e una metà torna nel deque, così
+ * i task sono molti più dei worker e una partizione lenta non ferma tutti alla
+ * BARRIERA 1. I task piccoli sono ordinati con sort_int (kernel specializzato per int).
  * 3. Sincronizzazione tramite barriera per assicurare che tutte le partizioni siano ordinate.
- * 4. (Worker attivi, in log2(P) passi) Merge parallelo delle partizioni ordinate.
+ * 4. (Worker attivi, in ceil(log2(P)) passi) Merge parallelo delle partizioni ordinate.
+ * P può essere qualsiasi: al passo k si uniscono gruppi di 2^k partizioni a coppie,
+ * e un gruppo senza compagno (P non potenza di 2) passa intatto al passo successivo.
  * In ogni passo k, i worker attivi uniscono coppie di blocchi, usando un array temporaneo.
  * I risultati del merge vengono poi ricopiati nell'array principale.
- * Le operazioni di merge su `temp_array` e la successiva copia su `array` sono
- * protette da mutex distinti.
- * Barriere addizionali sincronizzano i worker dopo ogni sotto-fase di merge e copia.
+ * In modalità MERGE_SERIAL le operazioni di merge su `temp_array` e la successiva
+ * copia su `array` sono protette da mutex distinti, e barriere addizionali
+ * sincronizzano i worker dopo ogni sotto-fase di merge e copia.
+ * In modalità MERGE_PARALLEL ogni worker attivo scrive solo nel proprio intervallo
+ * [start_index_block1, end_index_block2], disgiunto da quello degli altri, quindi il
+ * merge procede senza lock. I ruoli di `array` e `temp_array` si scambiano ad ogni
+ * passo (ping-pong): non c'è copia di ritorno né BARRIERA 3, e solo se log2(P) è
+ * dispari i worker ricopiano in parallelo il risultato finale in `array`.
+ * In modalità MERGE_CORANK (sempre ping-pong) nessun worker resta inattivo: al passo k
+ * ogni coppia di blocchi è assegnata a un gruppo di 2^(k+1) worker, e ciascuno produce
+ * una fetta di pari dimensione dell'output, individuata con il co-rank (merge-path).
+ * In modalità MERGE_KWAY non ci sono passi a coppie: ogni worker calcola gli splitter
+ * della propria fetta di output su tutte le P partizioni e la produce con un loser tree,
+ * così l'intera fase legge e scrive gli N elementi una sola volta (più la copia finale).
  * 5. Terminazione del worker.
+ * Con -s radix o -s sample le fasi 1-4 sono sostituite da radix_sort_phase o
+ * sample_sort_phase (vedi intsort.c), eseguite dagli stessi worker; per i record
+ * (-t) da record_sort_phase (vedi recsort.c).
+ * Con --stats ogni fase (e ogni attesa su barriera) è registrata in t_args->trace
+ * con il passo di merge k, vedi trace.h.
+ * I worker non stampano nulla durante l'ordinamento: avvio, task e merge
+ * pianificati sono registrati in t_args->events (eventlog.h, attivo con -v 2)
+ * e stampati alla fine, così i worker non si serializzano sul lock di stdout.
  */
 
 #include <math.h>   // Per log2 (o calcolo manuale di num_steps)
 #include <stdlib.h> // Per qsort
-#include <string.h> // Per memcpy (non usato direttamente qui per la copia principale, ma utile saperlo)
+#include <string.h> // Per memcpy (copia senza lock in MERGE_PARALLEL)
 #include <assert.h> // Per assert
 
 #include "worker.h"  // Contiene ThreadArgs, Partition_Index_Task
-#include "queue.h"   // Contiene ConcurrentQueue e le sue operazioni
 #include "myutils.h" // Contiene merge_sections, print_array, qsort_compare
-// common.h è già incluso tramite gli altri header (worker.h o queue.h o myutils.h)
+#include "intsort.h" // Contiene radix_sort_phase, sample_sort_phase
+#include "sortkernel.h" // Contiene sort_int, merge_int
+#include "recsort.h" // Contiene record_sort_phase
+#include "trace.h"   // Contiene trace_begin, trace_end, trace_barrier_wait
+#include "spinbarrier.h" // Contiene SpinBarrier
+#include "eventlog.h" // Contiene eventlog_record
+#include "steal.h"   // Contiene WorkStealer, steal_next, steal_push, steal_done
+// common.h è già incluso tramite gli altri header (worker.h o myutils.h)
+
+/**
+ * @brief Sposta in a[0], a[n/2] e a[n-1] (i candidati pivot di partition_int)
+ * tre elementi in posizioni pseudo-casuali di a[0..n).
+ *
+ * Usata dopo un pivot sbilanciato: su input come organ-pipe la mediana di
+ * primo, centrale e ultimo è sistematicamente vicina a un estremo, mentre la
+ * mediana di tre elementi casuali no. Scambia solo elementi di a[0..n), quindi
+ * l'intervallo resta un task valido.
+ */
+static void shuffle_pivot_candidates(int *a, long n, uint64_t seed) {
+    long pos[3] = { 0, n / 2, n - 1 };
+    for (int c = 0; c < 3; ++c) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL; // LCG di Knuth
+        long r = (long)((seed >> 17) % (uint64_t)n);
+        int tmp = a[pos[c]];
+        a[pos[c]] = a[r];
+        a[r] = tmp;
+    }
+}
+
+/**
+ * @brief Ordina il task [task.start, task.end] di array, dividendolo se è più grande di grain.
+ *
+ * Finché il task supera stealer->grain viene diviso con un passo di partizione
+ * (partition_int): la metà più grande finisce in fondo al deque del worker, dove
+ * gli altri worker possono rubarla, e il worker prosegue con la più piccola.
+ * Le due metà sono ordinabili separatamente, quindi quando tutti i task della
+ * partizione i sono completati la partizione è ordinata come con un solo sort_int.
+ * Anche un pivot molto sbilanciato (una parte sotto n/16) produce due task validi:
+ * la parte grande viene comunque messa nel deque, ma prima i suoi candidati pivot
+ * sono sostituiti da elementi casuali (shuffle_pivot_candidates), così chi la
+ * divide di nuovo non ripete lo stesso pivot. Un input sbilanciato (organ-pipe,
+ * zipf) resta così divisibile tra i worker invece di finire in un solo sort_int.
+ *
+ * @param stealer Deque dei worker.
+ * @param tid ID del worker.
+ * @param array Array da ordinare.
+ * @param task Intervallo da ordinare (estremi inclusi).
+ * @param events Registro eventi (NULL se disattivato).
+ */
+static void sort_stealable_task(WorkStealer *stealer, int tid, int *array,
+                                Partition_Index_Task task, EventRing *events) {
+    long start = task.start;
+    long n = task.end - task.start + 1;
+    while (n > stealer->grain) {
+        long left = partition_int(&array[start], n);
+        long right = n - left;
+        int skewed = (left < n / 16 || right < n / 16);
+        Partition_Index_Task half;
+        if (left >= right) {
+            half.start = start;
+            half.end = start + left - 1;
+            start += left;
+            n = right;
+        } else {
+            half.start = start + left;
+            half.end = start + n - 1;
+            n = left;
+        }
+        if (skewed) {
+            shuffle_pivot_candidates(&array[half.start], half.end - half.start + 1, (uint64_t)half.start);
+        }
+        eventlog_record(events, EVENT_TASK_PUSH, -1, half.start, half.end, 0, 0);
+        steal_push(stealer, tid, half);
+    }
+    sort_int(&array[start], n);
+}
+
+/**
+ * @brief Esegue la parte di competenza del worker 'tid' nel passo di merge 'k' (MERGE_CORANK).
+ *
+ * Al passo k la coppia di blocchi numero tid >> (k+1) copre 2^(k+1) partizioni
+ * originali ed è assegnata ad altrettanti worker (meno, per l'ultima coppia se P
+ * non è potenza di 2; un blocco senza compagno viene solo copiato in dst). Il worker di rango r nel gruppo
+ * produce l'intervallo di output [L*r/g, L*(r+1)/g) della coppia (L elementi totali,
+ * g worker): il co-rank degli estremi dice da dove leggere in ciascun blocco,
+ * e il merge della fetta viene scritto direttamente in dst. Le fette dei worker
+ * sono disgiunte, quindi non serve alcun lock.
+ *
+ * @param src Buffer sorgente del passo (blocchi ordinati).
+ * @param dst Buffer destinazione del passo.
+ * @param N Numero totale di elementi.
+ * @param P Numero di worker.
+ * @param tid ID del worker.
+ * @param k Indice del passo di merge.
+ */
+static void corank_merge_step(const int *src, int *dst, long N, int P, int tid, int k) {
+    long group_size = 1L << (k + 1);     // Worker (e partizioni originali) per coppia
+    long pair = tid >> (k + 1);          // Coppia di blocchi assegnata al gruppo
+    long rank = tid & (group_size - 1);  // Rango del worker nel gruppo
+    // L'ultimo gruppo può avere meno worker se P non è potenza di 2
+    long workers_in_group = P - pair * group_size;
+    if (workers_in_group > group_size) workers_in_group = group_size;
+
+    long s1 = partition_start(N, P, pair * group_size);
+    long s2 = partition_start(N, P, pair * group_size + group_size / 2);
+    long end = partition_start(N, P, (pair + 1) * group_size); // Esclusivo
+    long n1 = s2 - s1;
+    long n2 = end - s2;
+    long total = n1 + n2;
+
+    long out_lo = total * rank / workers_in_group;
+    long out_hi = total * (rank + 1) / workers_in_group;
+    if (out_lo == out_hi) {
+        DEBUG_PRINT(tid, "[Step %d] CORANK: fetta vuota (coppia %ld, rango %ld).", k, pair, rank);
+        return;
+    }
+
+    long i_lo = co_rank(out_lo, &src[s1], n1, &src[s2], n2);
+    long i_hi = co_rank(out_hi, &src[s1], n1, &src[s2], n2);
+    long j_lo = out_lo - i_lo;
+    long j_hi = out_hi - i_hi;
+
+    DEBUG_PRINT(tid, "[Step %d] CORANK: coppia %ld, output [%ld-%ld] da Blocco1[%ld-%ld) e Blocco2[%ld-%ld)",
+                k, pair, s1 + out_lo, s1 + out_hi - 1, s1 + i_lo, s1 + i_hi, s2 + j_lo, s2 + j_hi);
+    merge_int(&src[s1 + i_lo], i_hi - i_lo, &src[s2 + j_lo], j_hi - j_lo, &dst[s1 + out_lo]);
+}
+
+/**
+ * @brief Produce la fetta di output del worker 'tid' nel merge P-way (MERGE_KWAY).
+ *
+ * La fetta [partition_start(tid), partition_start(tid+1)) dell'output è delimitata
+ * dagli splitter di kway_split su tutte le P partizioni ordinate di 'src': il
+ * worker unisce con il loser tree i soli sotto-run compresi tra i due splitter.
+ *
+ * @param src Buffer con le P partizioni ordinate.
+ * @param dst Buffer destinazione.
+ * @param N Numero totale di elementi.
+ * @param P Numero di worker (e di partizioni).
+ * @param tid ID del worker.
+ */
+static void kway_merge_slice(const int *src, int *dst, long N, int P, int tid) {
+    long out_lo = partition_start(N, P, tid);
+    long out_hi = partition_start(N, P, tid + 1);
+    if (out_lo == out_hi) return;
+
+    const int **runs = malloc(P * sizeof(int *));
+    long *lens = malloc(P * sizeof(long));
+    long *pos_lo = malloc(P * sizeof(long));
+    long *pos_hi = malloc(P * sizeof(long));
+    CHECK_ERR(runs == NULL || lens == NULL || pos_lo == NULL || pos_hi == NULL,
+              "kway_merge_slice: Errore allocazione splitter");
+
+    for (int r = 0; r < P; ++r) {
+        runs[r] = &src[partition_start(N, P, r)];
+        lens[r] = partition_start(N, P, r + 1) - partition_start(N, P, r);
+    }
+    kway_split(runs, lens, P, out_lo, pos_lo);
+    kway_split(runs, lens, P, out_hi, pos_hi);
+
+    // I sotto-run della fetta riusano gli stessi array: runs[r] avanza allo splitter inferiore
+    for (int r = 0; r < P; ++r) {
+        runs[r] += pos_lo[r];
+        lens[r] = pos_hi[r] - pos_lo[r];
+    }
+    DEBUG_PRINT(tid, "[KWAY] Output [%ld-%ld] da %d sotto-run.", out_lo, out_hi - 1, P);
+    kway_merge(runs, lens, P, &dst[out_lo]);
+
+    free(pos_hi);
+    free(pos_lo);
+    free(lens);
+    free(runs);
+}
 
 /**
  * @brief Funzione principale eseguita da ciascun thread Worker.
@@ -40,97 +234,54 @@ void *worker_thread(void *args) {
     long N = t_args->n_elements;             // Dimensione totale dell'array da ordinare
     int *array = t_args->array;              // Puntatore all'array principale condiviso
     int *temp_array = t_args->temp_array;    // Puntatore all'array temporaneo condiviso per il merge
-    ConcurrentQueue *queue = t_args->queue;  // Puntatore alla coda concorrente condivisa
-    pthread_barrier_t *barrier = t_args->barrier; // Puntatore alla barriera di sincronizzazione
+    WorkStealer *stealer = t_args->stealer;  // Deque dei worker per la fase di sorting
+    SpinBarrier *barrier = t_args->barrier;  // Puntatore alla barriera di sincronizzazione (spin-then-block)
     pthread_mutex_t *merge_mutex = t_args->merge_mutex_ptr; // Puntatore al mutex per la serializzazione di merge_sections
     pthread_mutex_t *copy_mutex = t_args->copy_phase_mutex_ptr; // Puntatore al mutex per la serializzazione della copia
-    int err; // Variabile per memorizzare i codici di ritorno delle funzioni pthread
+    int serialize = (t_args->merge_mode == MERGE_SERIAL); // 1 se merge e copia vanno protetti dai mutex
+    double merge_start_ms = 0.0; // Istante di inizio della fase di merge (usato solo dal Worker 0)
+    WorkerTrace *tr = t_args->trace; // Misura per fase (NULL: trace_* non fanno nulla)
+    EventRing *events = t_args->events; // Registro eventi (NULL: eventlog_record non fa nulla)
 
-    // Stampa di debug (o normale se DEBUG=0) indicante l'avvio del worker
-    #if DEBUG == 0
-    printf("[WORKER STATUS] Worker %d AVVIATO.\n", tid);
-    #endif
+    // Evento di avvio del worker (stampato alla fine con -v 2)
+    eventlog_record(events, EVENT_WORKER_START, -1, 0, 0, 0, 0);
     DEBUG_PRINT(tid, "Worker avviato. N=%ld, P=%d.", N, P);
 
-    // --- Fase 1: Calcolo e Accodamento Partizioni (Eseguito SOLO dal Worker 0) ---
-    // Solo il worker con thread_id 0 è responsabile di creare i task iniziali (partizioni).
-    if (tid == 0) {
-        DEBUG_PRINT(tid, "Inizio Fase 1: Calcolo e inserimento partizioni iniziali (P=%d)...", P);
-        if (N > 0 && P > 0) { // Procede solo se ci sono elementi e worker
-            long chunk_size = N / P;  // Dimensione base di ogni partizione
-            long remainder = N % P;   // Resto della divisione, da distribuire tra le prime 'remainder' partizioni
-            long current_start = 0;   // Indice di inizio della partizione corrente
-            int tasks_pushed = 0;     // Contatore dei task inseriti nella coda
-
-            // Itera per creare P partizioni
-            for (int i = 0; i < P; ++i) {
-                Partition_Index_Task task; // Struttura per memorizzare gli indici della partizione
-                task.start = current_start;
-                // Calcola la dimensione effettiva della partizione corrente, aggiungendo 1 se fa parte del resto
-                long current_chunk_for_this_partition = chunk_size + (i < remainder ? 1 : 0);
-
-                if (current_chunk_for_this_partition <= 0) { // Se la partizione calcolata è vuota o non valida
-                     task.end = task.start - 1; // Imposta 'end' per renderla non valida (start > end)
-                } else {
-                    task.end = current_start + current_chunk_for_this_partition - 1;
-                }
-
-                // Inserisce il task nella coda solo se la partizione è valida (start <= end)
-                if (task.start <= task.end) {
-                    #if DEBUG == 0
-                    printf("[INDICI SORTING] Worker %d (Master): Creato Task per qsort: start=%d, end=%d (elementi: %d)\n",
-                            tid, task.start, task.end, task.end - task.start + 1);
-                    #endif
-                    DEBUG_PRINT(tid, "[Setup Fase 1] Pushing Task: start=%d, end=%d (elementi: %ld)",
-                                task.start, task.end, task.end - task.start + 1);
-                    push(queue, task); // Inserisce il task nella coda concorrente
-                    tasks_pushed++;
-                } else {
-                    DEBUG_PRINT(tid, "[Setup Fase 1] Skipping Task (partizione vuota) per i=%d: start=%d, end=%d, chunk=%ld",
-                                i, task.start, task.end, current_chunk_for_this_partition);
-                }
-                current_start += current_chunk_for_this_partition; // Aggiorna l'indice di inizio per la prossima partizione
-            }
-            DEBUG_PRINT(tid, "Fase 1: Inseriti %d task iniziali. Chiusura della coda...", tasks_pushed);
+    // --- Record a chiave int64_t (-t) o ordinamenti specializzati per interi (-s radix / -s sample) ---
+    if (t_args->record_kernel != NULL || t_args->sort_mode == SORT_RADIX || t_args->sort_mode == SORT_SAMPLE) {
+        if (t_args->record_kernel != NULL) {
+            record_sort_phase(t_args);
+        } else if (t_args->sort_mode == SORT_RADIX) {
+            radix_sort_phase(t_args);
         } else {
-             DEBUG_PRINT(tid, "Fase 1: N (%ld) o P (%d) non positivi, o N=0. Nessun task iniziale da inserire.", N, P);
+            sample_sort_phase(t_args);
         }
-        close_queue(queue); // Segnala che non verranno aggiunti altri task iniziali alla coda
-                            // Questo permette ai worker di terminare il pop quando la coda è vuota.
+        eventlog_record(events, EVENT_WORKER_END, -1, 0, 0, 0, 0);
+        DEBUG_PRINT(tid, "Worker in terminazione.");
+        return NULL;
     }
 
-    // --- Fase 2: Sorting delle Partizioni (Eseguito da TUTTI i Worker) ---
+    // --- Fase 1: Partizioni iniziali ---
+    // Le P partizioni [partition_start(i), partition_start(i+1)) sono già nei deque:
+    // steal_reset (chiamata dal contesto prima di svegliare i worker) mette la
+    // partizione i nel deque del worker i, quindi non serve un accodamento del Worker 0.
+    DEBUG_PRINT(tid, "Fase 1: partizione %d già nel deque del worker (P=%d).", tid, P);
+
+    // --- Fase 2: Sorting delle Partizioni con Work Stealing (Eseguito da TUTTI i Worker) ---
     DEBUG_PRINT(tid, "Inizio Fase 2: Sorting partizioni...");
-    Partition_Index_Task current_task_qsort; // Variabile per memorizzare il task prelevato dalla coda
+    trace_begin(tr, TRACE_SORT, -1);
+    Partition_Index_Task current_task; // Task prelevato dal proprio deque o rubato
+    int victim;                        // Worker a cui appartiene il deque del task
     int tasks_processed_by_this_thread = 0;  // Contatore dei task processati da questo specifico thread
-    // Ciclo: preleva un task dalla coda finché la coda non è vuota e chiusa
-    while (pop(queue, &current_task_qsort)) {
+    // Ciclo: preleva (o ruba) un task finché tutti i task non sono completati
+    while (steal_next(stealer, tid, &current_task, &victim)) {
         tasks_processed_by_this_thread++;
-        #if DEBUG == 0
-        if (current_task_qsort.start <= current_task_qsort.end) {
-            printf("[INDICI SORTING] Worker %d: Prelevato Task per qsort: start=%d, end=%d (elementi: %d)\n",
-            tid, current_task_qsort.start, current_task_qsort.end, current_task_qsort.end - current_task_qsort.start + 1);
-        }
-        #endif
-        DEBUG_PRINT(tid, "[Fase 2] Pop OK: Task(start=%d, end=%d). Eseguo qsort...",
-                    current_task_qsort.start, current_task_qsort.end);
-        
-        // Verifica la validità degli indici del task prima di procedere con qsort
-        if (current_task_qsort.start <= current_task_qsort.end &&
-            current_task_qsort.start >= 0 && current_task_qsort.end < N) {
-            long num_elements_in_partition = current_task_qsort.end - current_task_qsort.start + 1;
-            if (num_elements_in_partition > 0) {
-                 // Esegue qsort sulla porzione di array definita dal task
-                 // qsort_compare è la funzione di confronto per interi
-                 qsort(&array[current_task_qsort.start], num_elements_in_partition, sizeof(int), qsort_compare);
-            } else {
-                 DEBUG_PRINT(tid, "[Fase 2] Task(start=%d, end=%d) ha 0 elementi, qsort saltato.",
-                             current_task_qsort.start, current_task_qsort.end);
-            }
-        } else {
-            DEBUG_PRINT(tid, "[Fase 2] Task(start=%d, end=%d) non valido, vuoto o fuori range (N=%ld), qsort saltato.",
-                        current_task_qsort.start, current_task_qsort.end, N);
-        }
+        eventlog_record(events, (victim == tid) ? EVENT_TASK_POP : EVENT_TASK_STEAL, -1,
+                        current_task.start, current_task.end, victim, 0);
+        DEBUG_PRINT(tid, "[Fase 2] Task(start=%ld, end=%ld) dal deque del worker %d. Eseguo sort_int...",
+                    current_task.start, current_task.end, victim);
+        sort_stealable_task(stealer, tid, array, current_task, events);
+        steal_done(stealer);
     }
     DEBUG_PRINT(tid, "Fase 2: Sorting terminato. Processati %d task da questo thread.", tasks_processed_by_this_thread);
 
@@ -138,30 +289,25 @@ void *worker_thread(void *args) {
     // Tutti i worker attendono qui per assicurare che tutte le partizioni siano state ordinate
     // prima di procedere con la fase di merge.
     DEBUG_PRINT(tid, "Attesa su BARRIERA 1 (post-sorting)...");
-    err = pthread_barrier_wait(barrier);
-    // Il "serial thread" (l'ultimo ad arrivare alla barriera) ottiene PTHREAD_BARRIER_SERIAL_THREAD.
+    // Il "serial thread" (l'ultimo ad arrivare alla barriera) ottiene SPIN_BARRIER_SERIAL_THREAD.
     // Questo è utile per eseguire azioni che devono avvenire una sola volta dopo la barriera.
-    if (err == PTHREAD_BARRIER_SERIAL_THREAD) {
+    // trace_barrier_wait termina il programma se la barriera restituisce un errore.
+    if (trace_barrier_wait(tr, barrier, -1, "Errore fatale in spin_barrier_wait (barriera post-sort)")) {
         DEBUG_PRINT(tid, "Sono l'ultimo thread (serial thread) alla BARRIERA 1.");
         // Se DEBUG è attivo, stampa l'array dopo che tutte le partizioni sono state ordinate localmente.
         #if DEBUG
         if (N > 0) print_array("Array dopo Fase Sorting (Partizioni ordinate internamente)", array, N);
         else DEBUG_PRINT_GEN("Array dopo Fase Sorting: N=0, niente da stampare.");
         #endif
-    } else if (err != 0) { // Qualsiasi altro valore diverso da 0 indica un errore.
-        CHECK_PTHREAD_ERR(err, "Errore fatale in pthread_barrier_wait (barriera post-sort)");
     }
     DEBUG_PRINT(tid, "Superata BARRIERA 1. Inizio Fase Merge...");
+    if (tid == 0) merge_start_ms = get_time_ms();
 
     // --- Fase 3: Merge Parallelo Sincronizzato ---
-    // Questa fase avviene in log2(P) passi.
+    // Questa fase avviene in ceil(log2(P)) passi: il più piccolo num_steps con 2^num_steps >= P.
     int num_steps = 0; // Numero di passi di merge necessari
-    if (P > 1) { // Se c'è più di un worker, è necessario il merge
-        int p_temp = P;
-        while (p_temp > 1) {
-            p_temp >>= 1; // Equivalente a p_temp = p_temp / 2;
-            num_steps++;
-         } // Calcola log_base_2(P)
+    while ((1L << num_steps) < P) {
+        num_steps++;
     }
     DEBUG_PRINT(tid, "Numero di passi di merge necessari: %d (per P=%d)", num_steps, P);
 
@@ -169,51 +315,72 @@ void *worker_thread(void *args) {
         DEBUG_PRINT(tid, "N=0. Non ci sarà alcun merge effettivo, ma si parteciperà alle barriere.");
     }
 
+    // Buffer sorgente e destinazione del passo corrente.
+    // In MERGE_SERIAL restano fissi (array -> temp_array, poi copia di ritorno);
+    // in MERGE_PARALLEL si scambiano al termine di ogni passo.
+    int *src = array;
+    int *dst = temp_array;
+
+    // --- MERGE_KWAY: un unico passo P-way al posto dei log2(P) passi a coppie ---
+    if (t_args->merge_mode == MERGE_KWAY && num_steps > 0) {
+        trace_begin(tr, TRACE_MERGE, 0);
+        kway_merge_slice(array, temp_array, N, P, tid);
+        trace_barrier_wait(tr, barrier, 0, "Errore in spin_barrier_wait (merge P-way)");
+        src = temp_array; // Il risultato è in temp_array: lo riporta in array la copia finale
+        dst = array;
+        num_steps = 0;    // Nessun passo a coppie da eseguire
+    }
+
     // Ciclo per ogni passo di merge
     for (int k = 0; k < num_steps; ++k) {
         DEBUG_PRINT(tid, "--- Inizio Passo Merge k=%d ---", k);
 
-        // Calcola il numero di worker attivi in questo passo. Si dimezza ad ogni passo.
-        
-        int active_workers = P >> (k + 1);
+        // --- MERGE_CORANK: tutti i P worker partecipano ad ogni passo ---
+        if (t_args->merge_mode == MERGE_CORANK) {
+            trace_begin(tr, TRACE_MERGE, k);
+            corank_merge_step(src, dst, N, P, tid, k);
+            trace_barrier_wait(tr, barrier, k, "Errore in spin_barrier_wait (passo co-rank)");
+            int *swap_tmp = src;
+            src = dst;
+            dst = swap_tmp;
+            continue;
+        }
+
+        // Calcola il numero di worker attivi in questo passo. Si dimezza ad ogni passo
+        // (arrotondando per eccesso: l'ultimo gruppo può non avere compagno).
+        int active_workers = (int)((P + (1L << (k + 1)) - 1) >> (k + 1));
         // Determina se il worker corrente è attivo in questo passo 
         int is_active = (tid < active_workers);
         long start_index_block1 = -1, end_index_block1 = -1; // Indici del primo blocco da unire
         long start_index_block2 = -1, end_index_block2 = -1; // Indici del secondo blocco da unire
         int merge_needed_for_this_worker = 0; // Flag: 1 se questo worker deve eseguire un merge, 0 altrimenti
+        int carry_block1 = 0; // Flag: 1 se il Blocco1 non ha compagno e va solo riportato in dst (ping-pong)
 
         // Se N > 0 solo i worker attivi  calcolano gli indici ed eseguono il merge
         if (is_active && N > 0) {
+            trace_begin(tr, TRACE_MERGE, k);
             DEBUG_PRINT(tid, "[Step %d] ATTIVO (tid=%d < active_workers=%d). Calcolo indici per il merge...", k, tid, active_workers);
             
            
            
-            long base_chunk_size_original = N / P; // Dimensione base delle partizioni iniziali
-            long remainder_original = N % P;       // Resto delle partizioni iniziali
+            // Le partizioni originali coinvolte sono [tid * span, (tid + 1) * span):
+            // la prima metà forma il Blocco1, la seconda il Blocco2. Con P non potenza
+            // di 2 gli indici possono superare P: partition_start li tratta come vuoti.
             long merge_block_span_of_original_partitions = 1L << (k + 1);
-
-            // Calcola l'indice di inizio del primo blocco (start_index_block1)
-            // Sommando le dimensioni di tutte le partizioni originali che precedono
-            // il gruppo di partizioni di cui questo worker è responsabile.
-            start_index_block1 = 0;
-            for (int i = 0; i < tid * merge_block_span_of_original_partitions; ++i) {
-                start_index_block1 += base_chunk_size_original + (i < remainder_original ? 1 : 0);
-            }
-
-            // Calcola l'indice di fine del primo blocco (end_index_block1)
             long partitions_in_one_sub_block = 1L << k;
-            end_index_block1 = start_index_block1 - 1; // Inizia dal precedente dell'inizio
-            for (int i = 0; i < partitions_in_one_sub_block; ++i) {
-                // Indice globale della partizione originale che si sta considerando
-                int global_original_partition_idx = tid * merge_block_span_of_original_partitions + i;
-                end_index_block1 += base_chunk_size_original + (global_original_partition_idx < remainder_original ? 1 : 0);
-            }
+            long first_partition = tid * merge_block_span_of_original_partitions;
+
+            start_index_block1 = partition_start(N, P, first_partition);
+            end_index_block1 = partition_start(N, P, first_partition + partitions_in_one_sub_block) - 1;
 
             // L'indice di inizio del secondo blocco è immediatamente successivo alla fine del primo
             start_index_block2 = end_index_block1 + 1;
 
             // Controlla se il blocco 1 è valido
             if (start_index_block1 < N && end_index_block1 >= start_index_block1) {
+                // In ping-pong il Blocco1 deve comunque finire in dst, anche senza merge:
+                // il flag viene azzerato sotto se il merge risulta necessario.
+                carry_block1 = !serialize;
                 // Controlla se il blocco 2 inizierebbe oltre la fine dell'array
                 if (start_index_block2 >= N) {
                     DEBUG_PRINT(tid,
@@ -221,12 +388,7 @@ void *worker_thread(void *args) {
                         k, start_index_block1, end_index_block1, start_index_block2, N);
                 } else {
                     // Calcola l'indice di fine del secondo blocco (end_index_block2)
-                    end_index_block2 = start_index_block2 - 1;
-                    for (int i = 0; i < partitions_in_one_sub_block; ++i) {
-                        // Indice globale della partizione originale per il secondo blocco
-                        int global_original_partition_idx = tid * merge_block_span_of_original_partitions + partitions_in_one_sub_block + i;
-                        end_index_block2 += base_chunk_size_original + (global_original_partition_idx < remainder_original ? 1 : 0);
-                    }
+                    end_index_block2 = partition_start(N, P, first_partition + merge_block_span_of_original_partitions) - 1;
                     // Assicura che end_index_block2 non superi la dimensione dell'array
                     if (end_index_block2 >= N) {
                         end_index_block2 = N - 1;
@@ -235,10 +397,9 @@ void *worker_thread(void *args) {
                     // Se anche il blocco 2 è valido e non vuoto, allora il merge è necessario
                     if (start_index_block2 <= end_index_block2) {
                         merge_needed_for_this_worker = 1;
-                        #if DEBUG == 0
-                        printf("[INDICI MERGING] Worker %d (Attivo): Passo k=%d, Unirà Blocco1 [%ld-%ld] con Blocco2 [%ld-%ld]\n",
-                               tid, k, start_index_block1, end_index_block1, start_index_block2, end_index_block2);
-                        #endif
+                        carry_block1 = 0;
+                        eventlog_record(events, EVENT_MERGE_PLAN, k, start_index_block1, end_index_block1,
+                                        start_index_block2, end_index_block2);
                         DEBUG_PRINT(tid,
                             "[Step %d] INDICI CALCOLATI: Blocco1(%ld-%ld) Blocco2(%ld-%ld)",
                             k, start_index_block1, end_index_block1, start_index_block2, end_index_block2);
@@ -257,28 +418,36 @@ void *worker_thread(void *args) {
             // Se il merge è necessario per questo worker
             if (merge_needed_for_this_worker) {
                 DEBUG_PRINT(tid,
-                    "[Step %d] PRE-MERGE: Unirò array[%ld..%ld] con array[%ld..%ld] in temp_array[%ld..%ld]",
+                    "[Step %d] PRE-MERGE: Unirò src[%ld..%ld] con src[%ld..%ld] in dst[%ld..%ld]",
                     k, start_index_block1, end_index_block1, start_index_block2, end_index_block2,
                     start_index_block1, end_index_block2);
                 
-                // --- Operazione di Merge Protetta da Mutex ---
-                DEBUG_PRINT(tid, "[Step %d] Tentativo di lock merge_mutex...", k);
-                pthread_mutex_lock(merge_mutex); // Acquisisce il mutex per l'accesso esclusivo a temp_array
-                DEBUG_PRINT(tid, "[Step %d] merge_mutex ACQUISITA. Eseguo merge_sections...", k);
+                // --- Operazione di Merge (protetta da mutex solo in MERGE_SERIAL) ---
+                if (serialize) {
+                    DEBUG_PRINT(tid, "[Step %d] Tentativo di lock merge_mutex...", k);
+                    pthread_mutex_lock(merge_mutex); // Acquisisce il mutex per l'accesso esclusivo a temp_array
+                    DEBUG_PRINT(tid, "[Step %d] merge_mutex ACQUISITA. Eseguo merge_sections...", k);
+                }
 
-                // Esegue il merge dei due blocchi dall'array principale ('array') all'array temporaneo ('temp_array')
-                merge_sections(array, temp_array, start_index_block1, end_index_block1,
+                // Esegue il merge dei due blocchi dal buffer sorgente ('src') a quello destinazione ('dst').
+                // In MERGE_PARALLEL non serve alcun lock: l'intervallo di scrittura
+                // [start_index_block1, end_index_block2] appartiene solo a questo worker.
+                merge_sections(src, dst, start_index_block1, end_index_block1,
                                start_index_block2, end_index_block2, N);
 
-                pthread_mutex_unlock(merge_mutex); // Rilascia il mutex
-                DEBUG_PRINT(tid, "[Step %d] merge_mutex RILASCIATA.", k);
-                
-                // Memory barrier esplicita per assicurare che le scritture su temp_array siano visibili
-                // agli altri core/thread prima di procedere
-                #if defined(__GNUC__) || defined(__clang__)
-                    __sync_synchronize();
-                    DEBUG_PRINT(tid, "[Step %d] __sync_synchronize() chiamata dopo merge_mutex unlock.", k);
-                #endif
+                if (serialize) {
+                    pthread_mutex_unlock(merge_mutex); // Rilascia il mutex
+                    DEBUG_PRINT(tid, "[Step %d] merge_mutex RILASCIATA.", k);
+                }
+                // La visibilità delle scritture su dst agli altri worker
+                // è garantita dalla BARRIERA 2 (spin_barrier_wait ordina le scritture con acquire/release).
+            } else if (carry_block1) {
+                // Blocco1 senza compagno (N < P): in ping-pong va comunque riportato in dst,
+                // altrimenti al passo successivo dst conterrebbe dati obsoleti.
+                memcpy(&dst[start_index_block1], &src[start_index_block1],
+                       (end_index_block1 - start_index_block1 + 1) * sizeof(int));
+                DEBUG_PRINT(tid, "[Step %d] Blocco1(%ld-%ld) senza compagno riportato in dst.",
+                            k, start_index_block1, end_index_block1);
             }
         } else if (N == 0) { // Caso speciale: array vuoto
              DEBUG_PRINT(tid, "[Step %d] Array vuoto (N=0), nessun merge.", k);
@@ -291,17 +460,32 @@ void *worker_thread(void *args) {
         // Assicura che tutti i merge di questo passo 'k' siano completati (in temp_array)
         // prima che qualsiasi worker inizi la fase di copia.
         DEBUG_PRINT(tid, "[Step %d] Attesa su BARRIERA 2 (post-merge-step)...", k);
-        err = pthread_barrier_wait(barrier);
-        if (err == PTHREAD_BARRIER_SERIAL_THREAD) {
+        if (trace_barrier_wait(tr, barrier, k, "Errore in spin_barrier_wait (barriera post-merge-step)")) {
              DEBUG_PRINT(tid, "[Step %d] Sono l'ultimo thread alla BARRIERA 2.", k);
-        } else if (err != 0) {
-             CHECK_PTHREAD_ERR(err, "Errore in pthread_barrier_wait (barriera post-merge-step)");
+             #if DEBUG
+             if (!serialize && N > 0) {
+                char M_label[100];
+                sprintf(M_label, "Buffer dopo Merge Step k=%d (ping-pong, senza copia)", k);
+                print_array(M_label, dst, N);
+             }
+             #endif
         }
         DEBUG_PRINT(tid, "[Step %d] Superata BARRIERA 2.", k);
 
+        // In MERGE_PARALLEL il passo termina qui: dst diventa la sorgente del passo successivo.
+        // La BARRIERA 2 garantisce già che nessuno legga ancora il vecchio src.
+        if (!serialize) {
+            int *swap_tmp = src;
+            src = dst;
+            dst = swap_tmp;
+            DEBUG_PRINT(tid, "--- Fine Passo Merge k=%d (buffer scambiati) ---", k);
+            continue;
+        }
+
         // --- Fase 3b: Copia del Risultato da temp_array ad array (Post-Barriera) ---
         // Solo i worker che hanno effettivamente eseguito un merge (merge_needed_for_this_worker == 1)
         if (merge_needed_for_this_worker) {
+             trace_begin(tr, TRACE_COPY, k);
              long copy_s = start_index_block1; // Inizio della regione da copiare
              long copy_e = end_index_block2;   // Fine della regione da copiare (corrisponde alla fine del blocco unito)
              long num_elements_to_copy = copy_e - copy_s + 1;
@@ -343,8 +527,7 @@ void *worker_thread(void *args) {
         // Assicura che tutte le copie da temp_array ad array per il passo 'k' siano completate
         // prima di iniziare il passo di merge successivo (k+1) o terminare la fase di merge.
         DEBUG_PRINT(tid, "[Step %d] Attesa su BARRIERA 3 (post-copy-step)...", k);
-        err = pthread_barrier_wait(barrier);
-        if (err == PTHREAD_BARRIER_SERIAL_THREAD) {
+        if (trace_barrier_wait(tr, barrier, k, "Errore in spin_barrier_wait (post-copy-step)")) {
              DEBUG_PRINT(tid, "[Step %d] Ultimo thread alla BARRIERA 3 (post-copy-step).", k);
              // Se DEBUG è attivo e P > 1, stampa l'array dopo ogni passo di merge e copia.
              #if DEBUG
@@ -354,20 +537,37 @@ void *worker_thread(void *args) {
                 print_array(M_label, array, N);
              }
              #endif
-        } else if (err != 0) {
-             CHECK_PTHREAD_ERR(err, "Errore in pthread_barrier_wait (post-copy-step)");
         }
         DEBUG_PRINT(tid, "[Step %d] Superata BARRIERA 3.", k);
 
         DEBUG_PRINT(tid, "--- Fine Passo Merge k=%d ---", k);
     } // Fine del ciclo for sui passi di merge (k).
 
+    // --- Fase 3c: Copia Finale (ping-pong con log2(P) dispari, oppure MERGE_KWAY) ---
+    // Dopo un numero dispari di scambi (o il passo P-way) il risultato si trova in temp_array.
+    // Ogni worker ricopia in array una fetta di N/P elementi, poi una barriera
+    // garantisce che l'array sia completo prima della terminazione.
+    if (src != array) {
+        trace_begin(tr, TRACE_COPY, -1);
+        long chunk = N / P;
+        long rem = N % P;
+        long copy_s = tid * chunk + (tid < rem ? tid : rem);
+        long copy_n = chunk + (tid < rem ? 1 : 0);
+        if (copy_n > 0) {
+            memcpy(&array[copy_s], &src[copy_s], copy_n * sizeof(int));
+        }
+        DEBUG_PRINT(tid, "Copia finale: temp_array[%ld..%ld] -> array.", copy_s, copy_s + copy_n - 1);
+        trace_barrier_wait(tr, barrier, -1, "Errore in spin_barrier_wait (copia finale)");
+    }
+
     DEBUG_PRINT(tid, "Fase merge completamente terminata.");
+    // Dopo l'ultima barriera tutti i merge sono conclusi: il Worker 0 registra la durata della fase.
+    if (tid == 0 && t_args->merge_time_ms_ptr != NULL) {
+        *t_args->merge_time_ms_ptr = get_time_ms() - merge_start_ms;
+    }
 
-    // Stampa di debug (o normale se DEBUG=0) indicante la terminazione del worker
-    #if DEBUG == 0
-    printf("[WORKER STATUS] Worker %d TERMINATO.\n", tid);
-    #endif
+    // Evento di terminazione del worker (stampato alla fine con -v 2)
+    eventlog_record(events, EVENT_WORKER_END, -1, 0, 0, 0, 0);
     DEBUG_PRINT(tid, "Worker in terminazione.");
     return NULL; // Termina la funzione del thread
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #  Script di Test
 # ==========================================================
 PROGRAM="./parallel_sort"
+CHECK_QUEUE="./bench/check_queue"
+SORT_OK="Verifica: L'array è ordinato correttamente."
 MAKEFILE="Makefile"
 LOG_DIR="log"
 
@@ -11,6 +13,7 @@ run_test() {
     local test_id="$1"
     local command="$2"
     local description="$3"
+    local expected="${4:-$SORT_OK}" # Riga che indica il successo
     local output_file="$LOG_DIR/test_output_${test_id}.txt"
     local status="[ERRORE]"
 
@@ -19,19 +22,20 @@ run_test() {
     echo "Comando Eseguito: $command"
     echo "----------------------------------------------------------"
 
-    OUTPUT=$($command 2>&1 | tee "$output_file")
-    EXIT_CODE=${PIPESTATUS[0]}
+    # PIPESTATUS va letto dentro la sostituzione di comando: fuori si riferirebbe all'assegnazione
+    OUTPUT=$($command 2>&1 | tee "$output_file"; exit "${PIPESTATUS[0]}")
+    EXIT_CODE=$?
 
     echo ""
 
     if echo "$description" | grep -q "Errore Atteso"; then # Modificato per cercare "Errore Atteso"
-        if [ $EXIT_CODE -ne 0 ] && echo "$OUTPUT" | grep -q "ERRORE: Il numero di worker P=.*non è una potenza di 2"; then
+        if [ $EXIT_CODE -ne 0 ] && echo "$OUTPUT" | grep -qi "errore"; then
             status="[OK] (Programma terminato con errore come atteso)"
         else
-            status="[ERRORE] (P non potenza di 2: Comportamento inatteso. EXIT_CODE=$EXIT_CODE. Output: $OUTPUT)"
+            status="[ERRORE] (Argomenti non validi: Comportamento inatteso. EXIT_CODE=$EXIT_CODE. Output: $OUTPUT)"
         fi
     else
-        if [ $EXIT_CODE -eq 0 ] && echo "$OUTPUT" | grep -q "Verifica: L'array è ordinato correttamente."; then
+        if [ $EXIT_CODE -eq 0 ] && echo "$OUTPUT" | grep -qF "$expected"; then
             status="[OK]"
         else
             status="[ERRORE] (EXIT_CODE=$EXIT_CODE. Verifica ordinamento fallita o output anomalo)"
@@ -48,6 +52,9 @@ run_test() {
 echo ">>> FASE 0: Preparazione Directory Log <<<"
 mkdir -p "$LOG_DIR"
 rm -f "$LOG_DIR"/test_output_*.txt
+# Input binari (int a 32 bit casuali) per i test di ordinamento esterno
+head -c 4000004 /dev/urandom > "$LOG_DIR/ext_input_1M.bin"
+head -c 40 /dev/urandom > "$LOG_DIR/ext_input_10.bin"
 echo "Directory log '$LOG_DIR' pronta."
 echo ""
 
@@ -55,7 +62,7 @@ echo ">>> FASE 1: Compilazione del Progetto <<<"
 if [ ! -f "$MAKEFILE" ]; then
     echo "[ERRORE] Makefile non trovato!" && exit 1
 fi
-make clean && make
+make clean && make && make "$CHECK_QUEUE"
 if [ $? -ne 0 ]; then
     echo "[ERRORE] Compilazione fallita!" && exit 1
 fi
@@ -84,9 +91,84 @@ run_test "P4_N4"  "$PROGRAM -n 4 -w 4"   "Correttezza: P=4, N=4 (N = P)"
 run_test "P4_N30" "$PROGRAM -n 30 -w 4"  "Correttezza: P=4, N=30 (N > P)"
 
 
+# === Test Modalità di Merge ===
+run_test "P4_N31_serial"   "$PROGRAM -n 31 -w 4 -m serial"   "Correttezza: P=4, N=31, merge serializzato"
+run_test "P8_N1000_parallel" "$PROGRAM -n 1000 -w 8 -m parallel" "Correttezza: P=8, N=1000, merge parallelo senza lock"
+run_test "P8_N5_corank"     "$PROGRAM -n 5 -w 8 -m corank"     "Correttezza: P=8, N=5 (N < P), merge co-rank"
+run_test "P4_N1001_corank"  "$PROGRAM -n 1001 -w 4 -m corank"  "Correttezza: P=4, N=1001, merge co-rank"
+run_test "P8_N3_kway"       "$PROGRAM -n 3 -w 8 -m kway"       "Correttezza: P=8, N=3 (N < P), merge P-way"
+run_test "P16_N1001_kway"   "$PROGRAM -n 1001 -w 16 -m kway"   "Correttezza: P=16, N=1001, merge P-way"
+
+# === Test Algoritmi di Ordinamento per Interi ===
+run_test "P4_N3_radix"      "$PROGRAM -n 3 -w 4 -s radix"      "Correttezza: P=4, N=3 (N < P), radix sort LSD"
+run_test "P8_N5000_radix"   "$PROGRAM -n 5000 -w 8 -s radix"   "Correttezza: P=8, N=5000, radix sort LSD"
+run_test "P4_N3_sample"     "$PROGRAM -n 3 -w 4 -s sample"     "Correttezza: P=4, N=3 (N < P), sample sort"
+run_test "P8_N5000_sample"  "$PROGRAM -n 5000 -w 8 -s sample"  "Correttezza: P=8, N=5000, sample sort"
+
+# === Test P Non Potenza di 2 ===
+run_test "P3_N31"           "$PROGRAM -n 31 -w 3"              "Correttezza: P=3, N=31 (P non potenza di 2)"
+run_test "P6_N4_serial"     "$PROGRAM -n 4 -w 6 -m serial"     "Correttezza: P=6, N=4 (N < P), merge serializzato"
+run_test "P12_N1000_corank" "$PROGRAM -n 1000 -w 12 -m corank" "Correttezza: P=12, N=1000, merge co-rank"
+run_test "P24_N1000_kway"   "$PROGRAM -n 1000 -w 24 -m kway"   "Correttezza: P=24, N=1000, merge P-way"
+
+# === Test Record a Chiave int64_t (-t) ===
+run_test "P4_N3_keyindex"   "$PROGRAM -n 3 -w 4 -t keyindex"   "Correttezza: P=4, N=3 (N < P), record chiave+indice"
+run_test "P6_N5000_rec8"    "$PROGRAM -n 5000 -w 6 -t rec8"    "Correttezza: P=6, N=5000, record con payload da 8 byte"
+run_test "P8_N5001_rec64"   "$PROGRAM -n 5001 -w 8 -t rec64"   "Correttezza: P=8, N=5001, record con payload da 64 byte"
+
+# === Test Ordinamento Esterno (-i/-o) ===
+run_test "Ext_P3_N10"       "$PROGRAM -i $LOG_DIR/ext_input_10.bin -o $LOG_DIR/ext_output_10.bin -w 3" "Correttezza: ordinamento esterno, N=10 (un solo run)"
+run_test "Ext_P4_N1M_M1"    "$PROGRAM -i $LOG_DIR/ext_input_1M.bin -o $LOG_DIR/ext_output_1M.bin -w 4 -M 1" "Correttezza: ordinamento esterno, N=1000001, 1 MB (più run, merge P-way)"
+
+# === Test Allocazione NUMA (-N) e Pinning (-a) ===
+run_test "P4_N100k_firsttouch" "$PROGRAM -n 100000 -w 4 -N firsttouch -a" "Correttezza: P=4, N=100000, first-touch dei worker e pinning"
+run_test "P3_N1001_interleave" "$PROGRAM -n 1001 -w 3 -N interleave -m kway" "Correttezza: P=3, N=1001, pagine interleaved, merge P-way"
+
+# === Test Distribuzioni dell'Input (--dist, --seed) ===
+run_test "P4_N10k_sorted"       "$PROGRAM -n 10000 -w 4 --dist sorted --seed 1"              "Correttezza: P=4, N=10000, input già ordinato"
+run_test "P5_N10k_reverse"      "$PROGRAM -n 10000 -w 5 --dist reverse --seed 1 -m kway"     "Correttezza: P=5, N=10000, input al contrario, merge P-way"
+run_test "P4_N10k_nearly"       "$PROGRAM -n 10000 -w 4 --dist nearly-sorted --seed 2 -m corank" "Correttezza: P=4, N=10000, input quasi ordinato, merge co-rank"
+run_test "P6_N10k_fewuniq_sample" "$PROGRAM -n 10000 -w 6 --dist few-unique --seed 3 -s sample" "Correttezza: P=6, N=10000, 16 valori distinti, sample sort"
+run_test "P4_N10k_zipf_radix"   "$PROGRAM -n 10000 -w 4 --dist zipf --seed 4 -s radix"       "Correttezza: P=4, N=10000, input Zipf, radix sort"
+run_test "P3_N10001_organpipe"  "$PROGRAM -n 10001 -w 3 --dist organ-pipe --seed 5 -m serial" "Correttezza: P=3, N=10001, input a canne d'organo, merge serializzato"
+
+# === Test Misura per Fase (--stats) ===
+run_test "P5_N10k_stats_csv"    "$PROGRAM -n 10000 -w 5 -m serial --stats $LOG_DIR/stats_P5.csv"                   "Correttezza: P=5, N=10000, misura per fase in CSV"
+run_test "P4_N10k_stats_json"   "$PROGRAM -n 10000 -w 4 -s sample --stats $LOG_DIR/stats_P4.json --stats-format json" "Correttezza: P=4, N=10000, sample sort, misura per fase in JSON"
+
+# === Test Work Stealing della Fase di Sorting (task divisi e rubati) ===
+run_test "P4_N300k_steal_zipf"     "$PROGRAM -n 300000 -w 4 --dist zipf --seed 6"                 "Correttezza: P=4, N=300000, input Zipf, task divisi tra i deque"
+run_test "P7_N300k_steal_organpipe" "$PROGRAM -n 300001 -w 7 --dist organ-pipe --seed 7 -m kway" "Correttezza: P=7, N=300001, canne d'organo, task divisi, merge P-way"
+
+# === Test Run Naturali (ordinamento adattivo, --no-adaptive) ===
+run_test "P6_N100001_runs_reverse"   "$PROGRAM -n 100001 -w 6 --dist reverse --seed 8"           "Correttezza: P=6, N=100001, un run decrescente invertito in parallelo"
+run_test "P3_N100k_runs_organpipe"   "$PROGRAM -n 100000 -w 3 --dist organ-pipe --seed 9"        "Correttezza: P=3, N=100000, due run (crescente e decrescente) uniti"
+run_test "P4_N10k_sorted_noadaptive" "$PROGRAM -n 10000 -w 4 --dist sorted --seed 1 --no-adaptive -m corank" "Correttezza: P=4, N=10000, input ordinato senza rilevamento dei run"
+
+# === Test Verifica Parallela (ordine e checksum) ===
+run_test "P7_N1000003_fewuniq_verify" "$PROGRAM -n 1000003 -w 7 --dist few-unique --seed 10 -m kway" "Correttezza: P=7, N=1000003, 16 valori distinti, verifica parallela con checksum"
+
+# === Test Verbosità (-v) ===
+run_test "P4_N20_v1"            "$PROGRAM -n 20 -w 4 -v 1"                "Correttezza: P=4, N=20, avanzamento e array stampati"
+run_test "P6_N5000_v2_corank"   "$PROGRAM -n 5000 -w 6 -m corank -v 2"    "Correttezza: P=6, N=5000, registro eventi dei worker"
+run_test "P3_N100_v2_rec8"      "$PROGRAM -n 100 -w 3 -t rec8 -v 2"       "Correttezza: P=3, N=100, record, registro eventi dei worker"
+
+# === Test Coda Concorrente (try_pop, pop_timeout, cancel_queue) ===
+run_test "Queue_api" "$CHECK_QUEUE" "Correttezza: try_pop, pop_timeout (anche con scadenza non valida) e cancel_queue, con mutex e lock-free" "Verifica: coda concorrente corretta."
+
+# === Test Argomenti Non Validi ===
+run_test "P0_N10"           "$PROGRAM -n 10 -w 0"              "Errore Atteso: P=0"
+run_test "P4_N10_badmode"   "$PROGRAM -n 10 -w 4 -m boh"       "Errore Atteso: modalità di merge sconosciuta"
+run_test "Ext_missing"      "$PROGRAM -i $LOG_DIR/non_esiste.bin -o $LOG_DIR/ext_output_x.bin -w 2" "Errore Atteso: file di input inesistente"
+run_test "P4_N10_badtype"   "$PROGRAM -n 10 -w 4 -t boh"       "Errore Atteso: tipo di elemento sconosciuto"
+run_test "P4_N10_baddist"   "$PROGRAM -n 10 -w 4 --dist boh"   "Errore Atteso: distribuzione sconosciuta"
+run_test "P4_N10_badstats"  "$PROGRAM -n 10 -w 4 --stats $LOG_DIR/x.csv --stats-format xml" "Errore Atteso: formato delle statistiche sconosciuto"
+run_test "P4_N10_badnuma"   "$PROGRAM -n 10 -w 4 -N boh"       "Errore Atteso: politica di allocazione sconosciuta"
+run_test "P4_N10_badverbose" "$PROGRAM -n 10 -w 4 -v 3"          "Errore Atteso: livello di verbosità non valido"
 
 # === Test di "Stress" (opzionale, puoi commentarlo se troppo lento) ===
-run_test "Stress_P4_N5k" "time $PROGRAM -n 5000 -w 4" "Stress: P=4, N=5000"
+# Il programma stampa già "Tempo ordinamento": non serve "time" (keyword di bash, non eseguibile tramite $command)
+run_test "Stress_P4_N5k" "$PROGRAM -n 5000 -w 4" "Stress: P=4, N=5000"
 
 echo ">>> BATTERIA DI TEST COMPLETATA <<<"
 echo "Verificare lo stato [OK]/[ERRORE] per ciascun test."